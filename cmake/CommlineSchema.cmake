@@ -0,0 +1,73 @@
+include_guard(GLOBAL)
+include(GNUInstallDirs)
+
+# Generates static shell completion scripts, a man page and a JSON schema
+# for an executable built with commline. The executable is run with its
+# hidden '__schema' command once it is built.
+#
+#   commline_generate_schema(<target>
+#       [NAME <command name>]
+#       [OUTPUT_DIRECTORY <directory>]
+#       [INSTALL]
+#   )
+#
+# NAME defaults to the target's output name. Outputs are written to
+# OUTPUT_DIRECTORY, by default '<target>-schema' in the current binary
+# directory, by the '<target>.schema' target, which is part of 'all'.
+# INSTALL installs the completions and the man page where bash, zsh, fish and
+# man look for them under the install prefix.
+function(commline_generate_schema target)
+    cmake_parse_arguments(PARSE_ARGV 1 ARG "INSTALL" "NAME;OUTPUT_DIRECTORY" "")
+
+    set(name "${ARG_NAME}")
+    if(NOT name)
+        get_target_property(name ${target} OUTPUT_NAME)
+        if(NOT name)
+            set(name ${target})
+        endif()
+    endif()
+
+    set(directory "${ARG_OUTPUT_DIRECTORY}")
+    if(NOT directory)
+        set(directory "${CMAKE_CURRENT_BINARY_DIR}/${target}-schema")
+    endif()
+
+    set(bash "${directory}/bash/${name}")
+    set(zsh "${directory}/zsh/_${name}")
+    set(fish "${directory}/fish/${name}.fish")
+    set(man "${directory}/man1/${name}.1")
+    set(json "${directory}/${name}.json")
+
+    set(outputs "")
+
+    foreach(format bash zsh fish man json)
+        set(output "${${format}}")
+        cmake_path(GET output PARENT_PATH parent)
+
+        add_custom_command(
+            OUTPUT "${output}"
+            COMMAND ${CMAKE_COMMAND} -E make_directory "${parent}"
+            COMMAND ${target} __schema ${format} > "${output}"
+            DEPENDS ${target}
+            COMMENT "Generating ${format} schema for ${name}"
+            VERBATIM
+        )
+
+        list(APPEND outputs "${output}")
+    endforeach()
+
+    add_custom_target(${target}.schema ALL DEPENDS ${outputs})
+
+    if(ARG_INSTALL)
+        install(FILES "${bash}"
+            DESTINATION "${CMAKE_INSTALL_DATADIR}/bash-completion/completions"
+        )
+        install(FILES "${zsh}"
+            DESTINATION "${CMAKE_INSTALL_DATADIR}/zsh/site-functions"
+        )
+        install(FILES "${fish}"
+            DESTINATION "${CMAKE_INSTALL_DATADIR}/fish/vendor_completions.d"
+        )
+        install(FILES "${man}" DESTINATION "${CMAKE_INSTALL_MANDIR}/man1")
+    endif()
+endfunction()
@@ -0,0 +1,377 @@
+#pragma once
+
+#include <commline/error.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace commline {
+    // The parts of 'alias_table' that do not depend on its capacity. The
+    // table is built here, on spans over the storage of a particular
+    // capacity, so that the builder is compiled once rather than once per
+    // capacity.
+    class alias_table_base {
+    public:
+        using index_type = std::uint16_t;
+
+        static constexpr auto npos = std::numeric_limits<index_type>::max();
+
+        struct entry {
+            std::string_view alias;
+            index_type index;
+        };
+
+        struct slot {
+            std::string_view alias;
+            index_type index = npos;
+        };
+
+        // Seeded 64-bit FNV-1a.
+        static constexpr auto hash(
+            std::string_view text,
+            std::uint64_t seed
+        ) noexcept -> std::uint64_t {
+            constexpr auto basis = std::uint64_t(0xcbf29ce484222325);
+            constexpr auto prime = std::uint64_t(0x100000001b3);
+            constexpr auto golden = std::uint64_t(0x9e3779b97f4a7c15);
+
+            auto result = basis ^ (seed * golden);
+
+            for (const auto c : text) {
+                result ^= static_cast<unsigned char>(c);
+                result *= prime;
+            }
+
+            return result;
+        }
+    protected:
+        // The number of slots and buckets a built table uses.
+        struct layout {
+            std::size_t slots = 0;
+            std::size_t buckets = 0;
+        };
+
+        // Tables start at twice the number of aliases, which leaves every
+        // bucket plenty of free slots to choose from.
+        static constexpr auto slot_capacity(std::size_t capacity)
+            -> std::size_t {
+            return std::bit_ceil(capacity * 2);
+        }
+
+        static constexpr auto bucket_capacity(std::size_t capacity)
+            -> std::size_t {
+            return std::bit_ceil(capacity / 2 + 1);
+        }
+
+        // Fills 'slots', 'displacements' and 'short_aliases' from 'entries'.
+        // The spans are the full storage of a table holding at most
+        // 'capacity' aliases. When an alias appears more than once, the last
+        // entry wins.
+        static constexpr auto build(
+            std::span<const entry> entries,
+            std::size_t capacity,
+            std::span<slot> slots,
+            std::span<std::uint32_t> displacements,
+            std::span<index_type, 256> short_aliases
+        ) -> layout {
+            const auto unique = deduplicate(entries);
+
+            if (unique.size() > capacity) {
+                throw_length_error("too many aliases for the alias table");
+            }
+
+            for (const auto& entry : unique) {
+                if (entry.alias.size() == 1) {
+                    short_aliases[static_cast<unsigned char>(
+                        entry.alias.front()
+                    )] = entry.index;
+                }
+            }
+
+            if (unique.empty()) return {};
+
+            const auto buckets = std::bit_ceil(unique.size() / 2 + 1);
+            auto size = std::bit_ceil(unique.size() * 2);
+
+            while (!place(
+                unique,
+                slots.first(size),
+                displacements.first(buckets)
+            )) {
+                size *= 2;
+
+                if (size > slots.size()) {
+                    throw_length_error("failed to place aliases");
+                }
+            }
+
+            return {size, buckets};
+        }
+    private:
+        // Number of displacements tried for a bucket before the table is
+        // grown.
+        static constexpr auto max_attempts = std::uint32_t(1024);
+
+        static constexpr auto deduplicate(std::span<const entry> entries)
+            -> std::vector<entry> {
+            auto order = std::vector<std::size_t>(entries.size());
+            for (std::size_t i = 0; i < order.size(); ++i) order[i] = i;
+
+            // Sorting by position within equal aliases keeps the original
+            // order of duplicates.
+            std::sort(order.begin(), order.end(), [&](auto a, auto b) {
+                if (entries[a].alias != entries[b].alias) {
+                    return entries[a].alias < entries[b].alias;
+                }
+
+                return a < b;
+            });
+
+            // Keep the last occurrence of each alias.
+            auto result = std::vector<entry>();
+            result.reserve(order.size());
+
+            for (auto it = order.begin(); it != order.end(); ++it) {
+                const auto next = std::next(it);
+                if (next != order.end() &&
+                    entries[*next].alias == entries[*it].alias)
+                    continue;
+                result.push_back(entries[*it]);
+            }
+
+            return result;
+        }
+
+        // Hash and displace: aliases are grouped into buckets by their
+        // unseeded hash, then each bucket, largest first, searches for a seed
+        // that sends every one of its aliases to a free slot.
+        static constexpr auto place(
+            std::span<const entry> entries,
+            std::span<slot> slots,
+            std::span<std::uint32_t> displacements
+        ) -> bool {
+            const auto bucket_mask = displacements.size() - 1;
+            const auto slot_mask = slots.size() - 1;
+
+            auto order = std::vector<std::size_t>(entries.size());
+            auto buckets = std::vector<std::size_t>(entries.size());
+            auto bucket_sizes = std::vector<std::size_t>(displacements.size());
+
+            for (std::size_t i = 0; i < entries.size(); ++i) {
+                order[i] = i;
+                buckets[i] = hash(entries[i].alias, 0) & bucket_mask;
+                ++bucket_sizes[buckets[i]];
+            }
+
+            std::sort(order.begin(), order.end(), [&](auto a, auto b) {
+                const auto bucket_a = buckets[a];
+                const auto bucket_b = buckets[b];
+
+                if (bucket_sizes[bucket_a] != bucket_sizes[bucket_b]) {
+                    return bucket_sizes[bucket_a] > bucket_sizes[bucket_b];
+                }
+
+                return bucket_a < bucket_b;
+            });
+
+            std::fill(slots.begin(), slots.end(), slot());
+            std::fill(displacements.begin(), displacements.end(), 0);
+
+            auto positions = std::vector<std::size_t>();
+            auto first = order.begin();
+
+            while (first != order.end()) {
+                const auto bucket = buckets[*first];
+                const auto last = first + bucket_sizes[bucket];
+
+                auto placed = false;
+
+                for (auto seed = std::uint32_t(1); seed <= max_attempts;
+                     ++seed) {
+                    positions.clear();
+
+                    for (auto it = first; it != last; ++it) {
+                        const auto position =
+                            hash(entries[*it].alias, seed) & slot_mask;
+
+                        if (slots[position].index != npos ||
+                            std::find(
+                                positions.begin(),
+                                positions.end(),
+                                position
+                            ) != positions.end())
+                            break;
+
+                        positions.push_back(position);
+                    }
+
+                    if (positions.size() != bucket_sizes[bucket]) continue;
+
+                    for (std::size_t i = 0; i < positions.size(); ++i) {
+                        const auto& entry = entries[first[i]];
+                        slots[positions[i]] = {entry.alias, entry.index};
+                    }
+
+                    displacements[bucket] = seed;
+                    placed = true;
+                    break;
+                }
+
+                if (!placed) return false;
+                first = last;
+            }
+
+            return true;
+        }
+    };
+
+    // Looks up aliases in an 'alias_table' of any capacity, so that code
+    // using the table need not be a template.
+    class alias_lookup : public alias_table_base {
+        std::span<const slot> slots;
+        std::span<const std::uint32_t> displacements;
+        const std::array<index_type, 256>* short_aliases;
+    public:
+        constexpr alias_lookup(
+            std::span<const slot> slots,
+            std::span<const std::uint32_t> displacements,
+            const std::array<index_type, 256>& short_aliases
+        ) :
+            slots(slots),
+            displacements(displacements),
+            short_aliases(&short_aliases) {}
+
+        constexpr auto empty() const noexcept -> bool { return slots.empty(); }
+
+        constexpr auto find(std::string_view alias) const noexcept
+            -> index_type {
+            if (slots.empty()) return npos;
+
+            const auto bucket = hash(alias, 0) & (displacements.size() - 1);
+            const auto& slot = slots
+                [hash(alias, displacements[bucket]) & (slots.size() - 1)];
+
+            return slot.alias == alias ? slot.index : npos;
+        }
+
+        constexpr auto find(char alias) const noexcept -> index_type {
+            return (*short_aliases)[static_cast<unsigned char>(alias)];
+        }
+    };
+
+    // Maps option aliases to option indices through a perfect hash built
+    // once from the alias set. Single-character aliases are also kept in a
+    // direct table indexed by the character. Lookups never allocate or throw;
+    // a miss returns 'npos'.
+    //
+    // Up to 'Capacity' aliases are held in fixed storage, and such a table
+    // can be built during constant evaluation, so a table that is part of a
+    // 'constinit' object never touches the heap. A table given more aliases
+    // keeps its slots on the heap instead, which constant evaluation
+    // rejects.
+    template <std::size_t Capacity>
+    class alias_table : public alias_table_base {
+        std::array<slot, slot_capacity(Capacity)> slots;
+        std::array<std::uint32_t, bucket_capacity(Capacity)> displacements =
+            {};
+        std::array<index_type, 256> short_aliases;
+
+        slot* spilled_slots = nullptr;
+        std::uint32_t* spilled_displacements = nullptr;
+
+        // The slots and buckets in use.
+        layout used;
+
+        constexpr auto lookup_slots() const noexcept -> std::span<const slot> {
+            if (spilled_slots) return {spilled_slots, used.slots};
+            return std::span(slots).first(used.slots);
+        }
+
+        constexpr auto lookup_displacements() const noexcept
+            -> std::span<const std::uint32_t> {
+            if (spilled_displacements) {
+                return {spilled_displacements, used.buckets};
+            }
+
+            return std::span(displacements).first(used.buckets);
+        }
+    public:
+        constexpr alias_table() { short_aliases.fill(npos); }
+
+        // When an alias appears more than once, the last entry wins.
+        constexpr alias_table(std::span<const entry> entries) : alias_table() {
+            if (entries.size() <= Capacity) {
+                used = build(
+                    entries,
+                    Capacity,
+                    slots,
+                    displacements,
+                    short_aliases
+                );
+                return;
+            }
+
+            const auto capacity = entries.size();
+            const auto slot_count = slot_capacity(capacity);
+            const auto bucket_count = bucket_capacity(capacity);
+
+            spilled_slots = new slot[slot_count];
+            spilled_displacements = new std::uint32_t[bucket_count]();
+
+            used = build(
+                entries,
+                capacity,
+                std::span(spilled_slots, slot_count),
+                std::span(spilled_displacements, bucket_count),
+                short_aliases
+            );
+        }
+
+        constexpr alias_table(const alias_table& other) :
+            slots(other.slots),
+            displacements(other.displacements),
+            short_aliases(other.short_aliases),
+            used(other.used) {
+            if (!other.spilled_slots) return;
+
+            spilled_slots = new slot[used.slots];
+            spilled_displacements = new std::uint32_t[used.buckets];
+
+            std::ranges::copy(other.lookup_slots(), spilled_slots);
+            std::ranges::copy(
+                other.lookup_displacements(),
+                spilled_displacements
+            );
+        }
+
+        constexpr ~alias_table() {
+            delete[] spilled_slots;
+            delete[] spilled_displacements;
+        }
+
+        auto operator=(const alias_table&) -> alias_table& = delete;
+
+        constexpr auto lookup() const noexcept -> alias_lookup {
+            return alias_lookup(
+                lookup_slots(),
+                lookup_displacements(),
+                short_aliases
+            );
+        }
+
+        constexpr auto find(std::string_view alias) const noexcept
+            -> index_type {
+            return lookup().find(alias);
+        }
+
+        constexpr auto find(char alias) const noexcept -> index_type {
+            return lookup().find(alias);
+        }
+    };
+}
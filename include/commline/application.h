@@ -1,76 +1,133 @@
 #pragma once
 
 #include <commline/command.h>
+#include <commline/config_file.h>
+#include <commline/error.h>
+#include <commline/response_file.h>
 
+#include <cstddef>
 #include <iostream>
-#include <system_error>
+#include <string_view>
 
 namespace commline {
     using error_handler_t = auto (*)(std::exception_ptr eptr) -> void;
 
-    auto print_error(std::exception_ptr eptr) -> void;
+    // Declared in 'batch.h' and 'server.h', which only the programs that
+    // run batches or serve requests need include.
+    struct batch_config;
+    class server;
+    struct zygote_config;
 
-    template <typename Callable, typename Options, typename Arguments>
-    class app_impl final : public command_impl<Callable, Options, Arguments> {
+    // The parts of an application that do not depend on the types of its
+    // commands: the hidden commands, response files, the configuration
+    // file, error reporting and the ways command lines are received. Being
+    // compiled once in the library, they add nothing to each program that
+    // declares an application.
+    class application_base {
         error_handler_t error_handler = &print_error;
+        response_format response_file_format = response_format::none;
+
+        config_ptr config;
+
+        // The root of the command tree.
+        virtual auto root() -> command_node& = 0;
+
+        auto dispatch(argv argv, std::ostream& out) -> expected<int>;
+
+        auto report(expected<int>&& status) -> int;
+
+        // Errors in the command line are returned by 'f'. Anything else it
+        // throws is caught here, unless exceptions are disabled.
+        template <typename F>
+        auto handle_errors(F&& f) -> int;
+    protected:
+        constexpr application_base(text version) : version(version) {}
+
+        constexpr ~application_base() = default;
     public:
-        const std::string version;
+        const text version;
+
+        application_base(const application_base&) = delete;
+
+        auto operator=(const application_base&) -> application_base& = delete;
+
+        auto on_error(error_handler_t handler) -> void {
+            error_handler = handler;
+        }
+
+        // Enables '@file' arguments, which are replaced by the arguments
+        // read from the file.
+        auto expand_response_files(response_format format) -> void {
+            response_file_format = format;
+        }
+
+        // Reads option values that neither the command line nor the
+        // environment give from the configuration file at 'path', which
+        // need not exist. The file is read when the first command runs,
+        // and its errors are reported like those of the command line.
+        auto use_config(std::string_view path) -> void;
+
+        auto run(int argc, char** argv, std::ostream& out = std::cout) -> int;
+
+        // Runs every command line read from 'in' against this application.
+        // Each line is split into words as a shell would and then handled as
+        // if the program had been invoked with them. Command handlers must
+        // be safe to call concurrently when 'config' asks for more than one
+        // thread.
+        auto run_batch(std::istream& in, std::ostream& out = std::cout) -> int;
+
+        auto run_batch(
+            std::istream& in,
+            std::ostream& out,
+            const batch_config& config
+        ) -> int;
+
+        // Runs command lines forwarded by clients connected to 'server'
+        // until 'max_requests' have been handled, or forever if it is zero.
+        auto serve(server& server, std::size_t max_requests = 0) -> void;
 
-        app_impl(
+        // Like 'serve', but each command line runs in a child process forked
+        // from this one.
+        auto zygote(server& server) -> void;
+
+        auto zygote(server& server, const zygote_config& config) -> void;
+    };
+
+    template <
+        typename Callable,
+        typename Options,
+        typename Arguments,
+        typename Commands = std::tuple<>>
+    class app_impl final :
+        public command_impl<Callable, Options, Arguments, Commands>,
+        public application_base {
+        auto root() -> command_node& override { return *this; }
+    public:
+        constexpr app_impl(
             std::string_view name,
-            std::string_view version,
-            std::string_view description,
+            text version,
+            text description,
             Callable&& fn,
             Options&& options,
-            Arguments&& arguments
+            Arguments&& arguments,
+            Commands&& commands = Commands()
         ) :
-            command_impl<Callable, Options, Arguments>(
+            command_impl<Callable, Options, Arguments, Commands>(
                 name,
                 description,
                 std::move(fn),
                 std::move(options),
-                std::move(arguments)
+                std::move(arguments),
+                std::move(commands)
             ),
-            version(version) {}
-
-        auto on_error(error_handler_t handler) -> void {
-            error_handler = handler;
-        }
-
-        auto run(int argc, char** argv, std::ostream& out = std::cout) -> int {
-            const auto args = commline::argv(argv, argc);
-
-            auto first = args.begin();
-            const auto last = args.end();
-
-            const auto argv0 = *(first++);
-            auto cmd = this->find(first, last);
-
-            try {
-                cmd->execute(
-                    {this->name, version, this->description, argv0},
-                    commline::argv(first, last),
-                    out
-                );
-            }
-            catch (const std::system_error& ex) {
-                error_handler(std::current_exception());
-                return ex.code().value();
-            }
-            catch (...) {
-                error_handler(std::current_exception());
-                return EXIT_FAILURE;
-            }
-
-            return EXIT_SUCCESS;
-        };
+            application_base(version) {}
     };
 
     template <typename Callable, typename Options, typename Arguments>
-    auto application(
+    constexpr auto application(
         std::string_view name,
-        std::string_view version,
-        std::string_view description,
+        text version,
+        text description,
         Options&& options,
         Arguments&& arguments,
         Callable&& fn
@@ -84,4 +141,33 @@ namespace commline {
             std::move(arguments)
         );
     }
+
+    // An application whose whole command tree is declared up front. When
+    // every option, argument and handler can be constant-initialized, so can
+    // the application, as in 'constinit auto app = application(...)', and
+    // nothing is allocated before a handler runs.
+    template <
+        typename Callable,
+        typename Options,
+        typename Arguments,
+        typename Commands>
+    constexpr auto application(
+        std::string_view name,
+        text version,
+        text description,
+        Options&& options,
+        Arguments&& arguments,
+        Callable&& fn,
+        Commands&& commands
+    ) -> app_impl<Callable, Options, Arguments, Commands> {
+        return app_impl<Callable, Options, Arguments, Commands>(
+            name,
+            version,
+            description,
+            std::move(fn),
+            std::move(options),
+            std::move(arguments),
+            std::move(commands)
+        );
+    }
 }
@@ -1,9 +1,15 @@
 #pragma once
 
-#include <commline/error.h>
+#include <commline/completion.h>
+#include <commline/engine.h>
+#include <commline/expected.h>
 #include <commline/parser.h>
+#include <commline/schema.h>
+#include <commline/text.h>
+#include <commline/view.h>
 
 #include <array>
+#include <memory>
 #include <optional>
 #include <ostream>
 #include <span>
@@ -13,31 +19,46 @@
 
 namespace commline {
     struct named_argument {
-        std::string name;
+        text name;
 
-        named_argument(std::string_view name);
+        // Lists values for the argument when completing a command line.
+        std::optional<candidate_provider> provider;
+
+        constexpr named_argument(text name) : name(std::move(name)) {}
 
         auto print_help(std::ostream& out) const -> void;
     };
 
     struct required_argument : named_argument {
-        std::string_view value;
+        static constexpr auto kind = argument_kind::required;
+        using state = std::string_view;
+
+        constexpr required_argument(text name) :
+            named_argument(name) {}
 
-        required_argument(std::string_view name);
+        auto describe() const -> argument_info;
     };
 
     struct optional_argument : named_argument {
-        std::optional<std::string_view> value;
+        static constexpr auto kind = argument_kind::optional;
+        using state = std::optional<std::string_view>;
 
-        optional_argument(std::string_view name);
+        constexpr optional_argument(text name) :
+            named_argument(name) {}
+
+        auto describe() const -> argument_info;
 
         auto print_help(std::ostream& out) const -> void;
     };
 
     struct argument_list : named_argument {
-        std::span<const std::string_view> values;
+        static constexpr auto kind = argument_kind::variadic;
+        using state = std::span<const std::string_view>;
+
+        constexpr argument_list(text name) :
+            named_argument(name) {}
 
-        argument_list(std::string_view name);
+        auto describe() const -> argument_info;
 
         auto print_help(std::ostream& out) const -> void;
     };
@@ -48,9 +69,16 @@ namespace commline {
 
         required_argument base;
 
-        required(std::string_view name) : base(name) {}
+        constexpr required(text name) : base(name) {}
 
-        auto value() const -> type { return parser<type>::parse(base.value); }
+        auto value(const required_argument::state& value) const -> type {
+            return try_value(value).value();
+        }
+
+        auto try_value(const required_argument::state& value) const
+            -> expected<type> {
+            return convert<type>(value);
+        }
     };
 
     template <typename T>
@@ -59,11 +87,20 @@ namespace commline {
 
         optional_argument base;
 
-        optional(std::string_view name) : base(name) {}
+        constexpr optional(text name) : base(name) {}
+
+        auto value(const optional_argument::state& value) const -> type {
+            return try_value(value).value();
+        }
+
+        auto try_value(const optional_argument::state& value) const
+            -> expected<type> {
+            if (!value) return type();
 
-        auto value() const -> type {
-            if (base.value) return parser<T>::parse(base.value.value());
-            return {};
+            auto converted = convert<T>(*value);
+            if (!converted) return std::move(converted).error();
+
+            return type(*std::move(converted));
         }
     };
 
@@ -73,133 +110,209 @@ namespace commline {
 
         argument_list base;
 
-        variadic(std::string_view name) : base(name) {}
+        constexpr variadic(text name) : base(name) {}
+
+        auto value(const argument_list::state& values) const -> type {
+            return try_value(values).value();
+        }
 
-        auto value() const -> type {
+        auto try_value(const argument_list::state& values) const
+            -> expected<type> {
             auto result = type();
+            result.reserve(values.size());
+
+            for (const auto val : values) {
+                auto converted = convert<T>(val);
+                if (!converted) return std::move(converted).error();
 
-            for (const auto val : base.values) {
-                result.push_back(parser<T>::parse(val));
+                result.push_back(*std::move(converted));
             }
 
             return result;
         }
     };
 
-    template <typename... Arguments>
-    class positional_arguments {
-        using tuple_t = std::tuple<Arguments...>;
-        using var_t = std::
-            variant<required_argument*, argument_list*, optional_argument*>;
-        using result_t = std::tuple<typename Arguments::type...>;
+    template <typename T>
+    struct variadic_view {
+        using type = value_view<T>;
 
-        template <std::size_t N>
-        using type = typename std::tuple_element_t<N, tuple_t>::type;
+        argument_list base;
 
-        static constexpr auto size_v = std::tuple_size_v<tuple_t>;
+        constexpr variadic_view(text name) : base(name) {}
 
-        [[noreturn]]
-        static auto missing_value(const std::string& name) -> void {
-            throw cli_error("not enough arguments: missing value for: " + name);
+        auto value(const argument_list::state& values) const -> type {
+            return type(values);
         }
 
-        tuple_t arguments;
-        std::array<var_t, size_v> bases;
+        auto try_value(const argument_list::state& values) const
+            -> expected<type> {
+            return value(values);
+        }
+    };
 
+    // The parameter of a positional argument. Help, descriptions and
+    // completion work on these, so they are compiled once in the library.
+    using argument_entry = std::variant<
+        const required_argument*,
+        const argument_list*,
+        const optional_argument*>;
+
+    // Lists the arguments of a usage line, each preceded by a space.
+    auto print_arguments(
+        std::ostream& out,
+        std::span<const argument_entry> entries
+    ) -> void;
+
+    auto describe_arguments(
+        std::span<const argument_entry> entries,
+        std::vector<argument_info>& arguments
+    ) -> void;
+
+    // Completes the positional argument at 'position'. Every position from
+    // that of an argument list onward belongs to the list.
+    auto complete_argument(
+        std::span<const argument_entry> entries,
+        std::size_t position,
+        completion& result
+    ) -> void;
+
+    // The declared positional arguments of a command. A schema is immutable
+    // once constructed and may be shared by any number of concurrent parses.
+    template <typename... Arguments>
+    class argument_schema {
+    public:
+        using tuple_type = std::tuple<Arguments...>;
+        using variant_type = argument_entry;
+
+        static constexpr auto size_v = std::tuple_size_v<tuple_type>;
+    private:
         template <std::size_t... I>
-        auto generate_bases(std::index_sequence<I...>) -> void {
-            ((bases[I] = &(std::get<I>(arguments).base)), ...);
+        constexpr auto generate_bases(std::index_sequence<I...>) const
+            -> std::array<variant_type, size_v> {
+            return {&(std::get<I>(arguments).base)...};
         }
 
         template <std::size_t... I>
-        auto get_values(std::index_sequence<I...>) const -> result_t {
-            return std::make_tuple(std::get<I>(arguments).value()...);
-        }
-
-        template <typename ArgsIt, typename BasesIt>
-        auto read_reverse(
-            const ArgsIt& args_begin,
-            ArgsIt& args_end,
-            const BasesIt& bases_begin,
-            BasesIt& bases_end
-        ) -> void {
-            while (bases_begin != bases_end) {
-                auto& current = *--bases_end;
-
-                if (auto** arg = std::get_if<required_argument*>(&current)) {
-                    auto& base = **arg;
-
-                    if (args_begin == args_end) missing_value(base.name);
-
-                    base.value = *--args_end;
-                }
-                else if (auto** arg = std::get_if<optional_argument*>(&current)) {
-                    auto& base = **arg;
-                    if (args_begin != args_end) base.value = *--args_end;
-                }
-                else return; // argument_list reached
-            }
+        constexpr auto generate_descriptors(std::index_sequence<I...>) const
+            -> std::array<argument_descriptor, size_v> {
+            return {argument_descriptor {
+                std::get<I>(arguments).base.kind,
+                std::get<I>(arguments).base.name}...};
         }
     public:
-        positional_arguments(tuple_t&& arguments) :
-            arguments(std::move(arguments)) {
-            generate_bases(std::index_sequence_for<Arguments...>());
+        const tuple_type arguments;
+        const std::array<variant_type, size_v> bases;
+        const std::array<argument_descriptor, size_v> descriptors;
+
+        constexpr argument_schema(tuple_type&& arguments) :
+            arguments(std::move(arguments)),
+            bases(generate_bases(std::index_sequence_for<Arguments...>())),
+            descriptors(
+                generate_descriptors(std::index_sequence_for<Arguments...>())
+            ) {}
+
+        // Bases point into the schema itself.
+        argument_schema(const argument_schema&) = delete;
+
+        auto operator=(const argument_schema&) -> argument_schema& = delete;
+
+        auto print_help(std::ostream& out) const -> void {
+            print_arguments(out, bases);
         }
 
-        auto parse(std::span<const std::string_view> args) -> result_t {
-            auto args_begin = args.begin();
-            auto args_end = args.end();
+        auto describe(std::vector<argument_info>& arguments) const -> void {
+            describe_arguments(bases, arguments);
+        }
+
+        // Completes the positional argument at 'position'.
+        auto complete(std::size_t position, completion& result) const -> void {
+            complete_argument(bases, position, result);
+        }
 
-            auto bases_begin = bases.begin();
-            auto bases_end = bases.end();
+        constexpr auto size() const -> std::size_t { return size_v; }
+    };
 
-            while (bases_begin != bases_end) {
-                auto& current = *bases_begin++;
+    // The schema type for a tuple of arguments.
+    template <typename Tuple>
+    using argument_schema_t = decltype(argument_schema(std::declval<Tuple>()));
 
-                if (auto** arg = std::get_if<required_argument*>(&current)) {
-                    auto& base = **arg;
+    // The state of a single parse against an argument schema.
+    template <typename... Arguments>
+    class positional_arguments {
+        using schema_type = argument_schema<Arguments...>;
+        using tuple_type = typename schema_type::tuple_type;
+        using result_t = std::tuple<typename Arguments::type...>;
 
-                    if (args_begin == args_end) missing_value(base.name);
+        template <std::size_t N>
+        using type = typename std::tuple_element_t<N, tuple_type>::type;
 
-                    base.value = *args_begin++;
-                }
-                else if (auto** arg = std::get_if<optional_argument*>(&current)) {
-                    auto& base = **arg;
+        static constexpr auto size_v = schema_type::size_v;
 
-                    if (args_begin != args_end) base.value = *args_begin++;
-                }
-                else if (auto** arg = std::get_if<argument_list*>(&current)) {
-                    read_reverse(args_begin, args_end, bases_begin, bases_end);
+        std::unique_ptr<const schema_type> owned;
+        const schema_type* schema;
+        std::array<std::span<const std::string_view>, size_v> values;
 
-                    auto& base = **arg;
-                    base.values = std::span(args_begin, args_end);
+        template <std::size_t N>
+        auto value() const -> expected<type<N>> {
+            const auto& arg = std::get<N>(schema->arguments);
+            const auto words = values[N];
+            constexpr auto kind = decltype(arg.base)::kind;
 
-                    std::advance(args_begin, base.values.size());
-                }
+            if constexpr (kind == argument_kind::required) {
+                return arg.try_value(words.front());
             }
-
-            if (args_begin != args_end) {
-                throw cli_error("too many arguments");
+            else if constexpr (kind == argument_kind::optional) {
+                if (words.empty()) return arg.try_value(std::nullopt);
+                return arg.try_value(words.front());
             }
+            else return arg.try_value(words);
+        }
 
-            return get_values(std::index_sequence_for<Arguments...>());
+        template <std::size_t... I>
+        auto get_values(std::index_sequence<I...>) const
+            -> expected<result_t> {
+            return collect(value<I>()...);
         }
 
-        auto print_help(std::ostream& out) const -> void {
-            if (bases.empty()) return;
+    public:
+        using values_type = result_t;
 
-            for (const auto& base : bases) {
-                out << " ";
+        positional_arguments(const schema_type& schema) : schema(&schema) {}
 
-                std::visit([&out](auto* arg) { arg->print_help(out); }, base);
-            }
+        positional_arguments(tuple_type&& arguments) :
+            owned(std::make_unique<const schema_type>(std::move(arguments))),
+            schema(owned.get()) {}
+
+        auto parse(std::span<const std::string_view> args) -> result_t {
+            return try_parse(args).value();
+        }
+
+        // Like 'parse', but returns errors instead of throwing them.
+        auto try_parse(std::span<const std::string_view> args)
+            -> expected<result_t> {
+            auto status = parse_arguments(schema->descriptors, args, values);
+            if (!status) return std::move(status).error();
+
+            return get_values(std::index_sequence_for<Arguments...>());
+        }
+
+        auto print_help(std::ostream& out) const -> void {
+            schema->print_help(out);
         }
 
         constexpr auto size() const -> std::size_t { return size_v; }
     };
 
     template <typename... Arguments>
-    auto arguments(Arguments&&... args) -> std::tuple<Arguments...> {
+    positional_arguments(const argument_schema<Arguments...>&)
+        -> positional_arguments<Arguments...>;
+
+    template <typename... Arguments>
+    positional_arguments(std::tuple<Arguments...>&&)
+        -> positional_arguments<Arguments...>;
+
+    template <typename... Arguments>
+    constexpr auto arguments(Arguments&&... args) -> std::tuple<Arguments...> {
         return std::make_tuple(std::move(args)...);
     }
 }
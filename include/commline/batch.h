@@ -0,0 +1,58 @@
+#pragma once
+
+#include <commline/expected.h>
+
+#include <cstddef>
+#include <functional>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace commline {
+    struct batch_config {
+        // Separates command lines in the input.
+        char delimiter = '\n';
+
+        // Stop at the first command line that fails instead of continuing.
+        bool stop_on_error = false;
+
+        // Receives the exit status of each command line and a summary.
+        std::ostream* report = nullptr;
+
+        // Threads running command lines. With more than one, each command
+        // line writes to its own buffer, which is copied to the output when
+        // it is emitted. Zero uses one thread per hardware thread.
+        std::size_t threads = 1;
+
+        // Emit output as command lines finish instead of in input order.
+        bool completion_order = false;
+
+        // Receives the exit status of each command line, in the order its
+        // output is emitted.
+        std::vector<int>* statuses = nullptr;
+    };
+
+    using batch_invoke =
+        std::function<int(std::string_view line, std::ostream& out)>;
+
+    // Splits a command line into words following the quoting rules of a
+    // POSIX shell: single quotes preserve everything, double quotes allow
+    // backslash escapes of '"' and '\', and an unquoted backslash escapes
+    // any character. No expansions are performed. A quote left open or a
+    // trailing backslash is returned as an error.
+    auto split_words(std::string_view line, std::vector<std::string>& words)
+        -> expected<void>;
+
+    // Calls 'invoke' with every non-blank command line read from 'in' and
+    // the stream its output belongs on. With several threads, 'invoke' is
+    // called concurrently. Returns the exit status of the first failure to
+    // be emitted, or EXIT_SUCCESS when all command lines succeeded.
+    auto run_batch(
+        std::istream& in,
+        std::ostream& out,
+        const batch_config& config,
+        const batch_invoke& invoke
+    ) -> int;
+}
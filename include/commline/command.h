@@ -5,127 +5,342 @@
 #include <commline/context.h>
 #include <commline/option_list.h>
 
+#include <algorithm>
 #include <array>
+#include <cstdlib>
 #include <functional>
-#include <map>
 #include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
 
 namespace commline {
+    // Handlers returning a task are run by the event loop of 'task.h', which
+    // only they need include.
+    class task;
+
+    auto run(task task) -> void;
+
+    // The declared parameters of a command without their types: all that
+    // its help, description and completion need.
+    struct parameter_table {
+        option_table options;
+
+        // The help flag followed by the declared options.
+        std::span<const option_entry> option_entries;
+
+        std::span<const argument_entry> arguments;
+    };
+
     class command_node : public describable {
-        std::map<std::string_view, std::unique_ptr<command_node>> commands;
-    protected:
-        auto print_help(std::ostream& out) const -> void {
-            constexpr auto spacing = 15;
+        // Subcommands sorted by name. They either belong to a constant
+        // command set or are the nodes added through 'subcommand'.
+        std::span<command_node* const> commands;
 
-            if (commands.empty()) return;
+        std::vector<std::unique_ptr<command_node>> owned;
+        std::vector<command_node*> index;
 
-            print::header(out, "Commands");
+        mutable std::mutex help_mutex;
+        mutable std::optional<std::string> help_text;
 
-            for (const auto& [key, value] : commands) {
-                print::indent(out);
-                out << key;
+        // Options are also read from variables beginning with this prefix.
+        // Each node keeps a copy, so the caller's string need not outlive it.
+        std::string env_prefix;
 
-                print::spaces(out, spacing - key.size());
-                out << value->description << "\n";
-            }
+        auto find(std::string_view name) const -> command_node*;
+
+        auto clear_help() -> void;
+
+        auto render_help(std::ostream& out) const -> void;
+    protected:
+        // Makes 'children', which must be sorted by name and outlive this
+        // node, its subcommands.
+        constexpr auto adopt(std::span<command_node* const> children) -> void {
+            commands = children;
         }
+
+        virtual auto parameters() const -> parameter_table = 0;
+
+        // The part of running a command that does not depend on its
+        // parameters. Parses 'args' into 'values' and 'positional', then
+        // sets what the command line left unset from the environment and
+        // the configuration. Returns false if help was asked for, in which
+        // case it has been written to 'out' and the handler must not run.
+        auto prepare(
+            const app& context,
+            const option_values& values,
+            argv args,
+            std::pmr::vector<std::string_view>& positional,
+            std::ostream& out
+        ) const -> expected<bool>;
     public:
         const std::string_view name;
 
-        command_node(std::string_view name, std::string_view description) :
+        constexpr command_node(
+            std::string_view name,
+            text description
+        ) :
             describable(description),
             name(name) {}
 
-        virtual ~command_node() {}
+        constexpr virtual ~command_node() {}
 
+        // Runs the command with 'args'. Returns the exit status, which is
+        // zero unless the handler returns one of its own, or the error in
+        // the command line. Errors from the handler are thrown.
         virtual auto execute(const app& context, argv args, std::ostream& out)
-            -> void = 0;
+            -> expected<int> = 0;
 
-        auto find(iterator& first, iterator last) -> command_node* {
-            if (first != last) {
-                auto node = commands.find(*first);
+        // The command's help text. It is rendered on first use and kept
+        // until a subcommand is added.
+        auto help() const -> const std::string&;
 
-                if (node != commands.end()) {
-                    return node->second->find(++first, last);
-                }
-            }
+        // Describes this command and, recursively, its subcommands.
+        auto describe() const -> command_info;
 
-            return this;
-        }
+        // Lists the candidates for the word following 'first' through 'last'
+        // using only the declared parameters: nothing the handler needs is
+        // constructed.
+        auto complete(iterator first, iterator last, completion& result) const
+            -> void;
 
-        auto subcommand(std::unique_ptr<command_node>&& node) -> command_node* {
-            auto result = commands.insert({node->name, std::move(node)});
+        auto find(iterator& first, iterator last) -> command_node*;
 
-            return result.first->second.get();
-        }
+        // Adds 'node' unless a subcommand of the same name exists, and
+        // returns the subcommand of that name.
+        auto subcommand(std::unique_ptr<command_node>&& node) -> command_node*;
+
+        // Reads the options of this command and its subcommands from
+        // variables beginning with 'prefix' when the command line does not
+        // set them, as well as from the variables the options name. An
+        // option's variable is the prefix followed by its first long alias
+        // in upper case, with dashes replaced by underscores.
+        auto use_environment(std::string_view prefix) -> void;
     };
 
-    template <typename Callable, typename Options, typename Arguments>
-    class command_impl : public command_node {
-        Callable fn;
+    template <
+        typename Callable,
+        typename Options,
+        typename Arguments,
+        typename Commands = std::tuple<>>
+    class command_impl;
+
+    // Everything needed to construct a command in place, so that a whole
+    // command tree can be built by one constant expression.
+    template <
+        typename Callable,
+        typename Options,
+        typename Arguments,
+        typename Commands = std::tuple<>>
+    struct command_spec {
+        using node_type = command_impl<Callable, Options, Arguments, Commands>;
+
+        std::string_view name;
+        text description;
         Options options;
         Arguments arguments;
+        Callable fn;
+        Commands commands;
+    };
 
-        template <typename Opts, typename Args>
-        auto print_help(std::ostream& out, const Opts& opts, const Args& args)
-            const -> void {
-            out << description << "\n\n"
-                << "Usage: " << name;
+    // The subcommands of a command, stored by value along with their
+    // pointers sorted by name.
+    template <typename Specs>
+    class command_set;
 
-            if (opts.size() > 0) {
-                out << " [options]";
-                if (args.size() > 0) out << " [--]";
-            }
+    template <typename... Specs>
+    class command_set<std::tuple<Specs...>> {
+        std::tuple<typename Specs::node_type...> nodes;
+        std::array<command_node*, sizeof...(Specs)> sorted;
+    public:
+        constexpr command_set(std::tuple<Specs...>&& specs) :
+            nodes(std::move(specs)),
+            sorted(std::apply(
+                [](auto&... node) {
+                    return std::array<command_node*, sizeof...(Specs)> {
+                        &node...};
+                },
+                nodes
+            )) {
+            std::ranges::sort(sorted, {}, &command_node::name);
+        }
 
-            args.print_help(out);
-            out << "\n";
+        // Nodes point into the set itself.
+        command_set(const command_set&) = delete;
 
-            opts.print_help(out);
+        auto operator=(const command_set&) -> command_set& = delete;
 
-            command_node::print_help(out);
+        constexpr auto get() const noexcept -> std::span<command_node* const> {
+            return sorted;
         }
-    public:
-        command_impl(
+    };
+
+    // The part of a command that depends only on its parameters and
+    // subcommands. Commands declaring the same options and arguments share
+    // it, whatever their handlers.
+    template <typename Options, typename Arguments, typename Commands>
+    class command_base : public command_node {
+        const command_set<Commands> children;
+
+        auto parameters() const -> parameter_table override {
+            return {options.parse_table(), options.entries, arguments.bases};
+        }
+    protected:
+        // Enough for the positional arguments of typical command lines.
+        // Longer ones spill over to the heap.
+        static constexpr auto parse_buffer_size = std::size_t(1024);
+
+        using option_list_type = decltype(option_list(
+            std::declval<const option_schema_t<Options>&>()
+        ));
+
+        using argument_list_type = decltype(positional_arguments(
+            std::declval<const argument_schema_t<Arguments>&>()
+        ));
+
+        // The values a handler receives after the context.
+        using parameters_type = decltype(std::tuple_cat(
+            std::declval<typename option_list_type::values_type>(),
+            std::declval<typename argument_list_type::values_type>()
+        ));
+
+        const option_schema_t<Options> options;
+        const argument_schema_t<Arguments> arguments;
+
+        constexpr command_base(
             std::string_view name,
-            std::string_view description,
-            Callable&& fn,
+            text description,
             Options&& options,
-            Arguments&& arguments
+            Arguments&& arguments,
+            Commands&& commands
         ) :
             command_node(name, description),
-            fn(std::move(fn)),
+            children(std::move(commands)),
             options(std::move(options)),
-            arguments(std::move(arguments)) {}
+            arguments(std::move(arguments)) {
+            adopt(children.get());
+        }
+
+        // Parses 'args' into the parameters of a handler. Nothing is
+        // returned if help was asked for instead. The parameters may refer
+        // to 'opts' and 'positional', which must outlive the handler.
+        auto parse_parameters(
+            const app& context,
+            argv args,
+            option_list_type& opts,
+            std::pmr::vector<std::string_view>& positional,
+            std::ostream& out
+        ) const -> expected<std::optional<parameters_type>> {
+            const auto ready =
+                prepare(context, opts.state(), args, positional, out);
+            if (!ready) return ready.error();
+            if (!*ready) return std::optional<parameters_type>();
+
+            auto values = opts.try_extract();
+            if (!values) return std::move(values).error();
+
+            auto words = argument_list_type(arguments).try_parse(positional);
+            if (!words) return std::move(words).error();
+
+            return std::optional<parameters_type>(
+                std::tuple_cat(*std::move(values), *std::move(words))
+            );
+        }
+    public:
+        constexpr virtual ~command_base() {}
+    };
+
+    template <
+        typename Callable,
+        typename Options,
+        typename Arguments,
+        typename Commands>
+    class command_impl : public command_base<Options, Arguments, Commands> {
+        using base = command_base<Options, Arguments, Commands>;
+
+        const Callable fn;
+    public:
+        constexpr command_impl(
+            std::string_view name,
+            text description,
+            Callable&& fn,
+            Options&& options,
+            Arguments&& arguments,
+            Commands&& commands = Commands()
+        ) :
+            base(
+                name,
+                description,
+                std::move(options),
+                std::move(arguments),
+                std::move(commands)
+            ),
+            fn(std::move(fn)) {}
+
+        constexpr command_impl(
+            command_spec<Callable, Options, Arguments, Commands>&& spec
+        ) :
+            command_impl(
+                spec.name,
+                spec.description,
+                std::move(spec.fn),
+                std::move(spec.options),
+                std::move(spec.arguments),
+                std::move(spec.commands)
+            ) {}
 
-        virtual ~command_impl() {}
+        constexpr virtual ~command_impl() {}
 
+        // The declared options and arguments are never modified: all parse
+        // state lives in this call, so a command may be executed any number
+        // of times and from several threads at once. A handler that returns
+        // an 'int' gives the exit status.
         auto execute(const app& context, argv argv, std::ostream& out)
-            -> void override {
-            auto opts = option_list(std::move(options));
-            auto args = positional_arguments(std::move(arguments));
+            -> expected<int> override {
+            alignas(std::max_align_t) auto buffer =
+                std::array<std::byte, base::parse_buffer_size>();
+            auto resource = std::pmr::monotonic_buffer_resource(
+                buffer.data(),
+                buffer.size()
+            );
 
-            const auto positional = opts.parse(argv);
+            auto opts = typename base::option_list_type(this->options);
+            auto positional = std::pmr::vector<std::string_view>(&resource);
 
-            if (opts.help()) {
-                print_help(out, opts, args);
-                return;
-            }
+            auto values =
+                this->parse_parameters(context, argv, opts, positional, out);
+            if (!values) return std::move(values).error();
+            if (!*values) return EXIT_SUCCESS;
 
-            std::apply(
-                fn,
-                std::tuple_cat(
-                    std::make_tuple(context),
-                    opts.extract(),
-                    args.parse(positional)
-                )
+            auto params = std::tuple_cat(
+                std::make_tuple(context),
+                **std::move(values)
             );
+
+            using result_type = decltype(std::apply(fn, std::move(params)));
+
+            // The parameters outlive the task, which may refer to them.
+            if constexpr (std::is_same_v<result_type, task>) {
+                commline::run(std::apply(fn, std::move(params)));
+            }
+            else if constexpr (std::is_same_v<result_type, int>) {
+                return std::apply(fn, std::move(params));
+            }
+            else std::apply(fn, std::move(params));
+
+            return EXIT_SUCCESS;
         }
     };
 
     template <typename Callable, typename Options, typename Arguments>
     auto command(
         std::string_view name,
-        std::string_view description,
+        text description,
         Options&& options,
         Arguments&& arguments,
         Callable&& fn
@@ -138,4 +353,36 @@ namespace commline {
             std::move(arguments)
         );
     }
+
+    // Declares a command for 'commands', as in
+    // 'subcommand("add", "Add a remote", options(), arguments(), add)'.
+    template <
+        typename Callable,
+        typename Options,
+        typename Arguments,
+        typename Commands = std::tuple<>>
+    constexpr auto subcommand(
+        std::string_view name,
+        text description,
+        Options&& options,
+        Arguments&& arguments,
+        Callable&& fn,
+        Commands&& commands = Commands()
+    ) -> command_spec<Callable, Options, Arguments, Commands> {
+        return {
+            name,
+            description,
+            std::move(options),
+            std::move(arguments),
+            std::move(fn),
+            std::move(commands)};
+    }
+
+    // Subcommands declared up front. Unlike those added with
+    // 'command_node::subcommand', they are stored in their parent and can be
+    // part of a 'constinit' application.
+    template <typename... Specs>
+    constexpr auto commands(Specs&&... specs) -> std::tuple<Specs...> {
+        return std::make_tuple(std::move(specs)...);
+    }
 }
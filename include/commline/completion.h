@@ -0,0 +1,136 @@
+#pragma once
+
+#include <commline/argv.h>
+#include <commline/expected.h>
+
+#include <chrono>
+#include <functional>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace commline {
+    // The hidden command that lists the candidates for a word of a command
+    // line, as in 'app __complete 2 -- app remote ad'.
+    constexpr auto complete_command = std::string_view("__complete");
+
+    // Lists the possible values of an option or argument. Values that do not
+    // begin with 'prefix' are discarded, so a completer may ignore it.
+    using completer =
+        std::function<std::vector<std::string>(std::string_view prefix)>;
+
+    // How long the candidates listed by a completer may be reused by later
+    // completions of the same word.
+    struct cache_policy {
+        // Candidates are not cached when this is zero.
+        std::chrono::seconds ttl = std::chrono::seconds::zero();
+
+        // Computes a value that changes whenever cached candidates become
+        // stale, such as the modification time of the file they come from.
+        std::function<std::string()> stamp;
+    };
+
+    // A stamp that changes whenever the file at 'path' is modified.
+    auto modification_time(std::string path) -> std::function<std::string()>;
+
+    // Parameters keep their provider in a 'std::optional' so that those
+    // without one can be constant-initialized, which 'std::function' cannot.
+    struct candidate_provider {
+        completer list;
+        cache_policy cache;
+
+        explicit operator bool() const noexcept {
+            return static_cast<bool>(list);
+        }
+    };
+
+    // Sets the completer of an option or argument, as in
+    // 'complete(option<std::string>({"host"}, "Server", "name"), hosts)'.
+    template <typename Parameter>
+    auto complete(
+        Parameter parameter,
+        completer fn,
+        cache_policy cache = {}
+    ) -> Parameter {
+        parameter.base.provider =
+            candidate_provider {std::move(fn), std::move(cache)};
+        return parameter;
+    }
+
+    class completion_cache;
+
+    // The command line being completed.
+    struct completion_request {
+        // The words before the cursor, excluding the program name.
+        argv preceding;
+
+        // The word under the cursor, which is empty past the last word.
+        std::string_view word;
+
+        // Reads '<index> -- <words>...', where the index of the word under
+        // the cursor counts from the program name.
+        static auto parse(argv args) -> completion_request {
+            return try_parse(args).value();
+        }
+
+        static auto try_parse(argv args) -> expected<completion_request>;
+    };
+
+    // Where a tolerant scan of the words before the cursor leaves the word
+    // under it.
+    struct completion_point {
+        // The option entry whose value the word is, if any.
+        std::optional<std::size_t> option;
+
+        // The number of positional arguments before the word.
+        std::size_t argument = 0;
+
+        // Whether a '--' ended the options.
+        bool options_ended = false;
+    };
+
+    // The word under the cursor and the candidates found for it.
+    class completion {
+        // The names leading to the command being completed.
+        std::string command;
+
+        // The part of the word every candidate keeps, such as '--name='.
+        std::string_view lead;
+
+        std::vector<std::string> candidates;
+
+        completion_cache* cache;
+    public:
+        // The part of the word candidates must begin with.
+        std::string_view prefix;
+
+        // Candidates are cached in 'cache' when it is given and their
+        // completer allows it.
+        completion(
+            std::string_view program,
+            std::string_view word,
+            completion_cache* cache = nullptr
+        );
+
+        // Moves on to the subcommand 'name'.
+        auto enter(std::string_view name) -> void;
+
+        // Completes only the part of the word following its first 'count'
+        // characters.
+        auto narrow(std::size_t count) -> void;
+
+        auto add(std::string_view candidate) -> void;
+
+        // Adds the values listed for 'parameter', an option or argument of
+        // the current command.
+        auto provide(
+            const std::optional<candidate_provider>& provider,
+            std::string_view parameter
+        ) -> void;
+
+        // Writes the candidates, one per line.
+        auto write(std::ostream& out) const -> void;
+    };
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <commline/response_file.h>
+
+#include <chrono>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace commline {
+    // Candidates listed by completers, kept in a file so that pressing Tab
+    // again does not call the completer again. The file is memory-mapped and
+    // holds its entries sorted by key, so a lookup is a binary search over
+    // the mapping. Entries expire after their completer's TTL or as soon as
+    // its stamp changes.
+    //
+    // The cache is only a shortcut: a file that is missing, damaged or
+    // cannot be written is treated as empty.
+    class completion_cache {
+    public:
+        using clock = std::chrono::system_clock;
+    private:
+        std::string path;
+        std::optional<mapped_file> file;
+
+        auto contents() -> std::span<const char>;
+    public:
+        // Keeps the cache in '$XDG_CACHE_HOME/<program>/completions', or
+        // under '~/.cache' if the variable is not set.
+        explicit completion_cache(std::string_view program);
+
+        // The key of the candidates of an option or argument of a command
+        // for words beginning with 'prefix'.
+        static auto key(
+            std::string_view command,
+            std::string_view parameter,
+            std::string_view prefix
+        ) -> std::string;
+
+        auto location() const noexcept -> const std::string& { return path; }
+
+        // Returns the candidates stored for 'key' unless they have expired
+        // or were stored with a different stamp. The candidates point into
+        // the mapped file and remain valid until the next call to 'store'.
+        auto find(
+            std::string_view key,
+            std::string_view stamp,
+            clock::time_point now = clock::now()
+        ) -> std::optional<std::vector<std::string_view>>;
+
+        // Replaces the candidates stored for 'key'. Expired entries are
+        // dropped while the file is rewritten.
+        auto store(
+            std::string_view key,
+            std::string_view stamp,
+            std::chrono::seconds ttl,
+            std::span<const std::string> candidates,
+            clock::time_point now = clock::now()
+        ) -> void;
+    };
+}
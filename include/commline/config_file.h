@@ -0,0 +1,139 @@
+#pragma once
+
+#include <commline/argv.h>
+#include <commline/expected.h>
+#include <commline/response_file.h>
+
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace commline {
+    struct config_entry {
+        std::string_view key;
+        std::string_view value;
+    };
+
+    // The entries of one section of a configuration file, in file order.
+    // They point into the file's snapshot.
+    class config_section {
+        std::span<const char> data;
+        std::uint64_t first = 0;
+        std::uint64_t count = 0;
+    public:
+        constexpr config_section() = default;
+
+        constexpr config_section(
+            std::span<const char> data,
+            std::uint64_t first,
+            std::uint64_t count
+        ) :
+            data(data),
+            first(first),
+            count(count) {}
+
+        auto at(std::uint64_t index) const -> config_entry;
+
+        constexpr auto empty() const noexcept -> bool { return count == 0; }
+
+        constexpr auto size() const noexcept -> std::uint64_t { return count; }
+    };
+
+    // Option values read from a file such as:
+    //
+    //     # Applies to the application's own options.
+    //     jobs = 4
+    //
+    //     [remote add]
+    //     fetch
+    //     tags = false
+    //
+    // Keys are option aliases, and a key without a value sets a flag. Keys
+    // before the first section belong to the application itself; those in
+    // a section belong to the subcommand with that path, where any run of
+    // whitespace separates two words. Blank lines and lines beginning with
+    // '#' or ';' are ignored.
+    //
+    // The file is read when a section is first requested. It is then kept
+    // as a binary snapshot in the cache directory of 'program', under a
+    // name derived from its path, and later runs map the snapshot instead
+    // of parsing the file again for as long as the file's size and
+    // modification time are unchanged. A missing file has no entries.
+    class config_file {
+        std::string path;
+        std::string snapshot_path;
+
+        std::once_flag loaded;
+        std::optional<mapped_file> snapshot;
+        std::string parsed;
+        std::span<const char> data;
+
+        // Why the file could not be read, if it could not.
+        std::optional<parse_error> failure;
+
+        auto load() -> expected<void>;
+    public:
+        config_file(std::string_view program, std::string_view path);
+
+        config_file(const config_file&) = delete;
+
+        auto operator=(const config_file&) -> config_file& = delete;
+
+        auto location() const noexcept -> const std::string& { return path; }
+
+        // Where the snapshot is kept, or an empty string if there is no
+        // cache directory.
+        auto snapshot_location() const noexcept -> const std::string& {
+            return snapshot_path;
+        }
+
+        // The entries of the section 'name', where the name of a section
+        // is the path of its command, as in 'remote add'. Returns the error
+        // that kept the file from being read, for every call. Safe to call
+        // from several threads.
+        auto section(std::string_view name) -> expected<config_section>;
+
+        // The section of the command reached through the words 'path'.
+        auto section(argv path) -> expected<config_section>;
+    };
+
+    // Owns a 'config_file'. Applications hold theirs through this rather
+    // than a 'std::unique_ptr', whose destructor is not constexpr before
+    // C++23 and would keep 'constinit' applications from being literal
+    // types.
+    class config_ptr {
+        config_file* file = nullptr;
+    public:
+        constexpr config_ptr() = default;
+
+        explicit config_ptr(config_file* file) noexcept : file(file) {}
+
+        config_ptr(const config_ptr&) = delete;
+
+        constexpr config_ptr(config_ptr&& other) noexcept :
+            file(std::exchange(other.file, nullptr)) {}
+
+        constexpr ~config_ptr() { delete file; }
+
+        auto operator=(const config_ptr&) -> config_ptr& = delete;
+
+        constexpr auto operator=(config_ptr&& other) noexcept -> config_ptr& {
+            if (this != &other) {
+                delete file;
+                file = std::exchange(other.file, nullptr);
+            }
+
+            return *this;
+        }
+
+        constexpr explicit operator bool() const noexcept { return file; }
+
+        constexpr auto operator->() const noexcept -> config_file* {
+            return file;
+        }
+    };
+}
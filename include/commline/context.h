@@ -1,5 +1,7 @@
 #pragma once
 
+#include <commline/config_file.h>
+
 #include <sstream>
 #include <string_view>
 
@@ -9,6 +11,13 @@ namespace commline {
         const std::string_view version;
         const std::string_view description;
         const std::string_view argv0;
+
+        // The section of the configuration file that applies to the
+        // command being run.
+        const config_section config = {};
+
+        // Why the configuration file could not be read, if it could not.
+        const parse_error* const config_error = nullptr;
     };
 
     auto print_version(std::ostream& os, const app& a) -> void;
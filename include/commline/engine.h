@@ -0,0 +1,119 @@
+#pragma once
+
+#include <commline/alias_table.h>
+#include <commline/argv.h>
+#include <commline/completion.h>
+#include <commline/config_file.h>
+#include <commline/expected.h>
+#include <commline/option.h>
+#include <commline/schema.h>
+
+#include <cstdint>
+#include <memory_resource>
+#include <span>
+#include <string_view>
+#include <vector>
+
+// The argv-walking half of parsing. Option lists and positional arguments
+// describe themselves to these functions with plain tables, so the walking
+// code is compiled once in the library rather than once per command; only
+// the conversion of the results to typed values is left to templates.
+// Errors in the command line are returned rather than thrown.
+namespace commline {
+    enum class option_kind : std::uint8_t {
+        no_argument,
+        single_argument,
+        multiple_arguments
+    };
+
+    // Where the parse state of an option entry lives: its kind and its
+    // position among the states of that kind.
+    struct option_slot {
+        option_kind kind;
+        alias_table_base::index_type index;
+    };
+
+    // The options of a command: their aliases, where each keeps its state
+    // and how list values are split. Environment variables named by the
+    // options are looked up in 'variables'; 'variable_names' and
+    // 'long_names' hold each entry's own variable and first long alias.
+    struct option_table {
+        alias_lookup aliases;
+        std::span<const option_slot> slots;
+        std::span<const list_format> formats;
+        alias_lookup variables;
+        std::span<const std::string_view> variable_names;
+        std::span<const std::string_view> long_names;
+    };
+
+    // The parse state of a command's options, one array per kind.
+    // 'flag_set' records which flags were given a value, so that a flag
+    // turned off in the environment is not set again by a configuration.
+    struct option_values {
+        std::span<bool> flags;
+        std::span<bool> flag_set;
+        std::span<bool> has_value;
+        std::span<std::string_view> values;
+        std::span<std::pmr::vector<std::string_view>> lists;
+    };
+
+    // Clears 'values' and makes lists allocate from 'resource'.
+    auto reset_options(
+        const option_values& values,
+        std::pmr::memory_resource* resource
+    ) -> void;
+
+    // Sets the options found in 'args' and appends every other word to
+    // 'positional'. Values that were already set are kept or added to.
+    // Running out of the buffer of a 'fixed_buffer_resource' that
+    // 'positional' allocates from is reported as a parse error.
+    auto parse_options(
+        const option_table& table,
+        const option_values& values,
+        argv args,
+        std::pmr::vector<std::string_view>& positional
+    ) -> expected<void>;
+
+    // Sets the options that 'parse_options' left unset from the
+    // environment in a single pass over 'environ'. An option is read from
+    // its own variable or, when 'prefix' is not empty and it has none, from
+    // 'prefix' followed by its first long alias in upper case with dashes
+    // as underscores. A flag is set by any value other than an empty
+    // string, '0' or 'false'.
+    auto read_environment(
+        const option_table& table,
+        const option_values& values,
+        std::string_view prefix
+    ) -> void;
+
+    // Sets the options still unset after the command line and the
+    // environment were read from 'section' of a configuration file. Later
+    // entries for an option replace earlier ones, or add to them for list
+    // options. Flag values are read as they are from the environment.
+    auto read_config(
+        const option_table& table,
+        const option_values& values,
+        const config_section& section
+    ) -> expected<void>;
+
+    // Finds what the word following 'args' is expected to be. No values
+    // are kept, and unknown options are skipped rather than reported since
+    // the command line is still being typed.
+    auto scan_options(const option_table& table, argv args)
+        -> completion_point;
+
+    struct argument_descriptor {
+        argument_kind kind;
+        std::string_view name;
+    };
+
+    // Assigns 'args' to 'arguments', storing the words each receives in
+    // 'values': one word for a required argument, at most one for an
+    // optional argument and the rest for a variadic argument. Arguments that
+    // follow a variadic argument are filled from the end.
+    auto parse_arguments(
+        std::span<const argument_descriptor> arguments,
+        std::span<const std::string_view> args,
+        std::span<std::span<const std::string_view>> values
+    ) -> expected<void>;
+}
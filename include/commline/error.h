@@ -1,5 +1,6 @@
 #pragma once
 
+#include <exception>
 #include <fmt/core.h>
 #include <stdexcept>
 
@@ -12,4 +13,15 @@ namespace commline {
                 std::forward<Args>(args)...
             )) {}
     };
+
+    // Prints the message of the exception in 'eptr', if any, to standard
+    // error.
+    auto print_error(std::exception_ptr eptr) -> void;
+
+    // Throws a 'std::length_error'. Being out of line, it ends any constant
+    // expression that reaches it, and the headers that call it compile
+    // without exceptions. A library built without exceptions prints 'what'
+    // and aborts instead.
+    [[noreturn]]
+    auto throw_length_error(const char* what) -> void;
 }
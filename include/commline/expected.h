@@ -0,0 +1,155 @@
+#pragma once
+
+#include <commline/error.h>
+
+#include <exception>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+namespace commline {
+    // Why a command line could not be parsed. Parsing returns these rather
+    // than throwing them, so a malformed command line costs no unwinding.
+    struct parse_error {
+        std::string message;
+
+        // The system error behind the failure, such as a response file that
+        // could not be opened. It is the exit status of the command.
+        std::error_code code;
+
+        template <typename... Args>
+        explicit parse_error(std::string_view format_string, Args&&... args) :
+            message(fmt::format(
+                fmt::runtime(format_string),
+                std::forward<Args>(args)...
+            )) {}
+
+        parse_error(std::error_code code, std::string message) :
+            message(std::move(message)),
+            code(code) {}
+
+        // The 'cli_error', or 'std::system_error' if there is a code, that
+        // 'raise' throws, for error handlers.
+        auto exception() const -> std::exception_ptr;
+
+        // Prints the message to standard error as 'print_error' would print
+        // the exception.
+        auto print() const -> void;
+
+        // Throws the error. Code built without exceptions may call this, but
+        // cannot catch what it throws; a library built without exceptions
+        // prints the error and aborts instead.
+        [[noreturn]]
+        auto raise() const -> void;
+    };
+
+    // A value or the parse error that took its place, with the interface of
+    // 'std::expected' and the error type fixed. Only 'value' throws.
+    template <typename T>
+    class expected {
+        std::variant<T, parse_error> storage;
+    public:
+        using value_type = T;
+
+        template <typename U = T>
+        requires std::is_convertible_v<U, T> &&
+                 (!std::is_same_v<std::remove_cvref_t<U>, parse_error>)
+        expected(U&& value) :
+            storage(std::in_place_index<0>, std::forward<U>(value)) {}
+
+        expected(parse_error error) :
+            storage(std::in_place_index<1>, std::move(error)) {}
+
+        auto has_value() const noexcept -> bool {
+            return storage.index() == 0;
+        }
+
+        explicit operator bool() const noexcept { return has_value(); }
+
+        auto operator*() & noexcept -> T& { return *std::get_if<0>(&storage); }
+
+        auto operator*() const& noexcept -> const T& {
+            return *std::get_if<0>(&storage);
+        }
+
+        auto operator*() && noexcept -> T&& {
+            return std::move(*std::get_if<0>(&storage));
+        }
+
+        auto operator->() noexcept -> T* { return std::get_if<0>(&storage); }
+
+        auto operator->() const noexcept -> const T* {
+            return std::get_if<0>(&storage);
+        }
+
+        auto error() & noexcept -> parse_error& {
+            return *std::get_if<1>(&storage);
+        }
+
+        auto error() const& noexcept -> const parse_error& {
+            return *std::get_if<1>(&storage);
+        }
+
+        auto error() && noexcept -> parse_error&& {
+            return std::move(*std::get_if<1>(&storage));
+        }
+
+        auto value() const& -> const T& {
+            if (!has_value()) error().raise();
+            return **this;
+        }
+
+        auto value() && -> T {
+            if (!has_value()) error().raise();
+            return *std::move(*this);
+        }
+    };
+
+    // The outcome of a step that produces no value.
+    template <>
+    class expected<void> {
+        std::optional<parse_error> failure;
+    public:
+        using value_type = void;
+
+        expected() = default;
+
+        expected(parse_error error) : failure(std::move(error)) {}
+
+        auto has_value() const noexcept -> bool { return !failure; }
+
+        explicit operator bool() const noexcept { return has_value(); }
+
+        auto error() & noexcept -> parse_error& { return *failure; }
+
+        auto error() const& noexcept -> const parse_error& { return *failure; }
+
+        auto error() && noexcept -> parse_error&& {
+            return std::move(*failure);
+        }
+
+        auto value() const -> void {
+            if (failure) failure->raise();
+        }
+    };
+
+    // The values of 'results' as a tuple, or the first of their errors.
+    template <typename... T>
+    auto collect(expected<T>&&... results) -> expected<std::tuple<T...>> {
+        parse_error* error = nullptr;
+
+        (
+            [&] {
+                if (!error && !results) error = &results.error();
+            }(),
+            ...
+        );
+
+        if (error) return std::move(*error);
+        return std::tuple<T...>(*std::move(results)...);
+    }
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <commline/parser.h>
+
+#include <functional>
+#include <optional>
+#include <string_view>
+
+namespace commline {
+    // An option or argument type that keeps the raw argument and converts it
+    // with 'parser<T>' only when the value is first read. The result is
+    // cached; reading is not synchronized between threads.
+    template <typename T>
+    class lazy {
+        std::optional<std::string_view> argument;
+        mutable std::optional<T> value;
+    public:
+        static auto defer(std::string_view argument) -> lazy {
+            auto result = lazy();
+            result.argument = argument;
+            return result;
+        }
+
+        lazy() = default;
+
+        lazy(T&& value) : value(std::move(value)) {}
+
+        auto converted() const noexcept -> bool { return value.has_value(); }
+
+        // Converts the argument on first use, throwing any error.
+        auto get() const -> const T& { return try_get().value(); }
+
+        // Like 'get', but returns conversion errors instead of throwing them.
+        // A value that failed to convert is converted again on the next read.
+        auto try_get() const -> expected<std::reference_wrapper<const T>> {
+            if (!value) {
+                if (!argument) value.emplace();
+                else {
+                    auto converted = convert<T>(*argument);
+                    if (!converted) return std::move(converted).error();
+
+                    value.emplace(*std::move(converted));
+                }
+            }
+
+            return std::cref(*value);
+        }
+
+        auto operator*() const -> const T& { return get(); }
+
+        auto operator->() const -> const T* { return &get(); }
+
+        auto raw() const noexcept -> std::optional<std::string_view> {
+            return argument;
+        }
+    };
+
+    template <typename T>
+    struct parser<lazy<T>> {
+        static auto parse(std::string_view argument) -> lazy<T> {
+            return lazy<T>::defer(argument);
+        }
+    };
+}
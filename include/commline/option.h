@@ -1,43 +1,209 @@
 #pragma once
 
 #include <commline/argv.h>
+#include <commline/completion.h>
 #include <commline/parser.h>
 #include <commline/print.h>
-
+#include <commline/schema.h>
+#include <commline/text.h>
+#include <commline/view.h>
+
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <initializer_list>
+#include <memory_resource>
 #include <optional>
 #include <ostream>
+#include <span>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 namespace commline {
     struct describable {
-        const std::string description;
+        const text description;
     protected:
-        describable(std::string_view description);
+        constexpr describable(text description) :
+            description(std::move(description)) {}
+    };
+
+    // A name given to an option. Names given as a 'std::string' are copied
+    // by the option; others are viewed, like other text.
+    struct alias_name {
+        std::string_view view;
+        bool copy = false;
+
+        constexpr alias_name(const char* view) : view(view) {}
+
+        constexpr alias_name(std::string_view view) : view(view) {}
+
+        constexpr alias_name(const std::string& source) :
+            view(source),
+            copy(true) {}
+    };
+
+    // The names of an option. Up to 'capacity' names are kept inline, so
+    // that options can be constant-initialized; options with more keep
+    // them on the heap, as do those with names given as a 'std::string'.
+    class alias_list {
+    public:
+        static constexpr auto capacity = std::size_t(4);
+    private:
+        std::array<std::string_view, capacity> local = {};
+        std::string_view* spilled = nullptr;
+        std::size_t count = 0;
+
+        // The names given as a 'std::string', one after another.
+        text storage;
+
+        constexpr auto names() noexcept -> std::string_view* {
+            return spilled ? spilled : local.data();
+        }
+    public:
+        constexpr alias_list(std::initializer_list<alias_name> names) :
+            count(names.size()) {
+            if (count > capacity) spilled = new std::string_view[count];
+
+            auto joined = std::string();
+            for (const auto& name : names) {
+                if (name.copy) joined.append(name.view);
+            }
+
+            if (!joined.empty()) storage = text(joined);
+
+            auto offset = std::size_t(0);
+            auto* out = this->names();
+
+            for (const auto& name : names) {
+                if (!name.copy) {
+                    *out++ = name.view;
+                    continue;
+                }
+
+                *out++ = std::string_view(storage).substr(
+                    offset,
+                    name.view.size()
+                );
+                offset += name.view.size();
+            }
+        }
+
+        constexpr alias_list(const alias_list& other) :
+            local(other.local),
+            count(other.count),
+            storage(other.storage) {
+            if (other.spilled) {
+                spilled = new std::string_view[count];
+                std::ranges::copy(other, spilled);
+            }
+
+            if (!storage.owned()) return;
+
+            // Names in the other list's storage are moved to this one's.
+            const auto* const first = other.storage.data();
+            const auto* const last = first + other.storage.size();
+            const auto before = std::less<const char*>();
+
+            for (auto& name : std::span(names(), count)) {
+                if (before(name.data(), first) || !before(name.data(), last)) {
+                    continue;
+                }
+
+                name = std::string_view(
+                    storage.data() + (name.data() - first),
+                    name.size()
+                );
+            }
+        }
+
+        constexpr ~alias_list() { delete[] spilled; }
+
+        auto operator=(const alias_list&) -> alias_list& = delete;
+
+        constexpr auto begin() const noexcept -> const std::string_view* {
+            return data();
+        }
+
+        constexpr auto end() const noexcept -> const std::string_view* {
+            return data() + count;
+        }
+
+        constexpr auto data() const noexcept -> const std::string_view* {
+            return spilled ? spilled : local.data();
+        }
+
+        constexpr auto size() const noexcept -> std::size_t { return count; }
+
+        constexpr auto front() const noexcept -> std::string_view {
+            return *data();
+        }
+
+        // The first alias longer than one character, or an empty string if
+        // there is none.
+        constexpr auto long_name() const noexcept -> std::string_view {
+            for (const auto alias : *this) {
+                if (alias.size() > 1) return alias;
+            }
+
+            return {};
+        }
     };
 
+    // The character that stands for 'c' of an option name in the name of
+    // its environment variable: letters in upper case, dashes replaced by
+    // underscores, and everything else unchanged.
+    constexpr auto environment_character(char c) noexcept -> char {
+        if (c == '-') return '_';
+        if (c >= 'a' && c <= 'z') return c - 'a' + 'A';
+        return c;
+    }
+
+    // The environment variable an option named 'name' is read from when an
+    // application reads options from variables beginning with 'prefix':
+    // the prefix followed by the name with each character mapped by
+    // 'environment_character'.
+    auto environment_variable(std::string_view prefix, std::string_view name)
+        -> std::string;
+
+    // Options only describe themselves. The values found while parsing are
+    // kept by the option list in an object of the option's 'state' type, so
+    // a declared option can be shared by any number of parses.
     template <typename T>
     class option_base : public describable {
     protected:
-        T value;
-
-        option_base(
-            std::initializer_list<std::string> aliases,
-            std::string_view description
+        constexpr option_base(
+            std::initializer_list<alias_name> aliases,
+            text description
         ) :
             describable(description),
             aliases(aliases) {}
     public:
-        using type = T;
+        using state = T;
+
+        const alias_list aliases;
 
-        const std::vector<std::string> aliases;
+        // The environment variable read when the command line does not set
+        // the option. Set by 'env'.
+        std::string_view variable;
 
-        auto get() const -> T { return value; }
+        // The environment variable the option is read from, if any: its own
+        // or, given the prefix of the application, one formed from its
+        // first long alias.
+        auto variable_name(std::string_view prefix) const -> std::string {
+            if (!variable.empty()) return std::string(variable);
+
+            const auto name = aliases.long_name();
+            if (prefix.empty() || name.empty()) return {};
+
+            return environment_variable(prefix, name);
+        }
 
         auto print_help(
             std::ostream& out,
-            std::optional<std::string_view>&& arg
+            std::optional<std::string_view>&& arg,
+            std::string_view prefix
         ) const -> void {
             constexpr auto spacing = 30;
 
@@ -76,76 +242,119 @@ namespace commline {
 
             print::spaces(out, space);
 
-            out << description << "\n";
+            out << description;
+
+            if (const auto name = variable_name(prefix); !name.empty()) {
+                out << " [env: " << name << "]";
+            }
+
+            out << "\n";
+        }
+
+        auto describe() const -> option_info {
+            auto info = option_info();
+            info.aliases = aliases;
+            info.description = description;
+            return info;
         }
     };
 
     struct no_argument : option_base<bool> {
-        no_argument(
-            std::initializer_list<std::string> aliases,
-            std::string_view description
-        );
+        constexpr no_argument(
+            std::initializer_list<alias_name> aliases,
+            text description
+        ) :
+            option_base(aliases, description) {}
 
-        auto print_help(std::ostream& out) const -> void {
-            option_base<bool>::print_help(out, {});
+        auto print_help(std::ostream& out, std::string_view prefix) const
+            -> void {
+            option_base<bool>::print_help(out, {}, prefix);
         }
-
-        auto set() -> void;
     };
 
     template <typename T>
     struct takes_argument : option_base<T> {
-        const std::string argument_name;
+        const text argument_name;
 
-        takes_argument(
-            std::initializer_list<std::string> aliases,
-            std::string_view description,
-            std::string_view argument_name
+        // Lists values for the argument when completing a command line.
+        std::optional<candidate_provider> provider;
+
+        constexpr takes_argument(
+            std::initializer_list<alias_name> aliases,
+            text description,
+            text argument_name
         ) :
             option_base<T>(aliases, description),
             argument_name(argument_name) {}
 
-        auto print_help(std::ostream& out) const -> void {
-            option_base<T>::print_help(out, argument_name);
+        auto print_help(std::ostream& out, std::string_view prefix) const
+            -> void {
+            option_base<T>::print_help(out, argument_name, prefix);
+        }
+
+        auto describe() const -> option_info {
+            auto info = option_base<T>::describe();
+            info.argument_name = argument_name;
+            info.dynamic = provider.has_value();
+            return info;
         }
     };
 
     struct single_argument : takes_argument<std::optional<std::string_view>> {
-        single_argument(
-            std::initializer_list<std::string> aliases,
-            std::string_view description,
-            std::string_view argument_name
-        );
-
-        auto set(std::string_view argument) -> void;
+        constexpr single_argument(
+            std::initializer_list<alias_name> aliases,
+            text description,
+            text argument_name
+        ) :
+            takes_argument(aliases, description, argument_name) {}
     };
 
-    struct multiple_arguments : takes_argument<std::vector<std::string_view>> {
-        std::string delimiter;
+    // How the value of a list option is split into items. Kept apart from
+    // the rest of the option so that parsing need not load its help text.
+    struct list_format {
+        text delimiter;
         bool discard_empty;
 
-        multiple_arguments(
-            std::initializer_list<std::string> aliases,
-            std::string_view description,
-            std::string_view argument_name,
-            std::string_view delimiter,
+        auto append(
+            std::pmr::vector<std::string_view>& items,
+            std::string_view argument
+        ) const -> void;
+    };
+
+    struct multiple_arguments :
+        takes_argument<std::pmr::vector<std::string_view>> {
+        list_format format;
+
+        constexpr multiple_arguments(
+            std::initializer_list<alias_name> aliases,
+            text description,
+            text argument_name,
+            text delimiter,
             bool discard_empty
-        );
+        ) :
+            takes_argument(aliases, description, argument_name),
+            format {delimiter, discard_empty} {}
 
-        auto set(std::string_view argument) -> void;
+        auto describe() const -> option_info;
     };
 
     struct flag {
-        using type = no_argument::type;
+        using type = bool;
 
         no_argument base;
 
-        flag(
-            std::initializer_list<std::string> aliases,
-            std::string_view description
-        );
+        constexpr flag(
+            std::initializer_list<alias_name> aliases,
+            text description
+        ) :
+            base(aliases, description) {}
 
-        auto get() const -> type;
+        auto get(const no_argument::state& value) const -> type;
+
+        auto try_get(const no_argument::state& value) const
+            -> expected<type> {
+            return get(value);
+        }
     };
 
     template <typename T>
@@ -155,26 +364,30 @@ namespace commline {
         single_argument base;
         const T default_value;
 
-        option(
-            std::initializer_list<std::string> aliases,
-            std::string_view description,
-            std::string_view argument_name
+        constexpr option(
+            std::initializer_list<alias_name> aliases,
+            text description,
+            text argument_name
         ) :
             base(aliases, description, argument_name),
             default_value(T()) {}
 
-        option(
-            std::initializer_list<std::string> aliases,
-            std::string_view description,
-            std::string_view argument_name,
+        constexpr option(
+            std::initializer_list<alias_name> aliases,
+            text description,
+            text argument_name,
             T&& default_value
         ) :
             base(aliases, description, argument_name),
             default_value(std::move(default_value)) {}
 
-        auto get() const -> T {
-            auto value = base.get();
-            if (value) return parser<T>::parse(*value);
+        auto get(const single_argument::state& value) const -> T {
+            return try_get(value).value();
+        }
+
+        auto try_get(const single_argument::state& value) const
+            -> expected<T> {
+            if (value) return convert<T>(*value);
             return default_value;
         }
     };
@@ -185,11 +398,11 @@ namespace commline {
 
         multiple_arguments base;
 
-        list(
-            std::initializer_list<std::string> aliases,
-            std::string_view description,
-            std::string_view argument_name,
-            std::string_view delimiter,
+        constexpr list(
+            std::initializer_list<alias_name> aliases,
+            text description,
+            text argument_name,
+            text delimiter,
             bool discard_empty = true
         ) :
             base(
@@ -200,10 +413,10 @@ namespace commline {
                 discard_empty
             ) {}
 
-        list(
-            std::initializer_list<std::string> aliases,
-            std::string_view description,
-            std::string_view argument_name
+        constexpr list(
+            std::initializer_list<alias_name> aliases,
+            text description,
+            text argument_name
         ) :
             list(
                 aliases,
@@ -213,15 +426,76 @@ namespace commline {
                 true
             ) {}
 
-        auto get() const -> type {
-            const auto value = base.get();
+        auto get(const multiple_arguments::state& value) const -> type {
+            return try_get(value).value();
+        }
+
+        auto try_get(const multiple_arguments::state& value) const
+            -> expected<type> {
             auto result = type();
+            result.reserve(value.size());
 
             for (const auto item : value) {
-                result.push_back(parser<T>::parse(item));
+                auto converted = convert<T>(item);
+                if (!converted) return std::move(converted).error();
+
+                result.push_back(*std::move(converted));
             }
 
             return result;
         }
     };
+
+    template <typename T>
+    struct list_view {
+        using type = value_view<T>;
+
+        multiple_arguments base;
+
+        constexpr list_view(
+            std::initializer_list<alias_name> aliases,
+            text description,
+            text argument_name,
+            text delimiter,
+            bool discard_empty = true
+        ) :
+            base(
+                aliases,
+                description,
+                argument_name,
+                delimiter,
+                discard_empty
+            ) {}
+
+        constexpr list_view(
+            std::initializer_list<alias_name> aliases,
+            text description,
+            text argument_name
+        ) :
+            list_view(
+                aliases,
+                description,
+                argument_name,
+                std::string_view(),
+                true
+            ) {}
+
+        auto get(const multiple_arguments::state& value) const -> type {
+            return type(value);
+        }
+
+        // Values are converted as they are read.
+        auto try_get(const multiple_arguments::state& value) const
+            -> expected<type> {
+            return get(value);
+        }
+    };
+
+    // Reads 'opt' from the environment variable 'name' when the command
+    // line does not set it, as in 'env("JOBS", option<int>({"jobs"}, ...))'.
+    template <typename Option>
+    constexpr auto env(std::string_view name, Option&& opt) -> Option {
+        opt.base.variable = name;
+        return std::move(opt);
+    }
 }
@@ -1,14 +1,23 @@
 #pragma once
 
+#include <commline/alias_table.h>
 #include <commline/argv.h>
-#include <commline/error.h>
+#include <commline/engine.h>
+#include <commline/expected.h>
 #include <commline/option.h>
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <ostream>
+#include <span>
 #include <string>
 #include <string_view>
 #include <tuple>
-#include <unordered_map>
 #include <variant>
+#include <vector>
 
 namespace commline {
     template <typename... Ts>
@@ -19,195 +28,444 @@ namespace commline {
     template <typename... Ts>
     overloaded(Ts...) -> overloaded<Ts...>;
 
-    template <typename... Options>
-    class option_list {
-        using tuple_type = std::tuple<Options...>;
-        using variant_type =
-            std::variant<no_argument*, single_argument*, multiple_arguments*>;
+    // The parameter type of an option, such as 'no_argument'.
+    template <typename Option>
+    using option_base_t =
+        std::remove_cvref_t<decltype(std::declval<Option>().base)>;
 
-        template <std::size_t N>
-        using type = typename std::tuple_element<N, tuple_type>::type::type;
-
-        static constexpr auto size_v = std::tuple_size_v<tuple_type>;
+    template <typename Option>
+    constexpr auto option_kind_of() -> option_kind {
+        using base = option_base_t<Option>;
 
-        [[noreturn]]
-        static auto missing_value(std::string_view alias) -> void {
-            throw cli_error("missing value for: " + std::string(alias));
+        if constexpr (std::is_same_v<base, no_argument>) {
+            return option_kind::no_argument;
         }
+        else if constexpr (std::is_same_v<base, single_argument>) {
+            return option_kind::single_argument;
+        }
+        else {
+            static_assert(std::is_same_v<base, multiple_arguments>);
+            return option_kind::multiple_arguments;
+        }
+    }
+
+    // The parameter of an option entry. Help, descriptions and completion
+    // work on these, so they are compiled once in the library rather than
+    // once per set of option types.
+    using option_entry = std::variant<
+        const no_argument*,
+        const single_argument*,
+        const multiple_arguments*>;
 
-        flag help_flag;
-        tuple_type opts;
-        std::unordered_map<std::string_view, variant_type> option_map;
+    // The aliases of 'entries', each with the index of its entry.
+    constexpr auto option_aliases(std::span<const option_entry> entries)
+        -> std::vector<alias_table_base::entry> {
+        auto aliases = std::vector<alias_table_base::entry>();
 
-        auto add(variant_type&& var) -> void {
+        for (std::size_t i = 0; i < entries.size(); ++i) {
             std::visit(
-                [&](auto* opt) {
+                [&](const auto* opt) {
+                    const auto index =
+                        static_cast<alias_table_base::index_type>(i);
+
                     for (const auto& alias : opt->aliases) {
-                        option_map[alias] = var;
+                        aliases.push_back({alias, index});
                     }
                 },
-                var
+                entries[i]
             );
         }
 
+        return aliases;
+    }
+
+    // Lists the options of 'entries' after the help flag, which comes first.
+    // Given the environment variable prefix of the application, each option
+    // shows the variable it is read from.
+    auto print_options(
+        std::ostream& out,
+        std::span<const option_entry> entries,
+        std::string_view prefix
+    ) -> void;
+
+    auto describe_options(
+        std::span<const option_entry> entries,
+        std::vector<option_info>& options
+    ) -> void;
+
+    // Completes an option name, or the value of a '--name=value' word.
+    auto complete_options(
+        const option_table& table,
+        std::span<const option_entry> entries,
+        completion& result
+    ) -> void;
+
+    // Completes the value of an option.
+    auto complete_option(const option_entry& entry, completion& result)
+        -> void;
+
+    // The declared options of a command along with the lookup tables built
+    // from them. A schema is immutable once constructed and may be shared by
+    // any number of concurrent parses.
+    template <typename... Options>
+    class option_schema {
+    public:
+        using tuple_type = std::tuple<Options...>;
+        using variant_type = option_entry;
+
+        static constexpr auto size_v = std::tuple_size_v<tuple_type>;
+
+        // Room for as many aliases per entry as an alias list keeps inline.
+        // Tables given more keep them on the heap.
+        using table_type = alias_table<(size_v + 1) * alias_list::capacity>;
+        using index_type = typename table_type::index_type;
+
+        // Room for a variable name for every entry.
+        using variable_table_type = alias_table<size_v + 1>;
+
+        static constexpr auto npos = table_type::npos;
+
+        static_assert(
+            size_v < npos,
+            "too many options for the alias table index type"
+        );
+
+        using slot = option_slot;
+
+        // The slot of each entry, in the order of 'entries'. The help flag
+        // is always the first option without an argument.
+        static constexpr auto slots = [] {
+            auto result = std::array<slot, size_v + 1>();
+            auto counts = std::array<index_type, 3>();
+
+            const auto kinds = std::array<option_kind, size_v + 1> {
+                option_kind::no_argument,
+                option_kind_of<Options>()...};
+
+            for (std::size_t i = 0; i < kinds.size(); ++i) {
+                const auto kind = kinds[i];
+                result[i] = {kind, counts[static_cast<std::size_t>(kind)]++};
+            }
+
+            return result;
+        }();
+
+        static constexpr auto flag_count = std::size_t(std::ranges::count(
+            slots,
+            option_kind::no_argument,
+            &slot::kind
+        ));
+
+        static constexpr auto value_count = std::size_t(std::ranges::count(
+            slots,
+            option_kind::single_argument,
+            &slot::kind
+        ));
+
+        static constexpr auto list_count = std::size_t(std::ranges::count(
+            slots,
+            option_kind::multiple_arguments,
+            &slot::kind
+        ));
+    private:
         template <std::size_t... I>
-        auto generate_map(std::index_sequence<I...>) -> void {
-            (add(&(std::get<I>(opts).base)), ...);
+        constexpr auto generate_formats(std::index_sequence<I...>) const
+            -> std::array<list_format, list_count> {
+            auto result = std::array<list_format, list_count>();
+
+            (
+                [&] {
+                    constexpr auto slot = slots[I + 1];
+
+                    if constexpr (slot.kind ==
+                                  option_kind::multiple_arguments) {
+                        result[slot.index] = std::get<I>(opts).base.format;
+                    }
+                }(),
+                ...
+            );
+
+            return result;
         }
 
         template <std::size_t... I>
-        auto get_values(std::index_sequence<I...>) const
-            -> std::tuple<typename Options::type...> {
-            return std::make_tuple(std::get<I>(opts).get()...);
+        constexpr auto generate_entries(std::index_sequence<I...>) const
+            -> std::array<variant_type, size_v + 1> {
+            return {&(help_flag.base), &(std::get<I>(opts).base)...};
         }
 
-        auto find(std::string_view alias) -> variant_type& {
-            try {
-                return option_map.at(alias);
-            }
-            catch (const std::out_of_range& ex) {
-                throw cli_error("unknown option: " + std::string(alias));
+        constexpr auto generate_table() const -> table_type {
+            return table_type(option_aliases(entries));
+        }
+
+        // The help flag is never read from the environment, so it has
+        // neither a variable nor a long name.
+        template <std::size_t... I>
+        constexpr auto generate_variable_names(std::index_sequence<I...>) const
+            -> std::array<std::string_view, size_v + 1> {
+            return {std::string_view(), std::get<I>(opts).base.variable...};
+        }
+
+        template <std::size_t... I>
+        constexpr auto generate_long_names(std::index_sequence<I...>) const
+            -> std::array<std::string_view, size_v + 1> {
+            return {
+                std::string_view(),
+                std::get<I>(opts).base.aliases.long_name()...};
+        }
+
+        constexpr auto generate_variables() const -> variable_table_type {
+            auto variables = std::vector<typename variable_table_type::entry>();
+
+            for (std::size_t i = 0; i < variable_names.size(); ++i) {
+                if (variable_names[i].empty()) continue;
+
+                variables.push_back(
+                    {variable_names[i], static_cast<index_type>(i)}
+                );
             }
+
+            return variable_table_type(variables);
+        }
+    public:
+        // Names, descriptions and argument names. Only help, completion and
+        // error messages read these.
+        const flag help_flag;
+        const tuple_type opts;
+
+        // The help flag followed by the declared options, in order.
+        const std::array<variant_type, size_v + 1> entries;
+
+        // What a parse reads: the alias table, the slots and the formats of
+        // list options.
+        const table_type table;
+        const std::array<list_format, list_count> formats;
+
+        // What reading the environment needs: the variable and the first
+        // long alias of each entry, and the variables by name.
+        const std::array<std::string_view, size_v + 1> variable_names;
+        const std::array<std::string_view, size_v + 1> long_names;
+        const variable_table_type variables;
+
+        constexpr option_schema(tuple_type&& opts) :
+            help_flag({"help", "?"}, "Print information about a command"),
+            opts(std::move(opts)),
+            entries(generate_entries(std::index_sequence_for<Options...>())),
+            table(generate_table()),
+            formats(generate_formats(std::index_sequence_for<Options...>())),
+            variable_names(
+                generate_variable_names(std::index_sequence_for<Options...>())
+            ),
+            long_names(
+                generate_long_names(std::index_sequence_for<Options...>())
+            ),
+            variables(generate_variables()) {}
+
+        // Entries point into the schema itself.
+        option_schema(const option_schema&) = delete;
+
+        auto operator=(const option_schema&) -> option_schema& = delete;
+
+        // Lists the options. Given the environment variable prefix of the
+        // application, each option shows the variable it is read from.
+        auto print_help(std::ostream& out, std::string_view prefix = {}) const
+            -> void {
+            print_options(out, entries, prefix);
         }
 
-        auto handle_long_parameter(
-            std::string_view token,
-            iterator& first,
-            iterator last
-        ) -> void {
-            const auto equals_sign = token.find("=");
-            const auto has_equals_sign = equals_sign != std::string_view::npos;
-            const auto alias =
-                has_equals_sign ? token.substr(0, equals_sign) : token;
+        // Describes the help flag followed by the declared options.
+        auto describe(std::vector<option_info>& options) const -> void {
+            describe_options(entries, options);
+        }
 
-            std::visit(
-                overloaded {
-                    [&](no_argument* opt) {
-                        if (has_equals_sign) {
-                            throw cli_error(
-                                "option '" + std::string(alias) +
-                                "' does not support values"
-                            );
-                        }
-
-                        opt->set();
-                    },
-                    [&](auto* opt) {
-                        if (has_equals_sign) {
-                            if (equals_sign == token.size() - 1)
-                                missing_value(alias);
-                            opt->set(token.substr(equals_sign + 1));
-                            return;
-                        }
-
-                        if (first == last) missing_value(alias);
-                        opt->set(*first++);
-                    }},
-                find(alias)
-            );
+        // What the parsing engine needs to know about these options.
+        constexpr auto parse_table() const noexcept -> option_table {
+            return {
+                table.lookup(),
+                slots,
+                formats,
+                variables.lookup(),
+                variable_names,
+                long_names};
+        }
+
+        // Finds what the word following 'args' is expected to be. No values
+        // are kept, and unknown options are skipped rather than reported
+        // since the command line is still being typed.
+        auto scan(argv args) const -> completion_point {
+            return scan_options(parse_table(), args);
+        }
+
+        // Completes an option name, or the value of a '--name=value' word.
+        auto complete(completion& result) const -> void {
+            complete_options(parse_table(), entries, result);
+        }
+
+        // Completes the value of the option entry at 'index'.
+        auto complete(std::size_t index, completion& result) const -> void {
+            complete_option(entries[index], result);
         }
 
-        auto handle_short_parameter(
-            std::string_view sequence,
-            iterator& first,
-            iterator last
-        ) -> void {
-            auto it = sequence.begin();
-            const auto end = sequence.end();
-
-            while (it != end) {
-                const auto alias = std::string_view(it++, 1);
-
-                std::visit(
-                    overloaded {
-                        [&](no_argument* opt) { opt->set(); },
-                        [&](auto* opt) {
-                            // The parameter requires a value.
-                            // The option value is the next arg after the
-                            // sequence of short options. If there are more
-                            // options in the sequence or there are no more
-                            // args after the sequence, the value is missing.
-                            if (it != end || first == last)
-                                missing_value(alias);
-                            opt->set(*first++);
-                        }},
-                    find(alias)
+        constexpr auto size() const -> std::size_t { return size_v; }
+    };
+
+    // The schema type for a tuple of options.
+    template <typename Tuple>
+    using option_schema_t = decltype(option_schema(std::declval<Tuple>()));
+
+    // The state of a single parse against an option schema. States are
+    // kept in one dense array per kind of option rather than next to the
+    // options, so a parse never loads an option's help text.
+    template <typename... Options>
+    class option_list {
+        using schema_type = option_schema<Options...>;
+        using tuple_type = typename schema_type::tuple_type;
+
+        template <std::size_t N>
+        using type = typename std::tuple_element<N, tuple_type>::type::type;
+
+        static constexpr auto size_v = schema_type::size_v;
+
+        std::unique_ptr<const schema_type> owned;
+        const schema_type* schema;
+
+        std::array<bool, schema_type::flag_count> flags;
+        std::array<bool, schema_type::flag_count> flag_set;
+        std::array<bool, schema_type::value_count> has_value;
+        std::array<std::string_view, schema_type::value_count> values;
+        std::array<multiple_arguments::state, schema_type::list_count> lists;
+
+        template <std::size_t N>
+        auto value() const -> expected<type<N>> {
+            constexpr auto slot = schema_type::slots[N + 1];
+            const auto& opt = std::get<N>(schema->opts);
+
+            if constexpr (slot.kind == option_kind::no_argument) {
+                return opt.try_get(flags[slot.index]);
+            }
+            else if constexpr (slot.kind == option_kind::single_argument) {
+                return opt.try_get(
+                    has_value[slot.index]
+                        ? single_argument::state(values[slot.index])
+                        : std::nullopt
                 );
             }
+            else return opt.try_get(lists[slot.index]);
         }
 
         template <std::size_t... I>
-        auto print(std::ostream& out, std::index_sequence<I...>) const -> void {
-            (std::get<I>(opts).base.print_help(out), ...);
+        auto get_values(std::index_sequence<I...>) const
+            -> expected<std::tuple<typename Options::type...>> {
+            return collect(value<I>()...);
         }
+
     public:
+        using values_type = std::tuple<typename Options::type...>;
+
+        option_list(const schema_type& schema) : schema(&schema) {
+            reset_options(state(), std::pmr::get_default_resource());
+        }
+
         option_list(tuple_type&& opts) :
-            help_flag({"help", "?"}, "Print information about a command"),
-            opts(std::move(opts)) {
-            add(&(help_flag.base));
-            generate_map(std::index_sequence_for<Options...>());
+            owned(std::make_unique<const schema_type>(std::move(opts))),
+            schema(owned.get()) {
+            reset_options(state(), std::pmr::get_default_resource());
         }
 
         template <std::size_t N>
         auto get() const -> type<N> {
-            return std::get<N>(opts).get();
+            return value<N>().value();
         }
 
-        auto help() -> bool { return help_flag.get(); }
+        auto help() const -> bool {
+            return schema->help_flag.get(flags.front());
+        }
 
         auto extract() const -> std::tuple<typename Options::type...> {
+            return try_extract().value();
+        }
+
+        // Like 'extract', but returns conversion errors instead of throwing
+        // them.
+        auto try_extract() const
+            -> expected<std::tuple<typename Options::type...>> {
             return get_values(std::index_sequence_for<Options...>());
         }
 
         auto parse(argv args) -> std::vector<std::string_view> {
-            constexpr auto long_opt = std::string_view("--");
-            constexpr auto short_opt = std::string_view("-");
-
-            auto positional = std::vector<std::string_view>();
-
-            auto first = args.begin();
-            const auto last = args.end();
-
-            while (first != last) {
-                const auto current = std::string_view(*(first++));
-
-                // A '--' by itself signifies the end of options.
-                // Everything that follows is an argument.
-                if (current == long_opt) {
-                    while (first != last) positional.emplace_back(*(first++));
-                }
-                // A '-' by itself is treated as an argument.
-                else if (current == short_opt) positional.push_back(current);
-                else if (current.starts_with(long_opt))
-                    handle_long_parameter(
-                        current.substr(long_opt.size()),
-                        first,
-                        last
-                    );
-                else if (current.starts_with(short_opt))
-                    handle_short_parameter(
-                        current.substr(short_opt.size()),
-                        first,
-                        last
-                    );
-                else positional.push_back(current);
-            }
+            auto positional = std::pmr::vector<std::string_view>();
+            const auto table = schema->parse_table();
 
+            parse_options(table, state(), args, positional).value();
+            return {positional.begin(), positional.end()};
+        }
+
+        // Parses without touching the heap: positional arguments and list
+        // values are allocated from 'resource', which must outlive this
+        // list. Running out of the memory of a 'storage' is reported as a
+        // 'cli_error'. Values from earlier parses are discarded.
+        auto parse(argv args, std::pmr::memory_resource& resource)
+            -> std::pmr::vector<std::string_view> {
+            return try_parse(args, resource).value();
+        }
+
+        // Like 'parse', but returns errors instead of throwing them.
+        auto try_parse(argv args, std::pmr::memory_resource& resource)
+            -> expected<std::pmr::vector<std::string_view>> {
+            reset_options(state(), &resource);
+
+            auto positional = std::pmr::vector<std::string_view>(&resource);
+            auto status =
+                parse_options(schema->parse_table(), state(), args, positional);
+
+            if (!status) return std::move(status).error();
             return positional;
         }
 
-        auto print_help(std::ostream& out) const -> void {
-            if constexpr (size_v > 0) {
-                print::header(out, "Options");
-                print(out, std::index_sequence_for<Options...>());
-            }
+        // Sets the options the command line left unset from the environment.
+        // Besides the variables the options name, those beginning with
+        // 'prefix' are read, if it is not empty.
+        auto read_environment(std::string_view prefix = {}) -> void {
+            commline::read_environment(schema->parse_table(), state(), prefix);
+        }
+
+        // Sets the options the command line and the environment left unset
+        // from a section of a configuration file.
+        auto read_config(const config_section& section) -> void {
+            try_read_config(section).value();
+        }
+
+        auto try_read_config(const config_section& section)
+            -> expected<void> {
+            return commline::read_config(
+                schema->parse_table(),
+                state(),
+                section
+            );
+        }
+
+        auto print_help(std::ostream& out, std::string_view prefix = {}) const
+            -> void {
+            schema->print_help(out, prefix);
+        }
+
+        // The parse state, for callers that drive the parsing engine with
+        // the schema's 'parse_table' themselves.
+        auto state() -> option_values {
+            return {flags, flag_set, has_value, values, lists};
         }
 
         constexpr auto size() const -> std::size_t { return size_v; }
     };
 
     template <typename... Options>
-    auto options(Options&&... opts) -> std::tuple<Options...> {
+    option_list(const option_schema<Options...>&) -> option_list<Options...>;
+
+    template <typename... Options>
+    option_list(std::tuple<Options...>&&) -> option_list<Options...>;
+
+    template <typename... Options>
+    constexpr auto options(Options&&... opts) -> std::tuple<Options...> {
         return std::make_tuple(std::move(opts)...);
     }
 }
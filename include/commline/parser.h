@@ -1,78 +1,195 @@
 #pragma once
 
-#include <commline/error.h>
+#include <commline/expected.h>
 
+#include <charconv>
 #include <concepts>
+#include <cstdint>
 #include <limits>
 #include <optional>
 #include <string>
 #include <string_view>
 
 namespace commline {
+    // Converts command line arguments to values of type 'T'. Parsers that
+    // can fail provide 'try_parse', which returns conversion errors instead
+    // of throwing them, with 'parse' as its throwing counterpart.
     template <typename T>
     struct parser {
         static auto parse(std::string_view argument) -> T { return argument; }
     };
 
+    // Converts 'argument' without throwing if 'parser<T>' has a 'try_parse'.
+    // Errors from other parsers are thrown as before.
+    template <typename T>
+    auto convert(std::string_view argument) -> expected<T> {
+        if constexpr (requires { parser<T>::try_parse(argument); }) {
+            return parser<T>::try_parse(argument);
+        }
+        else return parser<T>::parse(argument);
+    }
+
     template <>
     struct parser<std::string> {
         static auto parse(std::string_view argument) -> std::string;
+
+        static auto try_parse(std::string_view argument)
+            -> expected<std::string> {
+            return parse(argument);
+        }
+    };
+
+    struct integer_literal {
+        std::string_view digits;
+        int base;
+        bool negative;
+
+        // Separates the sign and base prefix from the digits, following the
+        // rules 'strtol' uses for a base of 0: a leading '0x' or '0X' means
+        // hexadecimal and any other leading '0' means octal, so '010' is 8
+        // and zero-padded decimals such as '08' are invalid.
+        static auto split(std::string_view argument) noexcept
+            -> integer_literal;
     };
 
     template <std::integral T>
     class parser<T> {
+        using magnitude_type = std::uintmax_t;
+
         static constexpr auto min = std::numeric_limits<T>::min();
         static constexpr auto max = std::numeric_limits<T>::max();
-        static constexpr auto base = 0;
 
-        [[noreturn]]
-        static auto out_of_range(std::string_view argument) {
-            throw cli_error(
+        static auto out_of_range(std::string_view argument) -> parse_error {
+            return parse_error(
                 "argument '{}' is outside the range of {} and {}",
                 argument,
                 min,
                 max
             );
         }
+
+        static auto invalid(std::string_view argument) -> parse_error {
+            return parse_error(
+                "could not convert argument '{}' to integer",
+                argument
+            );
+        }
     public:
         static auto parse(std::string_view argument) -> T {
-            const auto string = parser<std::string>::parse(argument);
+            return try_parse(argument).value();
+        }
 
-            try {
-                if constexpr (std::is_same_v<long long, T>) {
-                    return std::stoll(string);
-                }
-                else if constexpr (std::is_same_v<unsigned long long, T>) {
-                    return std::stoull(string);
-                }
-                else if constexpr (std::is_same_v<long, T>) {
-                    return std::stol(string);
-                }
-                else if constexpr (std::is_same_v<unsigned long, T>) {
-                    return std::stoul(string);
-                }
-                else if constexpr (std::is_signed_v<T>) {
-                    const auto value = std::stoi(string);
-                    if (value > max || value < min) out_of_range(argument);
-                    return static_cast<T>(value);
+        static auto try_parse(std::string_view argument) -> expected<T> {
+            const auto literal = integer_literal::split(argument);
+            const auto* const first = literal.digits.data();
+            const auto* const last = first + literal.digits.size();
+
+            auto magnitude = magnitude_type();
+            const auto [ptr, ec] =
+                std::from_chars(first, last, magnitude, literal.base);
+
+            if (ec == std::errc::result_out_of_range) {
+                return out_of_range(argument);
+            }
+
+            if (ec != std::errc() || ptr != last) return invalid(argument);
+
+            if (!literal.negative) {
+                if (magnitude > static_cast<magnitude_type>(max)) {
+                    return out_of_range(argument);
                 }
-                else {
-                    const auto value = std::stoul(string);
-                    if (value > max || value < min) out_of_range(argument);
-                    return static_cast<T>(value);
+
+                return static_cast<T>(magnitude);
+            }
+
+            if constexpr (std::is_signed_v<T>) {
+                // The magnitude of the minimum value is one more than the
+                // maximum value.
+                if (magnitude > static_cast<magnitude_type>(max) + 1) {
+                    return out_of_range(argument);
                 }
+
+                if (magnitude == 0) return 0;
+                return static_cast<T>(-static_cast<T>(magnitude - 1) - 1);
             }
-            catch (const std::invalid_argument& ex) {
-                throw cli_error(
-                    "could not convert argument '{}' to integer",
-                    argument
-                );
+            else {
+                if (magnitude != 0) return out_of_range(argument);
+                return 0;
             }
-            catch (const std::out_of_range& ex) {
-                out_of_range(argument);
+        }
+    };
+
+    struct floating_literal {
+        std::string_view digits;
+        std::chars_format format;
+        bool negative;
+
+        // Separates the sign and any '0x' or '0X' prefix from the digits.
+        // A prefix selects hexadecimal notation.
+        static auto split(std::string_view argument) noexcept
+            -> floating_literal;
+
+        // Whether the magnitude of the digits is below one. A conversion
+        // that is out of range for such a literal has underflowed.
+        auto tiny() const noexcept -> bool;
+    };
+
+    template <std::floating_point T>
+    class parser<T> {
+        static constexpr auto min = std::numeric_limits<T>::lowest();
+        static constexpr auto max = std::numeric_limits<T>::max();
+        static constexpr auto smallest = std::numeric_limits<T>::denorm_min();
+
+        static auto out_of_range(std::string_view argument) -> parse_error {
+            return parse_error(
+                "argument '{}' is outside the range of {} and {}",
+                argument,
+                min,
+                max
+            );
+        }
+
+        static auto underflow(std::string_view argument) -> parse_error {
+            return parse_error(
+                "argument '{}' is smaller in magnitude than {}",
+                argument,
+                smallest
+            );
+        }
+
+        static auto invalid(std::string_view argument) -> parse_error {
+            return parse_error(
+                "could not convert argument '{}' to a floating-point number",
+                argument
+            );
+        }
+    public:
+        static auto parse(std::string_view argument) -> T {
+            return try_parse(argument).value();
+        }
+
+        static auto try_parse(std::string_view argument) -> expected<T> {
+            const auto literal = floating_literal::split(argument);
+            const auto* const first = literal.digits.data();
+            const auto* const last = first + literal.digits.size();
+
+            // 'from_chars' accepts a minus sign of its own.
+            if (literal.digits.starts_with('-')) return invalid(argument);
+
+            auto value = T();
+            const auto [ptr, ec] =
+                std::from_chars(first, last, value, literal.format);
+
+            // 'from_chars' reports values too close to zero as out of range
+            // as well.
+            if (ec == std::errc::result_out_of_range) {
+                if (literal.tiny()) return underflow(argument);
+                return out_of_range(argument);
             }
 
-            __builtin_unreachable();
+            if (ec != std::errc() || ptr != last) return invalid(argument);
+
+            return literal.negative ? -value : value;
         }
     };
 
@@ -81,5 +198,13 @@ namespace commline {
         static auto parse(std::string_view argument) -> std::optional<T> {
             return parser<T>::parse(argument);
         }
+
+        static auto try_parse(std::string_view argument)
+            -> expected<std::optional<T>> {
+            auto value = convert<T>(argument);
+
+            if (!value) return std::move(value).error();
+            return std::optional<T>(*std::move(value));
+        }
     };
 }
@@ -9,4 +9,9 @@ namespace commline::print {
     auto indent(std::ostream& out) -> void;
 
     auto spaces(std::ostream& out, int amount) -> void;
+
+    // Writes 'text' to 'out'. Text bound for standard output, through the
+    // buffer 'std::cout' started with, is written with as few system calls
+    // as possible, bypassing the stream buffer.
+    auto write(std::ostream& out, std::string_view text) -> void;
 };
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <commline/argv.h>
+#include <commline/expected.h>
+
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace commline {
+    enum class response_format {
+        // '@file' arguments are passed through unchanged.
+        none,
+
+        // Each line of the file is an argument; blank lines are skipped.
+        // Lines are not terminated as arguments must be, so the file is
+        // copied into memory and split there.
+        lines,
+
+        // Arguments are separated by NUL characters, as with 'find -print0'.
+        // They are used in place in a read-only mapping of the file; only a
+        // last argument without a terminator is copied. Pipes, which cannot
+        // be mapped, are copied whole.
+        null
+    };
+
+    class mapped_file {
+        char* data = nullptr;
+        std::size_t size = 0;
+
+        mapped_file() = default;
+    public:
+        // Maps the file at 'path' for reading, or returns why it could not
+        // be mapped.
+        static auto map(const char* path) -> expected<mapped_file>;
+
+        // Like 'map', but throws the error.
+        mapped_file(const char* path);
+
+        mapped_file(const mapped_file&) = delete;
+
+        mapped_file(mapped_file&& other) noexcept;
+
+        ~mapped_file();
+
+        auto operator=(const mapped_file&) -> mapped_file& = delete;
+
+        auto operator=(mapped_file&& other) noexcept -> mapped_file&;
+
+        auto contents() const noexcept -> std::span<const char> {
+            return {data, size};
+        }
+    };
+
+    // Replaces each '@file' argument with the arguments read from that file.
+    // The expanded arguments point into the mappings and copies this object
+    // keeps, as the format dictates, and are valid for its lifetime.
+    // Expansion is not recursive and stops at a '--' argument.
+    class response_files {
+        std::vector<mapped_file> files;
+        std::vector<std::unique_ptr<char[]>> copies;
+        std::vector<const char*> expanded;
+        argv args;
+
+        auto read_lines(const char* path) -> expected<void>;
+
+        auto read_null(const char* path) -> expected<void>;
+
+        auto read_null_stream(const char* path) -> expected<void>;
+    public:
+        // Holds 'args' unexpanded until 'expand' is called.
+        explicit response_files(argv args);
+
+        // Expands 'args' at once, throwing any error.
+        response_files(argv args, response_format format);
+
+        // Expands the arguments given to the constructor and returns them,
+        // or the error for a file that could not be read.
+        auto expand(response_format format) -> expected<argv>;
+
+        response_files(const response_files&) = delete;
+
+        auto operator=(const response_files&) -> response_files& = delete;
+
+        auto get() const noexcept -> argv { return args; }
+    };
+}
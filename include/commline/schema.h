@@ -0,0 +1,64 @@
+#pragma once
+
+#include <commline/expected.h>
+
+#include <ostream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace commline {
+    // The hidden command that prints an application's schema, as in
+    // 'app __schema bash'.
+    constexpr auto schema_command = std::string_view("__schema");
+
+    struct option_info {
+        std::span<const std::string_view> aliases;
+        std::string_view description;
+
+        // Empty for options that take no argument.
+        std::string_view argument_name;
+
+        bool repeatable = false;
+
+        // Whether the argument's values are listed by a completer.
+        bool dynamic = false;
+    };
+
+    enum class argument_kind { required, optional, variadic };
+
+    struct argument_info {
+        std::string_view name;
+        argument_kind kind;
+
+        // Whether the argument's values are listed by a completer.
+        bool dynamic = false;
+    };
+
+    // A description of a command and its subcommands, which refers to the
+    // strings of the command tree it was taken from.
+    struct command_info {
+        std::string_view name;
+        std::string_view description;
+        std::vector<option_info> options;
+        std::vector<argument_info> arguments;
+        std::vector<command_info> commands;
+    };
+
+    enum class schema_format { json, bash, zsh, fish, man };
+
+    auto parse_schema_format(std::string_view format) -> schema_format;
+
+    auto try_parse_schema_format(std::string_view format)
+        -> expected<schema_format>;
+
+    // Writes the schema of the application described by 'root' as JSON, a
+    // shell completion script or a roff man page.
+    auto write_schema(
+        std::ostream& out,
+        schema_format format,
+        const command_info& root,
+        std::string_view version
+    ) -> void;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unistd.h>
+
+namespace commline {
+    using standard_streams = std::array<int, 3>;
+
+    // Handles one forwarded command line. Called with the same arguments
+    // 'main' would receive.
+    using request_handler = std::function<int(int argc, char** argv)>;
+
+    struct zygote_config {
+        // Children waiting for a request at any time.
+        std::size_t pool_size = 4;
+
+        // Requests to answer before returning, or zero to never return.
+        // Children that exit without answering one do not count.
+        std::size_t max_requests = 0;
+    };
+
+    // A Unix domain socket on which a resident process accepts command lines
+    // forwarded by 'forward'. Each request carries the client's arguments,
+    // working directory, environment and standard streams; the handler runs
+    // with all of them in place, so it cannot tell that it ran remotely.
+    class server {
+        std::string path;
+        int listener = -1;
+    public:
+        // Binds and listens on 'path', replacing any socket already there.
+        // Throws if 'path' exists and is not a socket. Only the owner may
+        // connect to the socket, and requests from processes of any other
+        // user are refused with EACCES.
+        server(std::string_view path);
+
+        server(const server&) = delete;
+
+        ~server();
+
+        auto operator=(const server&) -> server& = delete;
+
+        // Handles requests one at a time, in this process. The process's
+        // standard streams, working directory and environment are restored
+        // after every request. A request that cannot be read, or whose
+        // handler throws, is answered with a failing status, and the error
+        // is printed to standard error. Stops after 'max_requests' requests
+        // unless it is zero.
+        auto serve(const request_handler& handler, std::size_t max_requests = 0)
+            -> void;
+
+        // Handles each request in a child process forked from this one, so
+        // that whatever the handler does to its process is discarded with
+        // it. Children are forked ahead of time and each handles one
+        // request; a replacement is forked whenever one exits. Errors are
+        // reported as 'serve' reports them. Once several children in a row
+        // have failed to accept a connection, no more are forked, and this
+        // throws when the last child has exited.
+        auto fork(const request_handler& handler, const zygote_config& config)
+            -> void;
+
+        auto socket() const noexcept -> int { return listener; }
+    };
+
+    // Sends a command line to the server listening on 'path', along with the
+    // working directory, the environment and the given standard streams, and
+    // returns the handler's exit status.
+    auto forward(
+        std::string_view path,
+        int argc,
+        char** argv,
+        standard_streams streams = {STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO}
+    ) -> int;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory_resource>
+#include <span>
+
+namespace commline {
+    // Hands out memory from a fixed buffer in order, as
+    // 'std::pmr::monotonic_buffer_resource' does, but records running out
+    // rather than throwing 'std::bad_alloc', so that parsing can report it
+    // with exceptions disabled. Allocations that do not fit are served from
+    // the heap, so that the containers using them stay valid until the
+    // error is reported.
+    class fixed_buffer_resource : public std::pmr::memory_resource {
+        std::span<std::byte> buffer;
+        std::size_t used = 0;
+        bool overflowed = false;
+        std::pmr::monotonic_buffer_resource overflow;
+
+        auto do_allocate(std::size_t bytes, std::size_t alignment)
+            -> void* override;
+
+        auto do_deallocate(void*, std::size_t, std::size_t) -> void override {}
+
+        auto do_is_equal(const std::pmr::memory_resource& other) const noexcept
+            -> bool override {
+            return this == &other;
+        }
+    public:
+        explicit fixed_buffer_resource(std::span<std::byte> buffer) :
+            buffer(buffer),
+            overflow(std::pmr::new_delete_resource()) {}
+
+        fixed_buffer_resource(const fixed_buffer_resource&) = delete;
+
+        auto operator=(const fixed_buffer_resource&)
+            -> fixed_buffer_resource& = delete;
+
+        // Whether an allocation has not fit in the buffer since the last
+        // call to 'release'.
+        auto exhausted() const noexcept -> bool { return overflowed; }
+
+        // Makes the whole buffer available again.
+        auto release() -> void;
+    };
+
+    // Fixed-capacity memory for 'option_list::parse'. Once the buffer is used
+    // up, parsing fails with an error.
+    template <std::size_t Size>
+    class storage {
+        alignas(std::max_align_t) std::array<std::byte, Size> buffer;
+        fixed_buffer_resource resource;
+    public:
+        storage() : resource({buffer.data(), buffer.size()}) {}
+
+        storage(const storage&) = delete;
+
+        auto operator=(const storage&) -> storage& = delete;
+
+        operator std::pmr::memory_resource&() { return resource; }
+
+        auto release() -> void { resource.release(); }
+    };
+}
@@ -0,0 +1,277 @@
+#pragma once
+
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <span>
+#include <sys/types.h>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace commline {
+    // A coroutine that produces no value. Command handlers may return a task
+    // instead of void, in which case it is run to completion on an event
+    // loop before the command returns. A task does not start until it is
+    // awaited or run.
+    class task {
+    public:
+        struct promise_type {
+            std::coroutine_handle<> continuation;
+            std::size_t* remaining = nullptr;
+            std::exception_ptr exception;
+
+            struct final_awaiter {
+                auto await_ready() const noexcept -> bool { return false; }
+
+                auto await_suspend(std::coroutine_handle<promise_type> h)
+                    const noexcept -> std::coroutine_handle<> {
+                    auto& promise = h.promise();
+
+                    // Tasks awaited together resume their awaiter once the
+                    // last of them finishes.
+                    if (promise.remaining && --*promise.remaining > 0) {
+                        return std::noop_coroutine();
+                    }
+
+                    if (promise.continuation) return promise.continuation;
+                    return std::noop_coroutine();
+                }
+
+                auto await_resume() const noexcept -> void {}
+            };
+
+            auto get_return_object() -> task {
+                return task(
+                    std::coroutine_handle<promise_type>::from_promise(*this)
+                );
+            }
+
+            auto initial_suspend() const noexcept -> std::suspend_always {
+                return {};
+            }
+
+            auto final_suspend() const noexcept -> final_awaiter { return {}; }
+
+            auto return_void() const noexcept -> void {}
+
+            auto unhandled_exception() noexcept -> void {
+                exception = std::current_exception();
+            }
+        };
+
+        using handle_type = std::coroutine_handle<promise_type>;
+    private:
+        handle_type handle;
+
+        explicit task(handle_type handle) : handle(handle) {}
+    public:
+        task(const task&) = delete;
+
+        task(task&& other) noexcept : handle(std::exchange(other.handle, {})) {}
+
+        ~task() {
+            if (handle) handle.destroy();
+        }
+
+        auto operator=(const task&) -> task& = delete;
+
+        auto operator=(task&& other) noexcept -> task& {
+            if (this != &other) {
+                if (handle) handle.destroy();
+                handle = std::exchange(other.handle, {});
+            }
+
+            return *this;
+        }
+
+        auto operator co_await() && noexcept {
+            struct awaiter {
+                handle_type handle;
+
+                auto await_ready() const noexcept -> bool {
+                    return handle.done();
+                }
+
+                auto await_suspend(std::coroutine_handle<> awaiting)
+                    const noexcept -> std::coroutine_handle<> {
+                    handle.promise().continuation = awaiting;
+                    return handle;
+                }
+
+                auto await_resume() const -> void {
+                    if (handle.promise().exception) {
+                        std::rethrow_exception(handle.promise().exception);
+                    }
+                }
+            };
+
+            return awaiter {handle};
+        }
+
+        auto done() const noexcept -> bool { return !handle || handle.done(); }
+
+        auto get() const noexcept -> handle_type { return handle; }
+
+        // Throws the exception that ended the task, if any.
+        auto result() const -> void {
+            if (handle && handle.promise().exception) {
+                std::rethrow_exception(handle.promise().exception);
+            }
+        }
+    };
+
+    // Waits for readiness on file descriptors and resumes the coroutines
+    // waiting on them. A loop serves one thread; 'run' makes it the loop
+    // that the awaitables below register with.
+    class event_loop {
+        struct waiter {
+            std::uint32_t events;
+            std::coroutine_handle<> coroutine;
+        };
+
+        int epoll;
+        std::size_t waiting = 0;
+
+        // The coroutines waiting on each registered descriptor. A descriptor
+        // is registered once for all of its waiters.
+        std::unordered_map<int, std::vector<waiter>> waiters;
+
+        auto arm(int fd, int op, const std::vector<waiter>& list) -> bool;
+
+        // Forgets every waiter, such as those of a task that failed while
+        // others were still waiting, so that the loop can run again.
+        auto clear() -> void;
+
+        auto dispatch(int fd, std::uint32_t events) -> void;
+    public:
+        event_loop();
+
+        event_loop(const event_loop&) = delete;
+
+        ~event_loop();
+
+        auto operator=(const event_loop&) -> event_loop& = delete;
+
+        // The loop running on the calling thread.
+        static auto current() -> event_loop&;
+
+        // Runs 'task' and everything it awaits until it completes, then
+        // throws the exception that ended it, if any.
+        auto run(task& task) -> void;
+
+        // Resumes 'coroutine' once 'fd' reports any of 'events'. Returns
+        // false if 'fd' cannot be waited on, such as a regular file, which
+        // is always ready.
+        auto wait(
+            int fd,
+            std::uint32_t events,
+            std::coroutine_handle<> coroutine
+        ) -> bool;
+    };
+
+    // Runs 'task' on the calling thread's event loop, which is created the
+    // first time it is needed and kept for later tasks. A task run while
+    // another is running gets a loop of its own.
+    auto run(task task) -> void;
+
+    // Awaits readiness of a file descriptor.
+    struct fd_awaiter {
+        int fd;
+        std::uint32_t events;
+
+        auto await_ready() const noexcept -> bool { return false; }
+
+        auto await_suspend(std::coroutine_handle<> coroutine) const -> bool {
+            return event_loop::current().wait(fd, events, coroutine);
+        }
+
+        auto await_resume() const noexcept -> void {}
+    };
+
+    auto readable(int fd) -> fd_awaiter;
+
+    auto writable(int fd) -> fd_awaiter;
+
+    // Reads once from 'fd' after waiting for it to become readable. Returns
+    // the number of bytes read, which is zero at end of file.
+    class read_awaiter {
+        fd_awaiter ready;
+        std::span<std::byte> buffer;
+    public:
+        read_awaiter(int fd, std::span<std::byte> buffer);
+
+        auto await_ready() const noexcept -> bool { return false; }
+
+        auto await_suspend(std::coroutine_handle<> coroutine) const -> bool {
+            return ready.await_suspend(coroutine);
+        }
+
+        auto await_resume() const -> std::size_t;
+    };
+
+    auto read(int fd, std::span<std::byte> buffer) -> read_awaiter;
+
+    // Suspends the awaiting coroutine for a duration, using a timerfd.
+    class sleep_awaiter {
+        int timer;
+    public:
+        sleep_awaiter(std::chrono::nanoseconds duration);
+
+        sleep_awaiter(const sleep_awaiter&) = delete;
+
+        ~sleep_awaiter();
+
+        auto operator=(const sleep_awaiter&) -> sleep_awaiter& = delete;
+
+        auto await_ready() const noexcept -> bool { return false; }
+
+        auto await_suspend(std::coroutine_handle<> coroutine) const -> bool;
+
+        auto await_resume() const noexcept -> void {}
+    };
+
+    auto sleep_for(std::chrono::nanoseconds duration) -> sleep_awaiter;
+
+    // Waits for a child process to exit, using a pidfd, and reaps it.
+    // Returns its exit status, or 128 plus the signal that killed it.
+    class process_awaiter {
+        int pidfd;
+    public:
+        process_awaiter(pid_t pid);
+
+        process_awaiter(const process_awaiter&) = delete;
+
+        ~process_awaiter();
+
+        auto operator=(const process_awaiter&) -> process_awaiter& = delete;
+
+        auto await_ready() const noexcept -> bool { return false; }
+
+        auto await_suspend(std::coroutine_handle<> coroutine) const -> bool;
+
+        auto await_resume() const -> int;
+    };
+
+    auto wait_process(pid_t pid) -> process_awaiter;
+
+    // Runs tasks concurrently and resumes the awaiting coroutine once all of
+    // them have finished. Throws the first exception that ended one, in the
+    // order given.
+    class all_awaiter {
+        std::vector<task> tasks;
+        std::size_t remaining = 0;
+    public:
+        all_awaiter(std::vector<task>&& tasks);
+
+        auto await_ready() const noexcept -> bool { return tasks.empty(); }
+
+        auto await_suspend(std::coroutine_handle<> coroutine) -> bool;
+
+        auto await_resume() const -> void;
+    };
+
+    auto when_all(std::vector<task>&& tasks) -> all_awaiter;
+}
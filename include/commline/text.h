@@ -0,0 +1,70 @@
+#pragma once
+
+#include <algorithm>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace commline {
+    // A description, argument name, version or other text of a command
+    // tree. Text given as a 'std::string', such as a formatted description,
+    // is copied, so that it lives as long as the tree. Any other text is
+    // only viewed and must outlive the tree, as string literals do. Copies
+    // cannot be made during constant evaluation, so a 'constinit' tree can
+    // hold only viewed text.
+    class text {
+        std::string_view view;
+        char* storage = nullptr;
+
+        constexpr auto own(std::string_view source) -> void {
+            storage = new char[source.size()];
+            std::ranges::copy(source, storage);
+            view = std::string_view(storage, source.size());
+        }
+    public:
+        constexpr text() = default;
+
+        constexpr text(const char* view) : view(view) {}
+
+        constexpr text(std::string_view view) : view(view) {}
+
+        constexpr text(const std::string& source) { own(source); }
+
+        constexpr text(const text& other) : view(other.view) {
+            if (other.storage) own(other.view);
+        }
+
+        constexpr text(text&& other) noexcept :
+            view(other.view),
+            storage(std::exchange(other.storage, nullptr)) {}
+
+        constexpr ~text() { delete[] storage; }
+
+        constexpr auto operator=(text other) noexcept -> text& {
+            std::swap(view, other.view);
+            std::swap(storage, other.storage);
+            return *this;
+        }
+
+        constexpr operator std::string_view() const noexcept { return view; }
+
+        constexpr auto data() const noexcept -> const char* {
+            return view.data();
+        }
+
+        constexpr auto size() const noexcept -> std::size_t {
+            return view.size();
+        }
+
+        constexpr auto empty() const noexcept -> bool { return view.empty(); }
+
+        // Whether the text is a copy kept by this object.
+        constexpr auto owned() const noexcept -> bool { return storage; }
+    };
+
+    inline auto operator<<(std::ostream& out, const text& text)
+        -> std::ostream& {
+        return out << std::string_view(text);
+    }
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <commline/parser.h>
+
+#include <cstddef>
+#include <iterator>
+#include <ranges>
+#include <span>
+#include <string_view>
+
+namespace commline {
+    // A range over raw arguments that converts each element with
+    // 'parser<T>' when it is dereferenced. Nothing is materialized up front.
+    // The view refers to the parsed command line and is valid for as long as
+    // the handler runs.
+    template <typename T>
+    class value_view : public std::ranges::view_interface<value_view<T>> {
+        using base_iterator = std::span<const std::string_view>::iterator;
+
+        std::span<const std::string_view> arguments;
+    public:
+        class iterator {
+            base_iterator it;
+        public:
+            using iterator_concept = std::forward_iterator_tag;
+            using iterator_category = std::input_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+
+            iterator() = default;
+
+            iterator(base_iterator it) : it(it) {}
+
+            auto operator*() const -> T { return parser<T>::parse(*it); }
+
+            // Like dereferencing, but returns conversion errors instead of
+            // throwing them.
+            auto try_get() const -> expected<T> { return convert<T>(*it); }
+
+            auto operator++() -> iterator& {
+                ++it;
+                return *this;
+            }
+
+            auto operator++(int) -> iterator {
+                auto result = *this;
+                ++it;
+                return result;
+            }
+
+            auto operator==(const iterator& other) const -> bool = default;
+
+            // The unconverted argument.
+            auto raw() const -> std::string_view { return *it; }
+        };
+
+        value_view() = default;
+
+        value_view(std::span<const std::string_view> arguments) :
+            arguments(arguments) {}
+
+        auto begin() const -> iterator { return arguments.begin(); }
+
+        auto end() const -> iterator { return arguments.end(); }
+
+        auto size() const -> std::size_t { return arguments.size(); }
+
+        auto empty() const -> bool { return arguments.empty(); }
+
+        auto raw() const -> std::span<const std::string_view> {
+            return arguments;
+        }
+    };
+}
@@ -26,4 +26,15 @@ if(PROJECT_TESTING)
     FetchContent_MakeAvailable(GTest)
 endif()
 
+if(PROJECT_BENCHMARKS)
+    set(BENCHMARK_ENABLE_TESTING OFF)
+
+    FetchContent_Declare(benchmark
+        GIT_REPOSITORY https://github.com/google/benchmark.git
+        GIT_TAG        v1.8.3
+    )
+
+    FetchContent_MakeAvailable(benchmark)
+endif()
+
 cmake_policy(POP)
@@ -0,0 +1,169 @@
+# Measures how long an application with N generated commands takes to
+# compile and how much code it produces.
+#
+#   cmake -DCXX=<compiler> -DINCLUDE_DIRECTORIES=<dir>|... -DCOMMANDS=<n>|...
+#       -DOUTPUT_DIRECTORY=<dir> [-DSIZE=<size program>] -P compile.cmake
+#
+# Each command has its own handler and one of several option and argument
+# shapes, as the commands of a real application do. Results are printed and
+# written to 'compile.json' in OUTPUT_DIRECTORY.
+
+cmake_minimum_required(VERSION 3.26)
+
+string(REPLACE "|" ";" INCLUDE_DIRECTORIES "${INCLUDE_DIRECTORIES}")
+string(REPLACE "|" ";" COMMANDS "${COMMANDS}")
+
+if(NOT SIZE)
+    set(SIZE size)
+endif()
+
+set(option_kinds
+    "flag({\"flag-@I@-@J@\"}, \"A flag.\")"
+    "option<int>({\"number-@I@-@J@\"}, \"A number.\", \"n\")"
+    "option<std::string_view>({\"text-@I@-@J@\"}, \"Text.\", \"text\")"
+    "list<std::string_view>({\"item-@I@-@J@\"}, \"Items.\", \"item\")"
+)
+
+set(argument_shapes
+    ""
+    "required<std::string_view>(\"source\")"
+    "required<std::string_view>(\"source\"), optional<int>(\"count\")"
+    "variadic<std::string_view>(\"files\"), required<std::string_view>(\"to\")"
+)
+
+# Writes a program with 'count' commands to 'path'.
+function(generate path count)
+    set(source [=[
+#include <commline/application.h>
+
+using namespace commline;
+
+auto main(int argc, char** argv) -> int {
+    auto root = application(
+        "generated",
+        "0.0.0",
+        "An application with generated commands.",
+        options(),
+        arguments(),
+        [](const app&) {}
+    );
+]=])
+
+    math(EXPR last "${count} - 1")
+
+    foreach(i RANGE ${last})
+        # Rotating through the kinds gives each length several orders.
+        math(EXPR option_count "${i} % 6 + 1")
+        math(EXPR offset "${i} / 6 % 4")
+        math(EXPR shape "${i} % 4")
+
+        set(opts "")
+        math(EXPR last_option "${option_count} - 1")
+
+        foreach(j RANGE ${last_option})
+            math(EXPR kind "(${j} + ${offset}) % 4")
+            list(GET option_kinds ${kind} opt)
+
+            string(REPLACE "@I@" "${i}" opt "${opt}")
+            string(REPLACE "@J@" "${j}" opt "${opt}")
+
+            if(opts)
+                string(APPEND opts ",\n            ")
+            endif()
+            string(APPEND opts "${opt}")
+        endforeach()
+
+        list(GET argument_shapes ${shape} args)
+
+        string(APPEND source "
+    root.subcommand(command(
+        \"command-${i}\",
+        \"A generated command.\",
+        options(
+            ${opts}
+        ),
+        arguments(${args}),
+        [](const app&, auto&&...) {}
+    ));
+")
+    endforeach()
+
+    string(APPEND source "
+    return root.run(argc, argv);
+}
+")
+
+    file(WRITE "${path}" "${source}")
+endfunction()
+
+set(flags -std=c++20 -O2 -DNDEBUG)
+foreach(directory ${INCLUDE_DIRECTORIES})
+    list(APPEND flags "-I${directory}")
+endforeach()
+
+file(MAKE_DIRECTORY "${OUTPUT_DIRECTORY}")
+
+set(results "")
+
+message("commands   seconds   text bytes")
+
+foreach(count ${COMMANDS})
+    set(source "${OUTPUT_DIRECTORY}/commands-${count}.cpp")
+    set(object "${OUTPUT_DIRECTORY}/commands-${count}.o")
+
+    generate("${source}" ${count})
+
+    string(TIMESTAMP start "%s%f" UTC)
+
+    execute_process(
+        COMMAND "${CXX}" ${flags} -c "${source}" -o "${object}"
+        RESULT_VARIABLE result
+    )
+
+    string(TIMESTAMP end "%s%f" UTC)
+
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "failed to compile ${source}")
+    endif()
+
+    math(EXPR microseconds "${end} - ${start}")
+    math(EXPR whole "${microseconds} / 1000000")
+    math(EXPR fraction "${microseconds} % 1000000 / 10000")
+    string(LENGTH "${fraction}" length)
+    if(length EQUAL 1)
+        set(fraction "0${fraction}")
+    endif()
+    set(seconds "${whole}.${fraction}")
+
+    # Adds up every text section, including those of inline functions.
+    execute_process(
+        COMMAND "${SIZE}" -A "${object}"
+        OUTPUT_VARIABLE sections
+        RESULT_VARIABLE result
+    )
+
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "failed to read the size of ${object}")
+    endif()
+
+    set(text 0)
+    string(REPLACE "\n" ";" sections "${sections}")
+
+    foreach(line ${sections})
+        if(line MATCHES "^\\.text[^ ]*[ ]+([0-9]+)")
+            math(EXPR text "${text} + ${CMAKE_MATCH_1}")
+        endif()
+    endforeach()
+
+    message("${count}  ${seconds}  ${text}")
+
+    if(results)
+        string(APPEND results ",\n")
+    endif()
+    string(APPEND results
+        "    {\"commands\": ${count}, \"seconds\": ${seconds}, "
+        "\"text_bytes\": ${text}}"
+    )
+endforeach()
+
+file(WRITE "${OUTPUT_DIRECTORY}/compile.json" "[\n${results}\n]\n")
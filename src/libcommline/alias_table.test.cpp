@@ -0,0 +1,108 @@
+#include "test.h"
+
+#include <commline/alias_table.h>
+
+#include <string>
+#include <vector>
+
+using commline::alias_table;
+
+using entry = alias_table<0>::entry;
+
+constexpr auto npos = alias_table<0>::npos;
+
+TEST(AliasTableTest, Empty) {
+    const auto table = alias_table<0>();
+
+    ASSERT_EQ(npos, table.find("help"sv));
+    ASSERT_EQ(npos, table.find('h'));
+}
+
+TEST(AliasTableTest, Lookup) {
+    const auto entries = std::vector<entry> {
+        {"help", 0},
+        {"?", 0},
+        {"verbose", 1},
+        {"v", 1},
+        {"output", 2}};
+    const auto table = alias_table<5>(entries);
+
+    ASSERT_EQ(0, table.find("help"sv));
+    ASSERT_EQ(0, table.find("?"sv));
+    ASSERT_EQ(1, table.find("verbose"sv));
+    ASSERT_EQ(1, table.find("v"sv));
+    ASSERT_EQ(2, table.find("output"sv));
+
+    ASSERT_EQ(0, table.find('?'));
+    ASSERT_EQ(1, table.find('v'));
+
+    ASSERT_EQ(npos, table.find("verb"sv));
+    ASSERT_EQ(npos, table.find(""sv));
+    ASSERT_EQ(npos, table.find('o'));
+}
+
+TEST(AliasTableTest, LastEntryWins) {
+    const auto entries =
+        std::vector<entry> {{"help", 0}, {"h", 0}, {"h", 1}};
+    const auto table = alias_table<3>(entries);
+
+    ASSERT_EQ(0, table.find("help"sv));
+    ASSERT_EQ(1, table.find("h"sv));
+    ASSERT_EQ(1, table.find('h'));
+}
+
+TEST(AliasTableTest, ManyAliases) {
+    constexpr auto count = 1000;
+
+    auto names = std::vector<std::string>();
+    auto entries = std::vector<entry>();
+
+    names.reserve(count);
+
+    for (auto i = 0; i < count; ++i) {
+        names.push_back("option-" + std::to_string(i));
+    }
+
+    for (auto i = 0; i < count; ++i) {
+        entries.push_back({names[i], static_cast<alias_table<0>::index_type>(i)});
+    }
+
+    const auto table = alias_table<count>(entries);
+
+    for (auto i = 0; i < count; ++i) {
+        ASSERT_EQ(i, table.find(std::string_view(names[i])));
+    }
+
+    ASSERT_EQ(npos, table.find("option-"sv));
+    ASSERT_EQ(npos, table.find("option-1000"sv));
+}
+
+TEST(AliasTableTest, ConstantEvaluation) {
+    constexpr auto entries =
+        std::array<entry, 3> {{{"help", 0}, {"verbose", 1}, {"v", 1}}};
+    constexpr auto table = alias_table<3>(entries);
+
+    static_assert(table.find("help"sv) == 0);
+    static_assert(table.find("verbose"sv) == 1);
+    static_assert(table.find('v') == 1);
+    static_assert(table.find("output"sv) == npos);
+}
+
+TEST(AliasTableTest, BeyondCapacity) {
+    const auto entries = std::vector<entry> {
+        {"help", 0},
+        {"?", 0},
+        {"verbose", 1},
+        {"v", 1},
+        {"output", 2}};
+    const auto table = alias_table<2>(entries);
+    const auto copy = table;
+
+    for (const auto& [alias, index] : entries) {
+        ASSERT_EQ(index, table.find(alias));
+        ASSERT_EQ(index, copy.find(alias));
+    }
+
+    ASSERT_EQ(npos, copy.find("out"sv));
+    ASSERT_EQ(1, copy.find('v'));
+}
@@ -0,0 +1,151 @@
+#include "test.h"
+
+#include <commline/application.h>
+#include <commline/option_list.h>
+#include <commline/storage.h>
+
+using commline::flag;
+using commline::list;
+using commline::option;
+
+namespace {
+    auto allocations_at_handler = std::size_t(0);
+
+    constinit auto tool = commline::application(
+        "tool",
+        "1.0.0",
+        "A tool for tests.",
+        commline::options(),
+        commline::arguments(),
+        [](const commline::app& app) {},
+        commline::commands(commline::subcommand(
+            "copy",
+            "Copy files.",
+            commline::options(
+                flag({"recursive", "r"}, "Copy directories."),
+                option<std::string_view>({"mode", "m"}, "File mode.", "mode")
+            ),
+            commline::arguments(
+                commline::required<std::string_view>("source"),
+                commline::required<std::string_view>("destination")
+            ),
+            [](const commline::app& app,
+               bool recursive,
+               std::string_view mode,
+               std::string_view source,
+               std::string_view destination) {
+                allocations_at_handler = allocation_count();
+
+                ASSERT_TRUE(recursive);
+                ASSERT_EQ("644", mode);
+                ASSERT_EQ("a", source);
+                ASSERT_EQ("b", destination);
+            }
+        ))
+    );
+}
+
+class AllocationTest : public testing::Test {
+protected:
+    commline::storage<1024> storage;
+
+    template <typename... Options>
+    auto options(Options&&... opts) -> commline::option_list<Options...> {
+        return commline::option_list<Options...>(
+            commline::options(std::forward<Options>(opts)...)
+        );
+    }
+};
+
+TEST_F(AllocationTest, ParseWithStorage) {
+    constexpr auto args = std::array {
+        "-vf",
+        "config.toml",
+        "--include",
+        "foo",
+        "first",
+        "--include=bar",
+        "--name=commline",
+        "second",
+        "--",
+        "--third"};
+
+    auto list = options(
+        flag({"verbose", "v"}, ""),
+        option<std::string_view>({"file", "f"}, "", ""),
+        option<std::string_view>({"name"}, "", ""),
+        commline::list<std::string_view>({"include"}, "", "")
+    );
+
+    const auto before = allocation_count();
+    const auto positional = list.parse(args, storage);
+    const auto after = allocation_count();
+
+    ASSERT_EQ(before, after);
+
+    ASSERT_TRUE(list.get<0>());
+    ASSERT_EQ("config.toml", list.get<1>());
+    ASSERT_EQ("commline", list.get<2>());
+
+    const auto includes = list.get<3>();
+    ASSERT_EQ(2, includes.size());
+    ASSERT_EQ("foo", includes[0]);
+    ASSERT_EQ("bar", includes[1]);
+
+    ASSERT_EQ(3, positional.size());
+    ASSERT_EQ("first", positional[0]);
+    ASSERT_EQ("second", positional[1]);
+    ASSERT_EQ("--third", positional[2]);
+}
+
+TEST_F(AllocationTest, StorageExhausted) {
+    auto small = commline::storage<sizeof(std::string_view)>();
+    auto list = options(flag({"verbose", "v"}, ""));
+
+    constexpr auto args = std::array {"one", "two", "three"};
+
+#if __cpp_exceptions
+    try {
+        list.parse(args, small);
+        FAIL() << "Storage should have been exhausted";
+    }
+    catch (const commline::cli_error& ex) {
+        ASSERT_EQ("argument storage exhausted"s, ex.what());
+    }
+
+    small.release();
+#endif
+
+    const auto result = list.try_parse(args, small);
+
+    ASSERT_FALSE(result);
+    ASSERT_EQ("argument storage exhausted", result.error().message);
+
+    // Released storage can be parsed into again.
+    small.release();
+    ASSERT_TRUE(list.try_parse(std::array {"one"}, small));
+}
+
+TEST_F(AllocationTest, AlignedAllocationsCounted) {
+    auto* const resource = std::pmr::new_delete_resource();
+
+    const auto before = allocation_count();
+    auto* const ptr = resource->allocate(64, 32);
+    const auto after = allocation_count();
+
+    resource->deallocate(ptr, 64, 32);
+
+    ASSERT_EQ(before + 1, after);
+    ASSERT_EQ(0, reinterpret_cast<std::uintptr_t>(ptr) % 32);
+}
+
+TEST_F(AllocationTest, ConstantCommandTree) {
+    const char* argv[] = {"tool", "copy", "-r", "--mode=644", "a", "b"};
+    auto out = std::ostringstream();
+
+    // The tree itself was built during constant evaluation.
+    const auto before = allocation_count();
+    ASSERT_EQ(0, tool.run(std::size(argv), const_cast<char**>(argv), out));
+
+    ASSERT_EQ(before, allocations_at_handler);
+}
@@ -1,13 +1,156 @@
 #include <commline/application.h>
-#include <fmt/core.h>
+#include <commline/batch.h>
+#include <commline/completion_cache.h>
+#include <commline/schema.h>
+
+#include <cstdlib>
+#include <string>
+#include <system_error>
+#include <vector>
 
 namespace commline {
-    auto print_error(std::exception_ptr eptr) -> void {
+    auto application_base::dispatch(argv argv, std::ostream& out)
+        -> expected<int> {
+        auto& tree = root();
+
+        // Arguments read from response files point into the mapped files,
+        // which must outlive the command.
+        auto expansion = response_files(argv);
+        const auto expanded = expansion.expand(response_file_format);
+        if (!expanded) return expanded.error();
+
+        const auto args = *expanded;
+
+        auto first = args.begin();
+        const auto last = args.end();
+
+        const auto argv0 = *(first++);
+
+        if (first != last && *first == complete_command) {
+            const auto request =
+                completion_request::try_parse(commline::argv(++first, last));
+            if (!request) return request.error();
+
+            auto cache = completion_cache(tree.name);
+            auto result = completion(tree.name, request->word, &cache);
+            tree.complete(
+                request->preceding.begin(),
+                request->preceding.end(),
+                result
+            );
+            result.write(out);
+            return EXIT_SUCCESS;
+        }
+
+        if (first != last && *first == schema_command) {
+            if (++first == last) return parse_error("missing schema format");
+
+            const auto format = try_parse_schema_format(*first);
+            if (!format) return format.error();
+
+            write_schema(out, *format, tree.describe(), version);
+            return EXIT_SUCCESS;
+        }
+
+        const auto path = first;
+        auto* const cmd = tree.find(first, last);
+
+        // A file that cannot be read is reported by the command once it has
+        // handled '--help', so that help is still available.
+        const auto section = config ?
+            config->section(commline::argv(path, first)) :
+            expected<config_section>(config_section());
+
+        return cmd->execute(
+            {tree.name,
+             version,
+             tree.description,
+             argv0,
+             section ? *section : config_section(),
+             section ? nullptr : &section.error()},
+            commline::argv(first, last),
+            out
+        );
+    }
+
+    auto application_base::report(expected<int>&& status) -> int {
+        if (status) return *status;
+
+        const auto& error = status.error();
+
+        // The default handler needs no exception to print the message, and
+        // could not read it back out of one without exceptions.
+        if (error_handler == &print_error) error.print();
+        else error_handler(error.exception());
+
+        if (error.code) return error.code.value();
+        return EXIT_FAILURE;
+    }
+
+    template <typename F>
+    auto application_base::handle_errors(F&& f) -> int {
+#if __cpp_exceptions
         try {
-            if (eptr) std::rethrow_exception(eptr);
+            return report(f());
+        }
+        catch (const std::system_error& ex) {
+            error_handler(std::current_exception());
+            return ex.code().value();
         }
-        catch (const std::exception& ex) {
-            fmt::print(stderr, "{}\n", ex.what());
+        catch (...) {
+            error_handler(std::current_exception());
+            return EXIT_FAILURE;
         }
+#else
+        return report(f());
+#endif
+    }
+
+    auto application_base::use_config(std::string_view path) -> void {
+        config = config_ptr(new config_file(root().name, path));
+    }
+
+    auto application_base::run(int argc, char** argv, std::ostream& out)
+        -> int {
+        return handle_errors([&] {
+            return dispatch(commline::argv(argv, argc), out);
+        });
+    }
+
+    auto application_base::run_batch(std::istream& in, std::ostream& out)
+        -> int {
+        return run_batch(in, out, {});
+    }
+
+    auto application_base::run_batch(
+        std::istream& in,
+        std::ostream& out,
+        const batch_config& config
+    ) -> int {
+        const auto argv0 = std::string(root().name);
+
+        return commline::run_batch(
+            in,
+            out,
+            config,
+            [&](std::string_view line, std::ostream& out) {
+                // Reused between command lines run by the same thread.
+                thread_local auto words = std::vector<std::string>();
+                thread_local auto args = std::vector<const char*>();
+
+                return handle_errors([&] {
+                    const auto split = split_words(line, words);
+                    if (!split) return expected<int>(split.error());
+
+                    args.clear();
+                    args.push_back(argv0.c_str());
+                    for (const auto& word : words) {
+                        args.push_back(word.c_str());
+                    }
+
+                    return dispatch(args, out);
+                });
+            }
+        );
     }
 }
@@ -7,9 +7,67 @@
 using commline::application;
 using commline::arguments;
 using commline::command;
+using commline::commands;
 using commline::flag;
 using commline::option;
 using commline::options;
+using commline::required;
+using commline::subcommand;
+
+namespace {
+    auto last_run = std::string_view();
+
+    constinit auto git = application(
+        "git",
+        "0.0.0",
+        "A version control system.",
+        options(),
+        arguments(),
+        [](const commline::app& app) { last_run = "git"; },
+        commands(
+            subcommand(
+                "remote",
+                "Manage remotes.",
+                options(flag({"verbose", "v"}, "Show remote URLs.")),
+                arguments(),
+                [](const commline::app& app, bool verbose) {
+                    last_run = verbose ? "remote -v" : "remote";
+                },
+                commands(
+                    subcommand(
+                        "show",
+                        "Show a remote.",
+                        options(),
+                        arguments(required<std::string_view>("name")),
+                        [](const commline::app& app, std::string_view name) {
+                            last_run = name;
+                        }
+                    ),
+                    subcommand(
+                        "add",
+                        "Add a remote.",
+                        options(),
+                        arguments(),
+                        [](const commline::app& app) { last_run = "add"; }
+                    )
+                )
+            ),
+            subcommand(
+                "fetch",
+                "Download objects.",
+                options(),
+                arguments(),
+                [](const commline::app& app) { last_run = "fetch"; }
+            )
+        )
+    );
+
+    template <typename... Args>
+    auto run_git(Args... args) -> int {
+        const char* argv[] = {"git", args...};
+        return git.run(sizeof...(Args) + 1, const_cast<char**>(argv));
+    }
+}
 
 class ApplicationTest : public testing::Test {
 protected:
@@ -74,3 +132,67 @@ TEST_F(ApplicationTest, MulipleCommands) {
 
     ASSERT_EQ(0, app.run(argc, const_cast<char**>(argv)));
 }
+
+TEST_F(ApplicationTest, ConstantTree) {
+    ASSERT_EQ(0, run_git());
+    ASSERT_EQ("git", last_run);
+
+    ASSERT_EQ(0, run_git("fetch"));
+    ASSERT_EQ("fetch", last_run);
+
+    ASSERT_EQ(0, run_git("remote", "-v"));
+    ASSERT_EQ("remote -v", last_run);
+
+    ASSERT_EQ(0, run_git("remote", "show", "origin"));
+    ASSERT_EQ("origin", last_run);
+
+    ASSERT_EQ(0, run_git("remote", "add"));
+    ASSERT_EQ("add", last_run);
+}
+
+TEST_F(ApplicationTest, ConstantTreeHelp) {
+    // Subcommands are listed in order of name, not declaration.
+    ASSERT_TRUE(git.help().ends_with(R"(Commands:
+    fetch          Download objects.
+    remote         Manage remotes.
+)"));
+}
+
+TEST_F(ApplicationTest, ConstantTreeAddCommand) {
+    auto app = application(
+        name,
+        version,
+        description,
+        options(),
+        arguments(),
+        [](const commline::app& app) { FAIL() << "Command should not run."; },
+        commands(subcommand(
+            "stop",
+            "Stop the server.",
+            options(),
+            arguments(),
+            [](const commline::app& app) { last_run = "stop"; }
+        ))
+    );
+
+    app.subcommand(command(
+        "start",
+        "Start the server.",
+        options(),
+        arguments(),
+        [](const commline::app& app) { last_run = "start"; }
+    ));
+
+    const char* start[] = {"./app", "start"};
+    ASSERT_EQ(0, app.run(2, const_cast<char**>(start)));
+    ASSERT_EQ("start", last_run);
+
+    const char* stop[] = {"./app", "stop"};
+    ASSERT_EQ(0, app.run(2, const_cast<char**>(stop)));
+    ASSERT_EQ("stop", last_run);
+
+    ASSERT_TRUE(app.help().ends_with(R"(Commands:
+    start          Start the server.
+    stop           Stop the server.
+)"));
+}
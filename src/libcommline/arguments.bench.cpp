@@ -0,0 +1,93 @@
+#include "bench.h"
+
+#include <commline/arguments.h>
+
+#include <string>
+#include <vector>
+
+using commline::optional;
+using commline::required;
+using commline::variadic;
+
+namespace {
+    // Parses 'range(0)' words against 'arguments'. Arguments that follow
+    // the variadic one are filled from the end.
+    template <typename... Arguments>
+    auto parse(benchmark::State& state, std::tuple<Arguments...>&& arguments)
+        -> void {
+        const auto schema = commline::argument_schema(std::move(arguments));
+
+        const auto count = static_cast<std::size_t>(state.range(0));
+        const auto words = std::vector<std::string_view>(count, "argument");
+
+        for (auto _ : state) {
+            auto args = commline::positional_arguments(schema);
+            auto values = args.parse(words);
+
+            benchmark::DoNotOptimize(values);
+        }
+
+        state.SetItemsProcessed(state.iterations() * count);
+    }
+
+    auto variadic_first(benchmark::State& state) -> void {
+        parse(
+            state,
+            commline::arguments(
+                variadic<std::string_view>("files"),
+                required<std::string_view>("a"),
+                required<std::string_view>("b"),
+                optional<std::string_view>("c")
+            )
+        );
+    }
+
+    auto variadic_middle(benchmark::State& state) -> void {
+        parse(
+            state,
+            commline::arguments(
+                required<std::string_view>("a"),
+                variadic<std::string_view>("files"),
+                required<std::string_view>("b"),
+                optional<std::string_view>("c")
+            )
+        );
+    }
+
+    auto variadic_last(benchmark::State& state) -> void {
+        parse(
+            state,
+            commline::arguments(
+                required<std::string_view>("a"),
+                required<std::string_view>("b"),
+                optional<std::string_view>("c"),
+                variadic<std::string_view>("files")
+            )
+        );
+    }
+
+    // Converting every value of a variadic argument, as a handler that
+    // takes a 'std::vector<int>' does.
+    auto variadic_int(benchmark::State& state) -> void {
+        const auto schema = commline::argument_schema(
+            commline::arguments(variadic<int>("numbers"))
+        );
+
+        const auto count = static_cast<std::size_t>(state.range(0));
+        const auto words = std::vector<std::string_view>(count, "12345");
+
+        for (auto _ : state) {
+            auto args = commline::positional_arguments(schema);
+            auto values = args.parse(words);
+
+            benchmark::DoNotOptimize(values);
+        }
+
+        state.SetItemsProcessed(state.iterations() * count);
+    }
+}
+
+BENCHMARK(variadic_first)->RangeMultiplier(100)->Range(3, 300'000);
+BENCHMARK(variadic_middle)->RangeMultiplier(100)->Range(3, 300'000);
+BENCHMARK(variadic_last)->RangeMultiplier(100)->Range(3, 300'000);
+BENCHMARK(variadic_int)->RangeMultiplier(100)->Range(1, 100'000);
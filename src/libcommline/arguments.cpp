@@ -1,25 +1,19 @@
 #include <commline/arguments.h>
 
-#include <algorithm>
 #include <ctype.h>
 
-namespace {
-    auto uppercase(std::string_view text) -> std::string {
-        auto copy = std::string(text);
-        std::transform(copy.begin(), copy.end(), copy.begin(), toupper);
-        return copy;
-    }
-}
-
 namespace commline {
-    named_argument::named_argument(std::string_view name) : name(name) {}
-
     auto named_argument::print_help(std::ostream& out) const -> void {
-        out << uppercase(name);
+        // Help text is rendered once per command, so the uppercase label is
+        // not worth storing.
+        for (const auto c : std::string_view(name)) {
+            out.put(static_cast<char>(toupper(static_cast<unsigned char>(c))));
+        }
     }
 
-    optional_argument::optional_argument(std::string_view name) :
-        named_argument(name) {}
+    auto optional_argument::describe() const -> argument_info {
+        return {name, argument_kind::optional, provider.has_value()};
+    }
 
     auto optional_argument::print_help(std::ostream& out) const -> void {
         out << "[";
@@ -27,14 +21,64 @@ namespace commline {
         out << "]";
     }
 
-    required_argument::required_argument(std::string_view name) :
-        named_argument(name) {}
+    auto required_argument::describe() const -> argument_info {
+        return {name, argument_kind::required, provider.has_value()};
+    }
 
-    argument_list::argument_list(std::string_view name) :
-        named_argument(name) {}
+    auto argument_list::describe() const -> argument_info {
+        return {name, argument_kind::variadic, provider.has_value()};
+    }
 
     auto argument_list::print_help(std::ostream& out) const -> void {
         named_argument::print_help(out);
         out << "...";
     }
+
+    auto print_arguments(
+        std::ostream& out,
+        std::span<const argument_entry> entries
+    ) -> void {
+        for (const auto& entry : entries) {
+            out << " ";
+
+            std::visit([&out](auto* arg) { arg->print_help(out); }, entry);
+        }
+    }
+
+    auto describe_arguments(
+        std::span<const argument_entry> entries,
+        std::vector<argument_info>& arguments
+    ) -> void {
+        arguments.reserve(entries.size());
+
+        for (const auto& entry : entries) {
+            std::visit(
+                [&arguments](auto* arg) {
+                    arguments.push_back(arg->describe());
+                },
+                entry
+            );
+        }
+    }
+
+    auto complete_argument(
+        std::span<const argument_entry> entries,
+        std::size_t position,
+        completion& result
+    ) -> void {
+        for (const auto& entry : entries) {
+            if (position == 0 ||
+                std::holds_alternative<const argument_list*>(entry)) {
+                std::visit(
+                    [&result](auto* arg) {
+                        result.provide(arg->provider, arg->name);
+                    },
+                    entry
+                );
+                return;
+            }
+
+            --position;
+        }
+    }
 }
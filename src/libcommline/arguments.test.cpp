@@ -8,6 +8,7 @@ using commline::cli_error;
 using commline::optional;
 using commline::required;
 using commline::variadic;
+using commline::variadic_view;
 
 class ArgumentTest : public testing::Test {
 protected:
@@ -31,6 +32,7 @@ TEST_F(ArgumentTest, RequiredArgument) {
 TEST_F(ArgumentTest, RequiredArgumentMissing) {
     auto parser = arguments(required<std::string_view>("hello"));
 
+#if __cpp_exceptions
     try {
         parser.parse({});
         FAIL() << "Parsing should have failed";
@@ -38,6 +40,15 @@ TEST_F(ArgumentTest, RequiredArgumentMissing) {
     catch (const cli_error& ex) {
         ASSERT_EQ("not enough arguments: missing value for: hello"s, ex.what());
     }
+#endif
+
+    const auto result = parser.try_parse({});
+
+    ASSERT_FALSE(result);
+    ASSERT_EQ(
+        "not enough arguments: missing value for: hello",
+        result.error().message
+    );
 }
 
 TEST_F(ArgumentTest, OptionalArgument) {
@@ -127,3 +138,40 @@ TEST_F(ArgumentTest, VariadicTrailing) {
     ASSERT_EQ(10, numbers[1]);
     ASSERT_EQ(15, numbers[2]);
 }
+
+TEST_F(ArgumentTest, VariadicView) {
+    constexpr auto args = std::array {"foo"sv, "5"sv, "10"sv, "x"sv, "bar"sv};
+
+    auto parser = arguments(
+        required<std::string_view>("head"),
+        variadic_view<int>("numbers"),
+        required<std::string_view>("tail")
+    );
+    const auto [head, numbers, tail] = parser.parse(args);
+
+    ASSERT_EQ("foo", head);
+    ASSERT_EQ("bar", tail);
+    ASSERT_EQ(3, numbers.size());
+
+    auto it = numbers.begin();
+    ASSERT_EQ(5, *it++);
+    ASSERT_EQ(10, *it);
+    ASSERT_EQ("x", (++it).raw());
+#if __cpp_exceptions
+    ASSERT_THROW(*it, cli_error);
+#endif
+    ASSERT_EQ(
+        "could not convert argument 'x' to integer",
+        it.try_get().error().message
+    );
+    ASSERT_EQ(5, numbers.begin().try_get().value());
+    ASSERT_EQ(numbers.end(), ++it);
+}
+
+TEST_F(ArgumentTest, VariadicViewEmpty) {
+    auto parser = arguments(variadic_view<int>("numbers"));
+    const auto [numbers] = parser.parse({});
+
+    ASSERT_TRUE(numbers.empty());
+    ASSERT_EQ(numbers.begin(), numbers.end());
+}
@@ -0,0 +1,297 @@
+#include <commline/batch.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <condition_variable>
+#include <cstdlib>
+#include <fmt/ostream.h>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <thread>
+
+namespace {
+    using commline::batch_config;
+    using commline::batch_invoke;
+
+    auto is_blank(char c) -> bool {
+        return std::isspace(static_cast<unsigned char>(c));
+    }
+
+    auto is_blank_line(std::string_view line) -> bool {
+        return std::all_of(line.begin(), line.end(), is_blank);
+    }
+
+    // Records the exit status of each command line in the order they are
+    // emitted.
+    class batch_totals {
+        const batch_config& config;
+        int result = EXIT_SUCCESS;
+        int total = 0;
+        int failed = 0;
+    public:
+        batch_totals(const batch_config& config) : config(config) {}
+
+        // Returns whether to continue with the next command line.
+        auto add(int status) -> bool {
+            ++total;
+
+            if (config.statuses) config.statuses->push_back(status);
+
+            if (config.report) {
+                fmt::print(*config.report, "{} {}\n", total, status);
+            }
+
+            if (status == EXIT_SUCCESS) return true;
+
+            ++failed;
+            if (result == EXIT_SUCCESS) result = status;
+            return !config.stop_on_error;
+        }
+
+        auto finish() const -> int {
+            if (config.report) {
+                fmt::print(
+                    *config.report,
+                    "{} command lines: {} succeeded, {} failed\n",
+                    total,
+                    total - failed,
+                    failed
+                );
+            }
+
+            return result;
+        }
+    };
+
+    // Each worker takes jobs from the front of its own range. A worker whose
+    // range is empty steals the back half of another's.
+    class work_queues {
+        struct queue {
+            std::mutex mutex;
+            std::size_t begin = 0;
+            std::size_t end = 0;
+        };
+
+        std::vector<queue> queues;
+    public:
+        work_queues(std::size_t workers, std::size_t jobs) : queues(workers) {
+            const auto share = jobs / workers;
+            const auto extra = jobs % workers;
+            auto begin = std::size_t(0);
+
+            for (std::size_t i = 0; i < workers; ++i) {
+                queues[i].begin = begin;
+                begin += share + (i < extra ? 1 : 0);
+                queues[i].end = begin;
+            }
+        }
+
+        auto next(std::size_t worker) -> std::optional<std::size_t> {
+            auto& own = queues[worker];
+
+            {
+                const auto lock = std::scoped_lock(own.mutex);
+                if (own.begin != own.end) return own.begin++;
+            }
+
+            for (std::size_t i = 1; i < queues.size(); ++i) {
+                auto& victim = queues[(worker + i) % queues.size()];
+                const auto lock = std::scoped_lock(own.mutex, victim.mutex);
+
+                const auto available = victim.end - victim.begin;
+                if (available == 0) continue;
+
+                // The first stolen job is returned; the rest become ours.
+                const auto stolen = (available + 1) / 2;
+                const auto first = victim.end - stolen;
+
+                victim.end = first;
+                own.begin = first + 1;
+                own.end = first + stolen;
+
+                return first;
+            }
+
+            return {};
+        }
+    };
+
+    auto run_parallel(
+        const std::vector<std::string>& lines,
+        std::ostream& out,
+        const batch_config& config,
+        std::size_t threads,
+        const batch_invoke& invoke,
+        batch_totals& totals
+    ) -> void {
+        enum class progress { pending, done, skipped };
+
+        struct job {
+            std::string output;
+            int status = EXIT_SUCCESS;
+            progress state = progress::pending;
+        };
+
+        auto jobs = std::vector<job>(lines.size());
+        auto finished = std::vector<std::size_t>();
+        auto queues = work_queues(threads, lines.size());
+        auto stop = std::atomic_bool(false);
+        auto mutex = std::mutex();
+        auto condition = std::condition_variable();
+
+        finished.reserve(lines.size());
+
+        const auto work = [&](std::size_t worker) {
+            while (const auto index = queues.next(worker)) {
+                auto& job = jobs[*index];
+                auto result = progress::skipped;
+
+                if (!stop) {
+                    auto buffer = std::ostringstream();
+
+#if __cpp_exceptions
+                    try {
+                        job.status = invoke(lines[*index], buffer);
+                    }
+                    catch (...) {
+                        job.status = EXIT_FAILURE;
+                    }
+#else
+                    job.status = invoke(lines[*index], buffer);
+#endif
+
+                    job.output = std::move(buffer).str();
+                    result = progress::done;
+
+                    if (job.status != EXIT_SUCCESS && config.stop_on_error) {
+                        stop = true;
+                    }
+                }
+
+                {
+                    const auto lock = std::scoped_lock(mutex);
+                    job.state = result;
+                    finished.push_back(*index);
+                }
+
+                condition.notify_one();
+            }
+        };
+
+        auto workers = std::vector<std::jthread>();
+        workers.reserve(threads);
+        for (std::size_t i = 0; i < threads; ++i) workers.emplace_back(work, i);
+
+        // Output is emitted by this thread while the workers continue.
+        auto proceed = true;
+
+        const auto emit = [&](job& job) {
+            if (job.state == progress::skipped || !proceed) return;
+
+            out << job.output;
+            job.output = {};
+
+            proceed = totals.add(job.status);
+        };
+
+        for (std::size_t i = 0; i < jobs.size(); ++i) {
+            auto lock = std::unique_lock(mutex);
+            auto* job = &jobs[i];
+
+            if (config.completion_order) {
+                condition.wait(lock, [&] { return finished.size() > i; });
+                job = &jobs[finished[i]];
+            }
+            else {
+                condition.wait(lock, [job] {
+                    return job->state != progress::pending;
+                });
+            }
+
+            lock.unlock();
+            emit(*job);
+        }
+    }
+}
+
+namespace commline {
+    auto split_words(std::string_view line, std::vector<std::string>& words)
+        -> expected<void> {
+        words.clear();
+
+        auto it = line.begin();
+        const auto end = line.end();
+
+        while (true) {
+            while (it != end && is_blank(*it)) ++it;
+            if (it == end) return {};
+
+            auto& word = words.emplace_back();
+
+            while (it != end && !is_blank(*it)) {
+                const auto c = *it++;
+
+                if (c == '\'') {
+                    const auto close = std::find(it, end, '\'');
+                    if (close == end) return parse_error("unterminated quote");
+
+                    word.append(it, close);
+                    it = close + 1;
+                }
+                else if (c == '"') {
+                    while (true) {
+                        if (it == end) return parse_error("unterminated quote");
+
+                        const auto d = *it++;
+                        if (d == '"') break;
+
+                        if (d == '\\' && it != end &&
+                            (*it == '"' || *it == '\\')) {
+                            word.push_back(*it++);
+                        }
+                        else word.push_back(d);
+                    }
+                }
+                else if (c == '\\') {
+                    if (it == end) return parse_error("trailing backslash");
+                    word.push_back(*it++);
+                }
+                else word.push_back(c);
+            }
+        }
+    }
+
+    auto run_batch(
+        std::istream& in,
+        std::ostream& out,
+        const batch_config& config,
+        const batch_invoke& invoke
+    ) -> int {
+        auto totals = batch_totals(config);
+        auto line = std::string();
+
+        const auto threads = config.threads == 0
+            ? std::max<std::size_t>(1, std::thread::hardware_concurrency())
+            : config.threads;
+
+        if (threads > 1) {
+            auto lines = std::vector<std::string>();
+
+            while (std::getline(in, line, config.delimiter)) {
+                if (!is_blank_line(line)) lines.push_back(std::move(line));
+            }
+
+            run_parallel(lines, out, config, threads, invoke, totals);
+        }
+        else {
+            while (std::getline(in, line, config.delimiter)) {
+                if (is_blank_line(line)) continue;
+                if (!totals.add(invoke(line, out))) break;
+            }
+        }
+
+        return totals.finish();
+    }
+}
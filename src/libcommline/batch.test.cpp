@@ -0,0 +1,214 @@
+#include "test.h"
+
+#include <commline/application.h>
+#include <commline/batch.h>
+
+#include <fmt/format.h>
+#include <mutex>
+
+using commline::application;
+using commline::arguments;
+using commline::batch_config;
+using commline::command;
+using commline::flag;
+using commline::option;
+using commline::options;
+using commline::required;
+
+class BatchTest : public testing::Test {
+protected:
+    static inline auto sums = std::vector<int>();
+    static inline auto sums_mutex = std::mutex();
+
+    std::ostringstream out;
+    std::ostringstream report;
+
+    static auto app() {
+        return application(
+            "calc",
+            "0.0.0",
+            "Batch test.",
+            options(),
+            arguments(),
+            [](const commline::app& app) {}
+        );
+    }
+
+    template <typename App>
+    static auto setup(App& app) -> void {
+        sums.clear();
+
+        app.subcommand(command(
+            "add",
+            "Add two numbers.",
+            options(flag({"quiet", "q"}, "")),
+            arguments(required<int>("a"), required<int>("b")),
+            [](const commline::app& app, bool quiet, int a, int b) {
+                const auto lock = std::scoped_lock(sums_mutex);
+                sums.push_back(a + b);
+            }
+        ));
+
+        app.on_error([](std::exception_ptr) {});
+    }
+
+    // Command lines that succeed, fail and write to the output stream.
+    static auto mixed(int count) -> std::string {
+        auto result = std::string();
+
+        for (auto i = 0; i < count; ++i) {
+            switch (i % 4) {
+                case 0: result += fmt::format("add {} {}\n", i, i); break;
+                case 1: result += "add --help\n"; break;
+                case 2: result += "--help\n"; break;
+                case 3: result += fmt::format("add x {}\n", i); break;
+            }
+        }
+
+        return result;
+    }
+
+    static auto words(std::string_view line) -> std::vector<std::string> {
+        auto result = std::vector<std::string>();
+        commline::split_words(line, result).value();
+        return result;
+    }
+
+    static auto split_error(std::string_view line) -> std::string {
+        auto result = std::vector<std::string>();
+        const auto status = commline::split_words(line, result);
+
+        if (status) return {};
+        return status.error().message;
+    }
+};
+
+TEST_F(BatchTest, SplitWords) {
+    using words_t = std::vector<std::string>;
+
+    ASSERT_EQ(words_t(), words("  \t "));
+    ASSERT_EQ((words_t {"a", "b", "c"}), words(" a  b\tc "));
+    ASSERT_EQ((words_t {"a b", "c'd", ""}), words(R"('a b' "c'd" '')"));
+    ASSERT_EQ((words_t {R"(a"b\c)", "x y"}), words(R"("a\"b\c" x\ y)"));
+    ASSERT_EQ((words_t {"abc"}), words(R"(a'b'"c")"));
+
+    ASSERT_EQ("unterminated quote", split_error("'abc"));
+    ASSERT_EQ("unterminated quote", split_error("\"abc"));
+    ASSERT_EQ("trailing backslash", split_error("abc\\"));
+}
+
+TEST_F(BatchTest, Lines) {
+    auto calc = app();
+    setup(calc);
+
+    auto in = std::istringstream("add 1 2\n\nadd -q 3 4\nadd 5 x\nadd 6 7\n");
+
+    const auto status = calc.run_batch(in, out, {.report = &report});
+
+    ASSERT_EQ(EXIT_FAILURE, status);
+    ASSERT_EQ((std::vector<int> {3, 7, 13}), sums);
+    ASSERT_EQ(
+        "1 0\n2 0\n3 1\n4 0\n4 command lines: 3 succeeded, 1 failed\n",
+        report.str()
+    );
+}
+
+TEST_F(BatchTest, StopOnError) {
+    auto calc = app();
+    setup(calc);
+
+    auto in = std::istringstream("add 1 2\nadd 'x\nadd 6 7\n");
+
+    const auto status =
+        calc.run_batch(in, out, {.stop_on_error = true, .report = &report});
+
+    ASSERT_EQ(EXIT_FAILURE, status);
+    ASSERT_EQ((std::vector<int> {3}), sums);
+    ASSERT_EQ(
+        "1 0\n2 1\n2 command lines: 1 succeeded, 1 failed\n",
+        report.str()
+    );
+}
+
+TEST_F(BatchTest, NullDelimited) {
+    auto calc = app();
+    setup(calc);
+
+    auto in = std::istringstream("add\n1\n2\0add 3 4\0"s);
+
+    ASSERT_EQ(EXIT_SUCCESS, calc.run_batch(in, out, {.delimiter = '\0'}));
+    ASSERT_EQ((std::vector<int> {3, 7}), sums);
+}
+
+TEST_F(BatchTest, Parallel) {
+    auto calc = app();
+    setup(calc);
+
+    const auto input = mixed(200);
+
+    auto serial_in = std::istringstream(input);
+    auto serial_out = std::ostringstream();
+    auto serial_report = std::ostringstream();
+    auto serial_statuses = std::vector<int>();
+
+    const auto serial_status = calc.run_batch(
+        serial_in,
+        serial_out,
+        {.report = &serial_report, .statuses = &serial_statuses}
+    );
+    auto serial_sums = sums;
+    sums.clear();
+
+    auto in = std::istringstream(input);
+    auto statuses = std::vector<int>();
+
+    const auto status = calc.run_batch(
+        in,
+        out,
+        {.report = &report, .threads = 4, .statuses = &statuses}
+    );
+
+    ASSERT_EQ(EXIT_FAILURE, status);
+    ASSERT_EQ(serial_status, status);
+    ASSERT_EQ(serial_out.str(), out.str());
+    ASSERT_EQ(serial_report.str(), report.str());
+    ASSERT_EQ(serial_statuses, statuses);
+
+    std::sort(sums.begin(), sums.end());
+    ASSERT_EQ(serial_sums, sums);
+}
+
+TEST_F(BatchTest, ParallelCompletionOrder) {
+    auto calc = app();
+    setup(calc);
+
+    auto in = std::istringstream(mixed(100));
+    auto statuses = std::vector<int>();
+
+    calc.run_batch(
+        in,
+        out,
+        {.threads = 3, .completion_order = true, .statuses = &statuses}
+    );
+
+    ASSERT_EQ(100, statuses.size());
+    ASSERT_EQ(25, std::count(statuses.begin(), statuses.end(), EXIT_FAILURE));
+    ASSERT_EQ(25, sums.size());
+}
+
+TEST_F(BatchTest, ParallelStopOnError) {
+    auto calc = app();
+    setup(calc);
+
+    auto in = std::istringstream("add 1 2\nadd 'x\nadd 6 7\n");
+    auto statuses = std::vector<int>();
+
+    const auto status = calc.run_batch(
+        in,
+        out,
+        {.stop_on_error = true, .threads = 2, .statuses = &statuses}
+    );
+
+    ASSERT_EQ(EXIT_FAILURE, status);
+    ASSERT_EQ((std::vector<int> {0, 1}), statuses);
+}
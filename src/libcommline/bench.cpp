@@ -0,0 +1,47 @@
+#include "bench.h"
+
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+    auto open_counter() -> int {
+        auto attributes = perf_event_attr();
+
+        attributes.size = sizeof(attributes);
+        attributes.type = PERF_TYPE_HARDWARE;
+        attributes.config = PERF_COUNT_HW_CACHE_MISSES;
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+
+        return static_cast<int>(
+            syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0)
+        );
+    }
+}
+
+cache_misses::cache_misses() : fd(open_counter()) {}
+
+cache_misses::~cache_misses() {
+    if (fd != -1) close(fd);
+}
+
+auto cache_misses::read() const -> std::uint64_t {
+    auto count = std::uint64_t(0);
+
+    if (::read(fd, &count, sizeof(count)) != sizeof(count)) return 0;
+    return count;
+}
+
+auto cache_misses::resume() -> void {
+    if (fd != -1) start = read();
+}
+
+auto cache_misses::report(benchmark::State& state) -> void {
+    if (fd == -1) return;
+
+    state.counters["cache_misses"] = benchmark::Counter(
+        static_cast<double>(read() - start),
+        benchmark::Counter::kAvgIterations
+    );
+}
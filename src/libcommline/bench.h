@@ -0,0 +1,29 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+
+using namespace std::literals;
+
+// Counts the hardware cache misses of the calling thread. Where the kernel
+// does not allow it, the counter is unavailable and nothing is reported.
+class cache_misses {
+    int fd = -1;
+    std::uint64_t start = 0;
+
+    auto read() const -> std::uint64_t;
+public:
+    cache_misses();
+
+    cache_misses(const cache_misses&) = delete;
+
+    ~cache_misses();
+
+    auto operator=(const cache_misses&) -> cache_misses& = delete;
+
+    // Starts counting from zero.
+    auto resume() -> void;
+
+    // Adds the misses counted since 'resume' to 'state' as a per-iteration
+    // 'cache_misses' counter.
+    auto report(benchmark::State& state) -> void;
+};
@@ -0,0 +1,54 @@
+#include "cache.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <system_error>
+#include <unistd.h>
+
+namespace commline::cache {
+    auto directory() -> std::filesystem::path {
+        if (const auto* xdg = std::getenv("XDG_CACHE_HOME"); xdg && *xdg) {
+            return xdg;
+        }
+
+        if (const auto* home = std::getenv("HOME"); home && *home) {
+            return std::filesystem::path(home) / ".cache";
+        }
+
+        return {};
+    }
+
+    auto replace(const std::string& path, std::string_view text) -> bool {
+        auto error = std::error_code();
+        std::filesystem::create_directories(
+            std::filesystem::path(path).parent_path(),
+            error
+        );
+        if (error) return false;
+
+        auto temporary = path + ".XXXXXX";
+        const auto fd = ::mkstemp(temporary.data());
+        if (fd == -1) return false;
+
+        while (!text.empty()) {
+            const auto written = ::write(fd, text.data(), text.size());
+
+            if (written == -1) {
+                if (errno == EINTR) continue;
+
+                ::close(fd);
+                ::unlink(temporary.c_str());
+                return false;
+            }
+
+            text.remove_prefix(written);
+        }
+
+        if (::close(fd) == -1 || ::rename(temporary.c_str(), path.c_str())) {
+            ::unlink(temporary.c_str());
+            return false;
+        }
+
+        return true;
+    }
+}
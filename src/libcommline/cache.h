@@ -0,0 +1,17 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+// Files that only save work, such as the completion cache and configuration
+// snapshots. Failing to write one is never an error.
+namespace commline::cache {
+    // '$XDG_CACHE_HOME', or '~/.cache' if the variable is not set. Empty if
+    // neither variable is set.
+    auto directory() -> std::filesystem::path;
+
+    // Writes 'text' to a file next to 'path' and renames it into place, so
+    // that readers see either the old file or the new one.
+    auto replace(const std::string& path, std::string_view text) -> bool;
+}
@@ -0,0 +1,145 @@
+#include "bench.h"
+
+#include <commline/command.h>
+
+#include <string>
+#include <vector>
+
+using commline::command;
+using commline::flag;
+using commline::list;
+using commline::option;
+using commline::required;
+using commline::variadic;
+
+namespace {
+    auto names(std::size_t count) -> std::vector<std::string> {
+        auto result = std::vector<std::string>();
+        result.reserve(count);
+
+        for (std::size_t i = 0; i < count; ++i) {
+            result.push_back("command-" + std::to_string(i));
+        }
+
+        return result;
+    }
+
+    auto leaf(std::string_view name)
+        -> std::unique_ptr<commline::command_node> {
+        return command(
+            name,
+            "A command.",
+            commline::options(),
+            commline::arguments(),
+            [](const commline::app& app) {}
+        );
+    }
+
+    // Finds the last of 'range(0)' sibling commands.
+    auto find_wide(benchmark::State& state) -> void {
+        const auto width = static_cast<std::size_t>(state.range(0));
+        const auto children = names(width);
+
+        auto root = leaf("root");
+        for (const auto& name : children) root->subcommand(leaf(name));
+
+        const auto* const word = children.back().c_str();
+        const auto args = commline::argv(&word, 1);
+
+        for (auto _ : state) {
+            auto first = args.begin();
+            benchmark::DoNotOptimize(root->find(first, args.end()));
+        }
+    }
+
+    // Finds the command at the bottom of a chain 'range(0)' commands deep.
+    auto find_deep(benchmark::State& state) -> void {
+        const auto depth = static_cast<std::size_t>(state.range(0));
+
+        auto root = leaf("root");
+        auto* node = root.get();
+
+        for (std::size_t i = 0; i < depth; ++i) {
+            node = node->subcommand(leaf("command"));
+        }
+
+        const auto words = std::vector<const char*>(depth, "command");
+        const auto args = commline::argv(words);
+
+        for (auto _ : state) {
+            auto first = args.begin();
+            benchmark::DoNotOptimize(root->find(first, args.end()));
+        }
+
+        state.SetItemsProcessed(state.iterations() * depth);
+    }
+
+    auto documented() -> std::unique_ptr<commline::command_node> {
+        return command(
+            "copy",
+            "Copy files and directories.",
+            commline::options(
+                flag({"recursive", "r"}, "Copy directories recursively."),
+                flag({"force", "f"}, "Overwrite existing files."),
+                flag({"verbose", "v"}, "Explain what is being done."),
+                option<std::string_view>(
+                    {"target-directory", "t"},
+                    "Copy all sources into the directory.",
+                    "directory"
+                ),
+                option<int>({"mode", "m"}, "Set the file mode.", "mode"),
+                list<std::string_view>(
+                    {"exclude", "x"},
+                    "Skip files matching the pattern.",
+                    "pattern"
+                )
+            ),
+            commline::arguments(
+                variadic<std::string_view>("source"),
+                required<std::string_view>("destination")
+            ),
+            [](const commline::app& app,
+               bool recursive,
+               bool force,
+               bool verbose,
+               std::string_view directory,
+               int mode,
+               std::vector<std::string_view> exclude,
+               std::vector<std::string_view> sources,
+               std::string_view destination) {}
+        );
+    }
+
+    // Renders the help text of a command with options, arguments and
+    // 'range(0)' subcommands. Help is cached after the first request, so
+    // each iteration invalidates it first.
+    auto render_help(benchmark::State& state) -> void {
+        const auto width = static_cast<std::size_t>(state.range(0));
+        const auto children = names(width);
+
+        auto root = documented();
+        for (const auto& name : children) root->subcommand(leaf(name));
+
+        for (auto _ : state) {
+            state.PauseTiming();
+            // Adding a command of an existing name only clears the cache.
+            root->subcommand(leaf(children.front()));
+            state.ResumeTiming();
+
+            benchmark::DoNotOptimize(root->help().data());
+        }
+    }
+
+    // Reads help text that has already been rendered.
+    auto cached_help(benchmark::State& state) -> void {
+        const auto root = documented();
+        root->help();
+
+        for (auto _ : state) benchmark::DoNotOptimize(root->help().data());
+    }
+}
+
+BENCHMARK(find_wide)->RangeMultiplier(4)->Range(1, 1024);
+BENCHMARK(find_deep)->RangeMultiplier(4)->Range(1, 256);
+BENCHMARK(render_help)->Arg(1)->Arg(16)->Arg(128);
+BENCHMARK(cached_help);
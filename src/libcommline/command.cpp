@@ -0,0 +1,180 @@
+#include <commline/command.h>
+#include <commline/print.h>
+
+#include <sstream>
+
+namespace commline {
+    auto command_node::find(std::string_view name) const -> command_node* {
+        const auto node =
+            std::ranges::lower_bound(commands, name, {}, &command_node::name);
+
+        if (node != commands.end() && (*node)->name == name) return *node;
+        return nullptr;
+    }
+
+    auto command_node::clear_help() -> void {
+        const auto lock = std::scoped_lock(help_mutex);
+        help_text.reset();
+    }
+
+    auto command_node::render_help(std::ostream& out) const -> void {
+        constexpr auto spacing = 15;
+
+        const auto params = parameters();
+
+        out << description << "\n\n"
+            << "Usage: " << name;
+
+        // The help flag is not listed.
+        if (params.option_entries.size() > 1) {
+            out << " [options]";
+            if (!params.arguments.empty()) out << " [--]";
+        }
+
+        print_arguments(out, params.arguments);
+        out << "\n";
+
+        print_options(out, params.option_entries, env_prefix);
+
+        if (commands.empty()) return;
+
+        print::header(out, "Commands");
+
+        for (const auto* node : commands) {
+            print::indent(out);
+            out << node->name;
+
+            print::spaces(out, spacing - node->name.size());
+            out << node->description << "\n";
+        }
+    }
+
+    auto command_node::prepare(
+        const app& context,
+        const option_values& values,
+        argv args,
+        std::pmr::vector<std::string_view>& positional,
+        std::ostream& out
+    ) const -> expected<bool> {
+        const auto table = parameters().options;
+
+        reset_options(values, positional.get_allocator().resource());
+
+        auto status = parse_options(table, values, args, positional);
+        if (!status) return std::move(status).error();
+
+        read_environment(table, values, env_prefix);
+
+        // The help flag is always the first.
+        if (values.flags.front()) {
+            print::write(out, help());
+            return false;
+        }
+
+        if (context.config_error) return *context.config_error;
+
+        status = read_config(table, values, context.config);
+        if (!status) return std::move(status).error();
+
+        return true;
+    }
+
+    auto command_node::help() const -> const std::string& {
+        const auto lock = std::scoped_lock(help_mutex);
+
+        if (!help_text) {
+            auto out = std::ostringstream();
+            render_help(out);
+            help_text = std::move(out).str();
+        }
+
+        return *help_text;
+    }
+
+    auto command_node::describe() const -> command_info {
+        auto info = command_info();
+        info.name = name;
+        info.description = description;
+
+        const auto params = parameters();
+        describe_options(params.option_entries, info.options);
+        describe_arguments(params.arguments, info.arguments);
+
+        info.commands.reserve(commands.size());
+        for (const auto* node : commands) {
+            info.commands.push_back(node->describe());
+        }
+
+        return info;
+    }
+
+    auto command_node::complete(
+        iterator first,
+        iterator last,
+        completion& result
+    ) const -> void {
+        if (first == last) {
+            if (!result.prefix.starts_with('-')) {
+                for (const auto* node : commands) result.add(node->name);
+            }
+        }
+        else if (const auto* node = find(*first)) {
+            result.enter(node->name);
+            node->complete(++first, last, result);
+            return;
+        }
+
+        const auto params = parameters();
+        const auto point = scan_options(params.options, argv(first, last));
+
+        if (point.option) {
+            complete_option(params.option_entries[*point.option], result);
+        }
+        else if (!point.options_ended && result.prefix.starts_with('-')) {
+            complete_options(params.options, params.option_entries, result);
+        }
+        else complete_argument(params.arguments, point.argument, result);
+    }
+
+    auto command_node::find(iterator& first, iterator last) -> command_node* {
+        if (first != last) {
+            if (auto* const node = find(*first)) {
+                return node->find(++first, last);
+            }
+        }
+
+        return this;
+    }
+
+    auto command_node::subcommand(std::unique_ptr<command_node>&& node)
+        -> command_node* {
+        clear_help();
+
+        if (auto* const existing = find(node->name)) return existing;
+
+        if (!env_prefix.empty()) node->use_environment(env_prefix);
+
+        // Constant subcommands are kept alongside the added ones.
+        if (index.empty()) index.assign(commands.begin(), commands.end());
+
+        const auto position = std::ranges::lower_bound(
+            index,
+            node->name,
+            {},
+            &command_node::name
+        );
+
+        auto* const result = owned.emplace_back(std::move(node)).get();
+        index.insert(position, result);
+        commands = index;
+
+        return result;
+    }
+
+    auto command_node::use_environment(std::string_view prefix) -> void {
+        clear_help();
+        env_prefix = prefix;
+
+        for (auto* node : commands) node->use_environment(prefix);
+    }
+}
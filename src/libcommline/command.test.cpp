@@ -2,6 +2,9 @@
 
 #include <commline/command.h>
 
+#include <atomic>
+#include <thread>
+
 using commline::arguments;
 using commline::command;
 using commline::flag;
@@ -74,6 +77,65 @@ TEST_F(CommandTest, Subcommand) {
     command->execute(app_info, commline::argv(it, end), out);
 }
 
+TEST_F(CommandTest, ExecuteRepeatedly) {
+    auto total = 0;
+
+    auto cmd = command(
+        "sum",
+        description,
+        options(option<int>({"n"}, "", "")),
+        arguments(variadic<int>("numbers")),
+        [&total](const commline::app& app, int n, std::vector<int> numbers) {
+            total += n;
+            for (const auto number : numbers) total += number;
+        }
+    );
+
+    cmd->execute(app_info, std::array {"-n", "1", "2", "3"}, out);
+    cmd->execute(app_info, std::array {"-n", "10"}, out);
+    cmd->execute(app_info, std::array {"20"}, out);
+
+    ASSERT_EQ(36, total);
+}
+
+TEST_F(CommandTest, ExecuteConcurrently) {
+    constexpr auto thread_count = 8;
+    constexpr auto iterations = 500;
+
+    auto total = std::atomic<int>(0);
+
+    auto cmd = command(
+        "add",
+        description,
+        options(flag({"negate"}, "")),
+        arguments(required<int>("number")),
+        [&total](const commline::app& app, bool negate, int number) {
+            total += negate ? -number : number;
+        }
+    );
+
+    auto threads = std::vector<std::thread>();
+
+    for (auto i = 0; i < thread_count; ++i) {
+        threads.emplace_back([&, i] {
+            auto out = std::ostringstream();
+            const auto number = std::to_string(i + 1);
+            const auto positive = std::array {number.c_str()};
+            const auto negative = std::array {"--negate", number.c_str()};
+
+            for (auto j = 0; j < iterations; ++j) {
+                cmd->execute(app_info, positive, out);
+                cmd->execute(app_info, positive, out);
+                cmd->execute(app_info, negative, out);
+            }
+        });
+    }
+
+    for (auto& thread : threads) thread.join();
+
+    ASSERT_EQ(iterations * (1 + 2 + 3 + 4 + 5 + 6 + 7 + 8), total);
+}
+
 TEST_F(CommandTest, Help) {
     commline::command(
         "foo",
@@ -137,6 +199,54 @@ Options:
     );
 }
 
+TEST_F(CommandTest, HelpRuntimeText) {
+    auto called = false;
+
+    // Text built at run time is copied into the command, so it may be
+    // destroyed before the command runs.
+    const auto root = [&called] {
+        auto description = std::string("Built at run time");
+        auto alias = std::string("eighth");
+        auto argument = std::string("file");
+
+        return command(
+            "foo",
+            description + ".",
+            options(flag(
+                {"a", "b", "c", "d", "e", "f", "g", alias},
+                std::string("A flag with ") + "eight aliases"
+            )),
+            arguments(required<std::string_view>(argument)),
+            [&called](
+                const commline::app& app,
+                bool flag,
+                std::string_view file
+            ) {
+                called = flag && file == "x";
+            }
+        );
+    }();
+
+    root->execute(app_info, help, out);
+
+    ASSERT_EQ(
+        R"(Built at run time.
+
+Usage: foo [options] [--] FILE
+
+Options:
+    -a, -b, -c, -d, -e, -f, -g, --eighth
+                                  A flag with eight aliases
+)",
+        out.str()
+    );
+
+    constexpr auto args = std::array {"--eighth", "x"};
+    root->execute(app_info, args, out);
+
+    ASSERT_TRUE(called);
+}
+
 TEST_F(CommandTest, HelpArguments) {
     command(
         "foo",
@@ -241,3 +351,121 @@ Commands:
         result
     );
 }
+
+TEST_F(CommandTest, HelpCached) {
+    auto root = command(
+        "foo",
+        description,
+        options(),
+        arguments(),
+        [](const commline::app& app) { FAIL() << "Command should not execute"; }
+    );
+
+    const auto& first = root->help();
+
+    root->execute(app_info, help, out);
+    root->execute(app_info, help, out);
+
+    ASSERT_EQ(&first, &root->help());
+    ASSERT_EQ(first + first, out.str());
+
+    root->subcommand(command(
+        "bar",
+        "A second test command",
+        options(),
+        arguments(),
+        [](const commline::app& app) { FAIL() << "Command should not execute"; }
+    ));
+
+    ASSERT_TRUE(root->help().ends_with(
+        "Commands:\n    bar            A second test command\n"
+    ));
+}
+
+TEST_F(CommandTest, HelpRedirectedStdout) {
+    auto root = command(
+        "foo",
+        description,
+        options(),
+        arguments(),
+        [](const commline::app& app) { FAIL() << "Command should not execute"; }
+    );
+
+    auto* const saved = std::cout.rdbuf(out.rdbuf());
+    root->execute(app_info, help, std::cout);
+    std::cout.rdbuf(saved);
+
+    ASSERT_EQ(root->help(), out.str());
+}
+
+TEST_F(CommandTest, HelpEnvironment) {
+    auto root = command(
+        "foo",
+        description,
+        options(
+            flag({"dry-run", "n"}, "Do nothing"),
+            commline::env(
+                "FOO_OUTPUT",
+                option<std::string_view>({"o", "output"}, "Output", "file")
+            ),
+            flag({"v"}, "Verbose")
+        ),
+        arguments(),
+        [](const commline::app& app, bool dry_run, std::string_view, bool) {
+            FAIL() << "Command should not execute";
+        }
+    );
+
+    root->use_environment("TEST_");
+    root->execute(app_info, help, out);
+
+    ASSERT_EQ(
+        R"(a test command
+
+Usage: foo [options]
+
+Options:
+    --dry-run, -n                 Do nothing [env: TEST_DRY_RUN]
+    -o, --output file             Output [env: FOO_OUTPUT]
+    -v                            Verbose
+)",
+        out.str()
+    );
+}
+
+TEST_F(CommandTest, SubcommandEnvironment) {
+    constexpr auto args = std::array {"cmd"};
+    const auto argv = commline::argv(args);
+
+    setenv("TEST_NAME", "value", 1);
+
+    auto root = command(
+        "root",
+        description,
+        options(),
+        arguments(),
+        [](const commline::app& app) { FAIL() << "Command should not run."; }
+    );
+
+    // The prefix is kept after the string passed in is destroyed.
+    root->use_environment(std::string("TEST_"));
+
+    auto found = std::string();
+
+    root->subcommand(command(
+        "cmd",
+        description,
+        options(option<std::string_view>({"name"}, "", "")),
+        arguments(),
+        [&found](const commline::app& app, std::string_view name) {
+            found = name;
+        }
+    ));
+
+    auto it = argv.begin();
+    root->find(it, argv.end())->execute(app_info, {it, argv.end()}, out);
+
+    unsetenv("TEST_NAME");
+
+    ASSERT_EQ("value", found);
+}
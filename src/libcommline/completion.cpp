@@ -0,0 +1,111 @@
+#include <commline/completion.h>
+#include <commline/completion_cache.h>
+#include <commline/parser.h>
+#include <commline/print.h>
+
+#include <fmt/format.h>
+#include <sys/stat.h>
+
+namespace commline {
+    auto modification_time(std::string path) -> std::function<std::string()> {
+        return [path = std::move(path)]() -> std::string {
+            struct stat st;
+            if (::stat(path.c_str(), &st) == -1) return {};
+
+            return fmt::format("{}.{}", st.st_mtim.tv_sec, st.st_mtim.tv_nsec);
+        };
+    }
+
+    auto completion_request::try_parse(argv args)
+        -> expected<completion_request> {
+        if (args.size() < 2 || std::string_view(args[1]) != "--") {
+            return parse_error(
+                "usage: {} <index> -- <words>...",
+                complete_command
+            );
+        }
+
+        const auto index = parser<std::size_t>::try_parse(args[0]);
+        if (!index) return index.error();
+
+        const auto words = args.subspan(2);
+
+        if (*index == 0 || *index > words.size()) {
+            return parse_error("word index out of range: {}", *index);
+        }
+
+        return completion_request {
+            words.subspan(1, *index - 1),
+            *index < words.size() ? words[*index] : std::string_view()
+        };
+    }
+
+    completion::completion(
+        std::string_view program,
+        std::string_view word,
+        completion_cache* cache
+    ) :
+        command(program),
+        lead(word.data(), 0),
+        cache(cache),
+        prefix(word) {}
+
+    auto completion::enter(std::string_view name) -> void {
+        command.append(1, ' ').append(name);
+    }
+
+    auto completion::narrow(std::size_t count) -> void {
+        const auto word = std::string_view(
+            lead.data(),
+            lead.size() + prefix.size()
+        );
+
+        lead = word.substr(0, count);
+        prefix = word.substr(count);
+    }
+
+    auto completion::add(std::string_view candidate) -> void {
+        if (!candidate.starts_with(prefix)) return;
+
+        auto& result = candidates.emplace_back();
+        result.reserve(lead.size() + candidate.size());
+        result.append(lead).append(candidate);
+    }
+
+    auto completion::provide(
+        const std::optional<candidate_provider>& provider,
+        std::string_view parameter
+    ) -> void {
+        if (!provider || !*provider) return;
+
+        const auto& policy = provider->cache;
+
+        if (!cache || policy.ttl <= std::chrono::seconds::zero()) {
+            for (const auto& candidate : provider->list(prefix)) add(candidate);
+            return;
+        }
+
+        const auto key = completion_cache::key(command, parameter, prefix);
+        const auto stamp = policy.stamp ? policy.stamp() : std::string();
+
+        if (const auto cached = cache->find(key, stamp)) {
+            for (const auto candidate : *cached) add(candidate);
+            return;
+        }
+
+        const auto listed = provider->list(prefix);
+        for (const auto& candidate : listed) add(candidate);
+
+        cache->store(key, stamp, policy.ttl, listed);
+    }
+
+    auto completion::write(std::ostream& out) const -> void {
+        auto text = std::string();
+
+        for (const auto& candidate : candidates) {
+            text.append(candidate).push_back('\n');
+        }
+
+        print::write(out, text);
+    }
+}
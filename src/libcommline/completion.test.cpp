@@ -0,0 +1,168 @@
+#include "test.h"
+
+#include <commline/application.h>
+
+using commline::application;
+using commline::arguments;
+using commline::command;
+using commline::flag;
+using commline::option;
+using commline::options;
+using commline::required;
+using commline::variadic;
+
+namespace {
+    auto hosts(std::string_view prefix) -> std::vector<std::string> {
+        return {"alpha", "beta", "bravo"};
+    }
+
+    auto jobs(std::string_view prefix) -> std::vector<std::string> {
+        return {"101", "102", "230"};
+    }
+}
+
+class CompletionTest : public testing::Test {
+protected:
+    static auto app() {
+        return application(
+            "tool",
+            "1.0.0",
+            "A tool for tests.",
+            options(
+                flag({"verbose", "v"}, "Print more"),
+                commline::complete(
+                    option<std::string_view>({"host", "H"}, "Server", "name"),
+                    hosts
+                )
+            ),
+            arguments(),
+            [](const commline::app& app, bool verbose, std::string_view host) {
+                FAIL() << "Command should not run.";
+            }
+        );
+    }
+
+    template <typename App>
+    static auto setup(App& app) -> void {
+        app.subcommand(command(
+            "cancel",
+            "Cancel jobs",
+            options(flag({"force", "f"}, "Do not ask")),
+            arguments(
+                required<std::string_view>("queue"),
+                commline::complete(variadic<int>("jobs"), jobs)
+            ),
+            [](
+                const commline::app& app,
+                bool force,
+                std::string_view queue,
+                const std::vector<int>& jobs
+            ) { FAIL() << "Command should not run."; }
+        ));
+
+        app.subcommand(command(
+            "check",
+            "Check the server",
+            options(),
+            arguments(),
+            [](const commline::app& app) { FAIL() << "Command should not run."; }
+        ));
+
+        app.on_error([](std::exception_ptr) {});
+    }
+
+    // Completes the word at 'index' of 'words', which follow the program
+    // name.
+    static auto complete(
+        std::size_t index,
+        std::initializer_list<std::string_view> words
+    ) -> std::string {
+        auto tool = app();
+        setup(tool);
+
+        auto out = std::ostringstream();
+
+        auto storage = std::vector<std::string> {
+            "tool",
+            std::string(commline::complete_command),
+            std::to_string(index),
+            "--",
+            "tool"};
+        storage.insert(storage.end(), words.begin(), words.end());
+
+        auto argv = std::vector<char*>();
+        for (auto& arg : storage) argv.push_back(arg.data());
+
+        if (tool.run(argv.size(), argv.data(), out) != EXIT_SUCCESS) {
+            return "error";
+        }
+
+        return out.str();
+    }
+};
+
+TEST_F(CompletionTest, Subcommands) {
+    ASSERT_EQ("cancel\ncheck\n", complete(1, {}));
+    ASSERT_EQ("cancel\ncheck\n", complete(1, {"c"}));
+    ASSERT_EQ("check\n", complete(1, {"ch"}));
+}
+
+TEST_F(CompletionTest, OptionNames) {
+    ASSERT_EQ(
+        "--help\n-?\n--verbose\n-v\n--host\n-H\n",
+        complete(1, {"-"})
+    );
+    ASSERT_EQ("--force\n", complete(2, {"cancel", "--f"}));
+}
+
+TEST_F(CompletionTest, OptionValue) {
+    ASSERT_EQ("beta\nbravo\n", complete(2, {"--host", "b"}));
+    ASSERT_EQ("alpha\n", complete(2, {"-vH", "a"}));
+    ASSERT_EQ("--host=alpha\n", complete(1, {"--host=a"}));
+}
+
+TEST_F(CompletionTest, Arguments) {
+    // The first argument has no completer.
+    ASSERT_EQ("", complete(2, {"cancel"}));
+    ASSERT_EQ("101\n102\n230\n", complete(3, {"cancel", "jobs"}));
+    ASSERT_EQ("101\n102\n", complete(5, {"cancel", "-f", "jobs", "230", "1"}));
+}
+
+TEST_F(CompletionTest, EndOfOptions) {
+    ASSERT_EQ("", complete(3, {"cancel", "--", "-"}));
+}
+
+TEST_F(CompletionTest, UnknownOption) {
+    ASSERT_EQ("101\n102\n", complete(4, {"cancel", "--all", "q", "10"}));
+}
+
+TEST_F(CompletionTest, InvalidRequest) {
+    ASSERT_EQ("error", complete(3, {"cancel"}));
+    ASSERT_EQ("error", complete(0, {}));
+}
+
+TEST_F(CompletionTest, Schema) {
+    auto tool = app();
+    setup(tool);
+
+    auto out = std::ostringstream();
+
+    auto argv0 = std::string("tool");
+    auto argv1 = std::string(commline::schema_command);
+    auto argv2 = std::string("bash");
+    char* argv[] = {argv0.data(), argv1.data(), argv2.data(), nullptr};
+
+    ASSERT_EQ(EXIT_SUCCESS, tool.run(3, argv, out));
+
+    const auto bash = out.str();
+
+    // Commands with completers defer to the program.
+    ASSERT_NE(
+        std::string::npos,
+        bash.find("'tool')\n            mapfile -t COMPREPLY < <(")
+    );
+    ASSERT_EQ(
+        std::string::npos,
+        bash.find("'tool check')\n            mapfile")
+    );
+}
@@ -0,0 +1,225 @@
+#include "cache.h"
+
+#include <commline/completion_cache.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+namespace {
+    using clock = commline::completion_cache::clock;
+
+    constexpr auto magic =
+        std::array<char, 8> {'c', 'l', 'c', 'a', 'c', 'h', 'e', '1'};
+
+    struct header {
+        std::array<char, 8> magic;
+        std::uint64_t count;
+    };
+
+    // Entries are stored as an array of records sorted by key, followed by
+    // the key, stamp and values of each record. Values end with a newline.
+    struct record {
+        std::uint64_t offset;
+        std::uint32_t key_size;
+        std::uint32_t stamp_size;
+        std::uint64_t values_size;
+        std::int64_t expires;
+    };
+
+    struct entry {
+        std::string_view key;
+        std::string_view stamp;
+        std::string_view values;
+        std::int64_t expires;
+    };
+
+    auto epoch_seconds(clock::time_point time) -> std::int64_t {
+        using namespace std::chrono;
+
+        return duration_cast<seconds>(time.time_since_epoch()).count();
+    }
+
+    // The entries of a mapped cache file. Records are checked as they are
+    // read, and a damaged file reads as an empty one.
+    class reader {
+        std::span<const char> data;
+        std::uint64_t count = 0;
+    public:
+        reader(std::span<const char> data) : data(data) {
+            auto head = header();
+            if (data.size() < sizeof(head)) return;
+
+            std::memcpy(&head, data.data(), sizeof(head));
+            if (head.magic != magic) return;
+
+            const auto records = (data.size() - sizeof(head)) / sizeof(record);
+            if (head.count <= records) count = head.count;
+        }
+
+        auto size() const noexcept -> std::uint64_t { return count; }
+
+        auto at(std::uint64_t index) const -> std::optional<entry> {
+            auto rec = record();
+            std::memcpy(
+                &rec,
+                data.data() + sizeof(header) + index * sizeof(record),
+                sizeof(rec)
+            );
+
+            const auto size =
+                std::uint64_t(rec.key_size) + rec.stamp_size + rec.values_size;
+            if (rec.offset > data.size() || size > data.size() - rec.offset) {
+                return {};
+            }
+
+            const auto* const first = data.data() + rec.offset;
+
+            return entry {
+                {first, rec.key_size},
+                {first + rec.key_size, rec.stamp_size},
+                {first + rec.key_size + rec.stamp_size, rec.values_size},
+                rec.expires};
+        }
+    };
+}
+
+namespace commline {
+    completion_cache::completion_cache(std::string_view program) {
+        if (const auto directory = cache::directory(); !directory.empty()) {
+            path = directory / program / "completions";
+        }
+    }
+
+    auto completion_cache::key(
+        std::string_view command,
+        std::string_view parameter,
+        std::string_view prefix
+    ) -> std::string {
+        auto result = std::string();
+        result.reserve(command.size() + parameter.size() + prefix.size() + 2);
+
+        result.append(command)
+            .append(1, '\0')
+            .append(parameter)
+            .append(1, '\0')
+            .append(prefix);
+
+        return result;
+    }
+
+    auto completion_cache::contents() -> std::span<const char> {
+        // A missing file, as on the first completion, is an empty cache.
+        if (!file && !path.empty()) {
+            auto mapped = mapped_file::map(path.c_str());
+            if (!mapped) return {};
+
+            file.emplace(*std::move(mapped));
+        }
+
+        if (!file) return {};
+        return file->contents();
+    }
+
+    auto completion_cache::find(
+        std::string_view key,
+        std::string_view stamp,
+        clock::time_point now
+    ) -> std::optional<std::vector<std::string_view>> {
+        const auto entries = reader(contents());
+
+        auto low = std::uint64_t(0);
+        auto high = entries.size();
+
+        while (low < high) {
+            const auto middle = low + (high - low) / 2;
+            const auto current = entries.at(middle);
+            if (!current) return {};
+
+            if (current->key < key) low = middle + 1;
+            else high = middle;
+        }
+
+        if (low == entries.size()) return {};
+
+        const auto found = entries.at(low);
+        if (!found || found->key != key || found->stamp != stamp ||
+            found->expires <= epoch_seconds(now)) {
+            return {};
+        }
+
+        auto result = std::vector<std::string_view>();
+        auto values = found->values;
+
+        while (!values.empty()) {
+            const auto end = values.find('\n');
+            if (end == std::string_view::npos) return {};
+
+            result.push_back(values.substr(0, end));
+            values.remove_prefix(end + 1);
+        }
+
+        return result;
+    }
+
+    auto completion_cache::store(
+        std::string_view key,
+        std::string_view stamp,
+        std::chrono::seconds ttl,
+        std::span<const std::string> candidates,
+        clock::time_point now
+    ) -> void {
+        if (path.empty()) return;
+
+        auto values = std::string();
+        for (const auto& candidate : candidates) {
+            values.append(candidate).push_back('\n');
+        }
+
+        const auto time = epoch_seconds(now);
+        auto entries = std::vector<entry> {
+            {key, stamp, values, time + ttl.count()}};
+
+        const auto existing = reader(contents());
+
+        for (std::uint64_t i = 0; i < existing.size(); ++i) {
+            const auto current = existing.at(i);
+            if (!current) break;
+
+            if (current->key != key && current->expires > time) {
+                entries.push_back(*current);
+            }
+        }
+
+        std::ranges::sort(entries, {}, &entry::key);
+
+        auto text = std::string();
+        auto offset = sizeof(header) + entries.size() * sizeof(record);
+
+        const auto head = header {magic, entries.size()};
+        text.append(reinterpret_cast<const char*>(&head), sizeof(head));
+
+        for (const auto& current : entries) {
+            const auto rec = record {
+                offset,
+                static_cast<std::uint32_t>(current.key.size()),
+                static_cast<std::uint32_t>(current.stamp.size()),
+                current.values.size(),
+                current.expires};
+
+            text.append(reinterpret_cast<const char*>(&rec), sizeof(rec));
+            offset += current.key.size() + current.stamp.size() +
+                      current.values.size();
+        }
+
+        for (const auto& current : entries) {
+            text.append(current.key)
+                .append(current.stamp)
+                .append(current.values);
+        }
+
+        // The entries read from the old mapping have been copied.
+        if (cache::replace(path, text)) file.reset();
+    }
+}
@@ -0,0 +1,175 @@
+#include "test.h"
+
+#include <commline/application.h>
+#include <commline/completion_cache.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+using commline::application;
+using commline::arguments;
+using commline::completion_cache;
+using commline::options;
+using commline::required;
+
+using namespace std::chrono_literals;
+
+class CompletionCacheTest : public testing::Test {
+protected:
+    std::string directory;
+
+    auto SetUp() -> void override {
+        directory = "/tmp/commline.test.XXXXXX";
+        if (!::mkdtemp(directory.data())) {
+            FAIL() << "failed to create directory: " << std::strerror(errno);
+        }
+
+        ::setenv("XDG_CACHE_HOME", directory.c_str(), 1);
+    }
+
+    auto TearDown() -> void override {
+        ::unsetenv("XDG_CACHE_HOME");
+        std::filesystem::remove_all(directory);
+    }
+
+    static auto strings(const std::optional<std::vector<std::string_view>>& found)
+        -> std::vector<std::string> {
+        if (!found) return {"missing"};
+        return {found->begin(), found->end()};
+    }
+};
+
+TEST_F(CompletionCacheTest, Location) {
+    ASSERT_EQ(
+        directory + "/tool/completions",
+        completion_cache("tool").location()
+    );
+}
+
+TEST_F(CompletionCacheTest, Find) {
+    auto cache = completion_cache("tool");
+    const auto hosts = std::vector<std::string> {"alpha", "beta"};
+    const auto jobs = std::vector<std::string> {"101"};
+
+    ASSERT_EQ(std::vector<std::string> {"missing"}, strings(cache.find("h", "")));
+
+    cache.store("h", "", 60s, hosts);
+    cache.store("j", "", 60s, jobs);
+    cache.store("e", "", 60s, {});
+
+    ASSERT_EQ(hosts, strings(cache.find("h", "")));
+    ASSERT_EQ(jobs, strings(cache.find("j", "")));
+    ASSERT_EQ(std::vector<std::string>(), strings(cache.find("e", "")));
+    ASSERT_EQ(std::vector<std::string> {"missing"}, strings(cache.find("a", "")));
+    ASSERT_EQ(std::vector<std::string> {"missing"}, strings(cache.find("z", "")));
+
+    // Another process sees the same entries.
+    ASSERT_EQ(hosts, strings(completion_cache("tool").find("h", "")));
+}
+
+TEST_F(CompletionCacheTest, Replace) {
+    auto cache = completion_cache("tool");
+
+    cache.store("h", "", 60s, std::vector<std::string> {"alpha"});
+    cache.store("h", "", 60s, std::vector<std::string> {"beta"});
+
+    ASSERT_EQ(std::vector<std::string> {"beta"}, strings(cache.find("h", "")));
+}
+
+TEST_F(CompletionCacheTest, Expire) {
+    auto cache = completion_cache("tool");
+    const auto now = completion_cache::clock::now();
+
+    cache.store("h", "", 60s, std::vector<std::string> {"alpha"}, now);
+    cache.store("j", "", 10s, std::vector<std::string> {"101"}, now);
+
+    ASSERT_EQ(1, strings(cache.find("h", "", now + 59s)).size());
+    ASSERT_EQ("missing", strings(cache.find("h", "", now + 60s)).front());
+
+    // Expired entries are dropped when another entry is stored.
+    cache.store("e", "", 60s, {}, now + 30s);
+    ASSERT_EQ("missing", strings(cache.find("j", "", now)).front());
+    ASSERT_EQ("alpha", strings(cache.find("h", "", now)).front());
+}
+
+TEST_F(CompletionCacheTest, Stamp) {
+    auto cache = completion_cache("tool");
+
+    cache.store("h", "1", 60s, std::vector<std::string> {"alpha"});
+
+    ASSERT_EQ("alpha", strings(cache.find("h", "1")).front());
+    ASSERT_EQ("missing", strings(cache.find("h", "2")).front());
+}
+
+TEST_F(CompletionCacheTest, Damaged) {
+    const auto path = completion_cache("tool").location();
+
+    std::filesystem::create_directories(directory + "/tool");
+    std::ofstream(path) << "not a cache file";
+
+    auto cache = completion_cache("tool");
+    ASSERT_EQ("missing", strings(cache.find("h", "")).front());
+
+    cache.store("h", "", 60s, std::vector<std::string> {"alpha"});
+    ASSERT_EQ("alpha", strings(cache.find("h", "")).front());
+}
+
+TEST_F(CompletionCacheTest, Complete) {
+    static auto calls = 0;
+    calls = 0;
+
+    const auto stamp = directory + "/stamp";
+    std::ofstream(stamp) << "1";
+
+    auto app = application(
+        "tool",
+        "1.0.0",
+        "A tool for tests.",
+        options(),
+        arguments(commline::complete(
+            required<std::string_view>("dataset"),
+            [](std::string_view prefix) -> std::vector<std::string> {
+                ++calls;
+                return {"logs", "metrics"};
+            },
+            {60s, commline::modification_time(stamp)}
+        )),
+        [](const commline::app& app, std::string_view dataset) {}
+    );
+
+    const auto complete = [&app](std::string word) -> std::string {
+        auto out = std::ostringstream();
+        auto storage = std::vector<std::string> {
+            "tool",
+            std::string(commline::complete_command),
+            "1",
+            "--",
+            "tool",
+            word};
+
+        auto argv = std::vector<char*>();
+        for (auto& arg : storage) argv.push_back(arg.data());
+
+        app.run(argv.size(), argv.data(), out);
+        return out.str();
+    };
+
+    ASSERT_EQ("logs\nmetrics\n", complete(""));
+    ASSERT_EQ("logs\nmetrics\n", complete(""));
+    ASSERT_EQ(1, calls);
+
+    // Each prefix is cached separately.
+    ASSERT_EQ("metrics\n", complete("m"));
+    ASSERT_EQ("metrics\n", complete("m"));
+    ASSERT_EQ(2, calls);
+
+    std::filesystem::last_write_time(
+        stamp,
+        std::filesystem::last_write_time(stamp) + 1s
+    );
+
+    ASSERT_EQ("metrics\n", complete("m"));
+    ASSERT_EQ(3, calls);
+}
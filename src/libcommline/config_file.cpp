@@ -0,0 +1,453 @@
+#include "cache.h"
+
+#include <commline/alias_table.h>
+#include <commline/config_file.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <fcntl.h>
+#include <filesystem>
+#include <fmt/format.h>
+#include <sys/stat.h>
+#include <system_error>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+namespace {
+    constexpr auto magic =
+        std::array<char, 8> {'c', 'l', 'c', 'o', 'n', 'f', 'i', '1'};
+
+    // What a snapshot was made from. A snapshot is used only while the
+    // file at its path has the same size and modification time.
+    struct source {
+        std::uint64_t size;
+        std::int64_t mtime;
+    };
+
+    // A snapshot is a header, then the section records sorted by name, then
+    // the entry records grouped by section, then the path of the file and
+    // the text of every name, key and value. Offsets are from the start of
+    // the snapshot.
+    struct header {
+        std::array<char, 8> magic;
+        source from;
+        std::uint64_t path_size;
+        std::uint64_t section_count;
+        std::uint64_t entry_count;
+    };
+
+    struct section_record {
+        std::uint64_t offset;
+        std::uint64_t name_size;
+        std::uint64_t first;
+        std::uint64_t count;
+    };
+
+    // The value follows the key.
+    struct entry_record {
+        std::uint64_t offset;
+        std::uint32_t key_size;
+        std::uint32_t value_size;
+    };
+
+    struct parsed_entry {
+        std::string_view section;
+        std::string_view key;
+        std::string_view value;
+    };
+
+    using commline::expected;
+    using commline::parse_error;
+
+    auto file_error(std::string_view what, const std::string& path)
+        -> parse_error {
+        return parse_error(
+            std::error_code(errno, std::generic_category()),
+            fmt::format("{} configuration file '{}'", what, path)
+        );
+    }
+
+    template <typename T>
+    auto read_record(std::span<const char> data, std::uint64_t offset) -> T {
+        auto result = T();
+        std::memcpy(&result, data.data() + offset, sizeof(result));
+        return result;
+    }
+
+    auto entries_offset(std::uint64_t section_count) -> std::uint64_t {
+        return sizeof(header) + section_count * sizeof(section_record);
+    }
+
+    auto in_bounds(
+        std::span<const char> data,
+        std::uint64_t offset,
+        std::uint64_t size
+    ) -> bool {
+        return offset <= data.size() && size <= data.size() - offset;
+    }
+
+    // Whether 'data' is an intact snapshot of the file at 'path' as it is
+    // now. Every record is checked so that lookups need not check again.
+    auto valid(std::span<const char> data, const std::string& path, source from)
+        -> bool {
+        if (data.size() < sizeof(header)) return false;
+
+        const auto head = read_record<header>(data, 0);
+
+        if (head.magic != magic || head.from.size != from.size ||
+            head.from.mtime != from.mtime)
+            return false;
+
+        const auto records = (data.size() - sizeof(header)) /
+                             sizeof(entry_record);
+        if (head.section_count > records || head.entry_count > records) {
+            return false;
+        }
+
+        const auto entries = entries_offset(head.section_count);
+        const auto strings = entries + head.entry_count * sizeof(entry_record);
+
+        if (!in_bounds(data, strings, head.path_size) ||
+            std::string_view(data.data() + strings, head.path_size) != path)
+            return false;
+
+        for (std::uint64_t i = 0; i < head.section_count; ++i) {
+            const auto section = read_record<section_record>(
+                data,
+                sizeof(header) + i * sizeof(section_record)
+            );
+
+            if (!in_bounds(data, section.offset, section.name_size) ||
+                section.first > head.entry_count ||
+                section.count > head.entry_count - section.first)
+                return false;
+        }
+
+        for (std::uint64_t i = 0; i < head.entry_count; ++i) {
+            const auto entry = read_record<entry_record>(
+                data,
+                entries + i * sizeof(entry_record)
+            );
+
+            const auto size =
+                std::uint64_t(entry.key_size) + entry.value_size;
+            if (!in_bounds(data, entry.offset, size)) return false;
+        }
+
+        return true;
+    }
+
+    constexpr auto whitespace = std::string_view(" \t\r");
+
+    auto trim(std::string_view text) -> std::string_view {
+        const auto first = text.find_first_not_of(whitespace);
+        if (first == std::string_view::npos) return {};
+
+        const auto last = text.find_last_not_of(whitespace);
+        return text.substr(first, last - first + 1);
+    }
+
+    // The name in a section header, with each run of whitespace inside it
+    // collapsed to a single space, so that '[remote  add]' names the same
+    // command as '[remote add]'. Names that had to change are kept in
+    // 'names'.
+    auto section_name(std::string_view header, std::deque<std::string>& names)
+        -> std::string_view {
+        const auto name = trim(header);
+        auto result = std::string();
+        auto space = false;
+
+        for (const auto c : name) {
+            if (whitespace.find(c) != std::string_view::npos) {
+                space = true;
+                continue;
+            }
+
+            if (std::exchange(space, false)) result.push_back(' ');
+            result.push_back(c);
+        }
+
+        if (result == name) return name;
+        return names.emplace_back(std::move(result));
+    }
+
+    auto parse(
+        std::string_view text,
+        const std::string& path,
+        std::deque<std::string>& names
+    ) -> expected<std::vector<parsed_entry>> {
+        auto result = std::vector<parsed_entry>();
+        auto section = std::string_view();
+        auto number = 0;
+
+        while (!text.empty()) {
+            ++number;
+
+            const auto end = text.find('\n');
+            const auto line = trim(text.substr(0, end));
+            text.remove_prefix(
+                end == std::string_view::npos ? text.size() : end + 1
+            );
+
+            if (line.empty() || line.front() == '#' || line.front() == ';') {
+                continue;
+            }
+
+            if (line.front() == '[') {
+                if (line.back() != ']') {
+                    return parse_error(
+                        "{}:{}: unterminated section header",
+                        path,
+                        number
+                    );
+                }
+
+                section = section_name(line.substr(1, line.size() - 2), names);
+                continue;
+            }
+
+            const auto equals_sign = line.find('=');
+            const auto key = trim(line.substr(0, equals_sign));
+
+            if (key.empty()) {
+                return parse_error(
+                    "{}:{}: missing option name",
+                    path,
+                    number
+                );
+            }
+
+            auto value = std::string_view("true");
+
+            if (equals_sign != std::string_view::npos) {
+                value = trim(line.substr(equals_sign + 1));
+
+                if (value.size() >= 2 && value.front() == '"' &&
+                    value.back() == '"') {
+                    value = value.substr(1, value.size() - 2);
+                }
+            }
+
+            result.push_back({section, key, value});
+        }
+
+        return result;
+    }
+
+    auto append(std::string& out, const auto& record) -> void {
+        out.append(reinterpret_cast<const char*>(&record), sizeof(record));
+    }
+
+    auto build_snapshot(
+        std::vector<parsed_entry>&& entries,
+        const std::string& path,
+        source from
+    ) -> std::string {
+        // Entries keep their file order within a section.
+        std::ranges::stable_sort(entries, {}, &parsed_entry::section);
+
+        auto sections = std::vector<section_record>();
+        auto names = std::vector<std::string_view>();
+
+        for (std::uint64_t i = 0; i < entries.size(); ++i) {
+            if (names.empty() || names.back() != entries[i].section) {
+                names.push_back(entries[i].section);
+                sections.push_back({0, entries[i].section.size(), i, 0});
+            }
+
+            ++sections.back().count;
+        }
+
+        auto offset = entries_offset(sections.size()) +
+                      entries.size() * sizeof(entry_record) + path.size();
+
+        for (auto& section : sections) {
+            section.offset = offset;
+            offset += section.name_size;
+        }
+
+        auto result = std::string();
+
+        append(
+            result,
+            header {
+                magic,
+                from,
+                path.size(),
+                sections.size(),
+                entries.size()}
+        );
+
+        for (const auto& section : sections) append(result, section);
+
+        for (const auto& entry : entries) {
+            append(
+                result,
+                entry_record {
+                    offset,
+                    static_cast<std::uint32_t>(entry.key.size()),
+                    static_cast<std::uint32_t>(entry.value.size())}
+            );
+
+            offset += entry.key.size() + entry.value.size();
+        }
+
+        result.append(path);
+        for (const auto name : names) result.append(name);
+
+        for (const auto& entry : entries) {
+            result.append(entry.key).append(entry.value);
+        }
+
+        return result;
+    }
+
+    auto read_all(int fd, const std::string& path, std::size_t size)
+        -> expected<std::string> {
+        auto result = std::string(size, '\0');
+        auto read = std::size_t(0);
+
+        while (read < size) {
+            const auto count = ::read(fd, result.data() + read, size - read);
+
+            if (count == -1) {
+                if (errno == EINTR) continue;
+                return file_error("failed to read", path);
+            }
+
+            // The file shrank after it was measured.
+            if (count == 0) break;
+
+            read += count;
+        }
+
+        result.resize(read);
+        return result;
+    }
+}
+
+namespace commline {
+    auto config_section::at(std::uint64_t index) const -> config_entry {
+        const auto head = read_record<header>(data, 0);
+        const auto entry = read_record<entry_record>(
+            data,
+            entries_offset(head.section_count) +
+                (first + index) * sizeof(entry_record)
+        );
+
+        const auto* const text = data.data() + entry.offset;
+
+        return {
+            {text, entry.key_size},
+            {text + entry.key_size, entry.value_size}};
+    }
+
+    config_file::config_file(std::string_view program, std::string_view path) :
+        path(std::filesystem::absolute(path)) {
+        if (const auto directory = cache::directory(); !directory.empty()) {
+            const auto hash = alias_table_base::hash(this->path, 0);
+
+            snapshot_path = directory / program /
+                            fmt::format("config-{:016x}", hash);
+        }
+    }
+
+    auto config_file::load() -> expected<void> {
+        const auto fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+        if (fd == -1) {
+            if (errno == ENOENT) return {};
+            return file_error("failed to open", path);
+        }
+
+        struct stat st;
+
+        if (::fstat(fd, &st) == -1) {
+            const auto error = file_error("failed to stat", path);
+            ::close(fd);
+            return error;
+        }
+
+        const auto from = source {
+            static_cast<std::uint64_t>(st.st_size),
+            std::int64_t(st.st_mtim.tv_sec) * 1'000'000'000 +
+                st.st_mtim.tv_nsec};
+
+        if (!snapshot_path.empty()) {
+            // A snapshot that cannot be mapped is made again.
+            if (auto mapped = mapped_file::map(snapshot_path.c_str());
+                mapped && valid(mapped->contents(), path, from)) {
+                ::close(fd);
+                snapshot.emplace(*std::move(mapped));
+                data = snapshot->contents();
+                return {};
+            }
+        }
+
+        auto text = read_all(fd, path, from.size);
+        ::close(fd);
+
+        if (!text) return std::move(text).error();
+
+        auto names = std::deque<std::string>();
+        auto entries = parse(*text, path, names);
+        if (!entries) return std::move(entries).error();
+
+        parsed = build_snapshot(*std::move(entries), path, from);
+        data = parsed;
+
+        if (!snapshot_path.empty()) cache::replace(snapshot_path, parsed);
+        return {};
+    }
+
+    auto config_file::section(std::string_view name)
+        -> expected<config_section> {
+        std::call_once(loaded, [this] {
+            if (auto status = load(); !status) {
+                failure = std::move(status).error();
+            }
+        });
+
+        if (failure) return *failure;
+        if (data.empty()) return config_section();
+
+        const auto head = read_record<header>(data, 0);
+
+        auto low = std::uint64_t(0);
+        auto high = head.section_count;
+
+        while (low < high) {
+            const auto middle = low + (high - low) / 2;
+            const auto section = read_record<section_record>(
+                data,
+                sizeof(header) + middle * sizeof(section_record)
+            );
+
+            const auto current = std::string_view(
+                data.data() + section.offset,
+                section.name_size
+            );
+
+            if (current < name) low = middle + 1;
+            else if (name < current) high = middle;
+            else return config_section(data, section.first, section.count);
+        }
+
+        return config_section();
+    }
+
+    auto config_file::section(argv path) -> expected<config_section> {
+        auto name = std::string();
+
+        for (const auto* word : path) {
+            if (!name.empty()) name.push_back(' ');
+            name.append(word);
+        }
+
+        return section(name);
+    }
+}
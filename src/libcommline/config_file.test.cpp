@@ -0,0 +1,348 @@
+#include "test.h"
+
+#include <commline/application.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <sys/stat.h>
+
+using commline::application;
+using commline::arguments;
+using commline::cli_error;
+using commline::config_file;
+using commline::config_section;
+using commline::flag;
+using commline::list;
+using commline::option;
+using commline::options;
+
+class ConfigFileTest : public testing::Test {
+protected:
+    std::string directory;
+    std::string path;
+
+    auto SetUp() -> void override {
+        directory = "/tmp/commline.test.XXXXXX";
+        if (!::mkdtemp(directory.data())) {
+            FAIL() << "failed to create directory: " << std::strerror(errno);
+        }
+
+        path = directory + "/config";
+        ::setenv("XDG_CACHE_HOME", (directory + "/cache").c_str(), 1);
+    }
+
+    auto TearDown() -> void override {
+        ::unsetenv("XDG_CACHE_HOME");
+        std::filesystem::remove_all(directory);
+    }
+
+    auto write(std::string_view text) -> void {
+        auto file = std::ofstream(path, std::ios::trunc);
+        file << text;
+    }
+
+    static auto entries(const commline::expected<config_section>& found)
+        -> std::vector<std::string> {
+        const auto& section = found.value();
+        auto result = std::vector<std::string>();
+
+        for (std::uint64_t i = 0; i < section.size(); ++i) {
+            const auto [key, value] = section.at(i);
+            result.push_back(std::string(key) + "=" + std::string(value));
+        }
+
+        return result;
+    }
+};
+
+TEST_F(ConfigFileTest, Sections) {
+    write(R"(# A comment
+jobs = 4
+; Another comment
+
+[remote add]
+fetch
+name = "origin"
+tags=false
+
+[]
+verbose = 1
+)");
+
+    auto config = config_file("tool", path);
+
+    ASSERT_EQ(
+        (std::vector<std::string> {"jobs=4", "verbose=1"}),
+        entries(config.section(""))
+    );
+    ASSERT_EQ(
+        (std::vector<std::string> {"fetch=true", "name=origin", "tags=false"}),
+        entries(config.section("remote add"))
+    );
+    ASSERT_TRUE(config.section("remote")->empty());
+}
+
+TEST_F(ConfigFileTest, SectionFromWords) {
+    write("[remote add]\nfetch\n");
+
+    auto config = config_file("tool", path);
+    const auto words = std::array {"remote", "add"};
+
+    ASSERT_EQ(
+        std::vector<std::string> {"fetch=true"},
+        entries(config.section(commline::argv(words)))
+    );
+}
+
+TEST_F(ConfigFileTest, SectionWhitespace) {
+    write("[ remote \t add ]\nfetch\n[remote  add  origin]\ntags\n");
+
+    auto config = config_file("tool", path);
+    const auto words = std::array {"remote", "add"};
+
+    ASSERT_EQ(
+        std::vector<std::string> {"fetch=true"},
+        entries(config.section(commline::argv(words)))
+    );
+    ASSERT_EQ(
+        std::vector<std::string> {"tags=true"},
+        entries(config.section("remote add origin"))
+    );
+}
+
+TEST_F(ConfigFileTest, MissingFile) {
+    auto config = config_file("tool", path);
+
+    ASSERT_TRUE(config.section("")->empty());
+}
+
+TEST_F(ConfigFileTest, SyntaxError) {
+    write("jobs = 4\n[remote\n");
+
+    auto config = config_file("tool", path);
+
+    // The error is kept for every later section.
+    for (const auto* const name : {"", "remote"}) {
+        const auto section = config.section(name);
+
+        ASSERT_FALSE(section);
+        ASSERT_EQ(
+            path + ":2: unterminated section header",
+            section.error().message
+        );
+    }
+}
+
+TEST_F(ConfigFileTest, SnapshotReused) {
+    write("jobs = 4\n");
+
+    struct stat before;
+    ASSERT_EQ(0, ::stat(path.c_str(), &before));
+
+    {
+        auto config = config_file("tool", path);
+        config.section("");
+
+        ASSERT_TRUE(std::filesystem::exists(config.snapshot_location()));
+    }
+
+    // Same size and modification time: the snapshot is not checked
+    // against the contents.
+    write("jobs = 8\n");
+    const auto times = std::array {before.st_atim, before.st_mtim};
+    ASSERT_EQ(0, ::utimensat(AT_FDCWD, path.c_str(), times.data(), 0));
+
+    auto config = config_file("tool", path);
+    ASSERT_EQ(std::vector<std::string> {"jobs=4"}, entries(config.section("")));
+}
+
+TEST_F(ConfigFileTest, SnapshotStale) {
+    write("jobs = 4\n");
+    config_file("tool", path).section("");
+
+    write("jobs = 16\n");
+
+    auto config = config_file("tool", path);
+    ASSERT_EQ(
+        std::vector<std::string> {"jobs=16"},
+        entries(config.section(""))
+    );
+}
+
+TEST_F(ConfigFileTest, SnapshotDamaged) {
+    write("jobs = 4\n");
+
+    auto location = std::string();
+
+    {
+        auto config = config_file("tool", path);
+        config.section("");
+        location = config.snapshot_location();
+    }
+
+    std::filesystem::resize_file(location, 20);
+
+    auto config = config_file("tool", path);
+    ASSERT_EQ(std::vector<std::string> {"jobs=4"}, entries(config.section("")));
+}
+
+TEST_F(ConfigFileTest, Precedence) {
+    write(R"(
+[build]
+jobs = 2
+output = config
+verbose = true
+include = a
+include = b
+)");
+
+    ::setenv("TEST_OUTPUT", "environment", 1);
+
+    auto jobs = 0;
+    auto output = std::string();
+    auto verbose = false;
+    auto include = std::vector<std::string_view>();
+
+    auto app = application(
+        "tool",
+        "0.0.0",
+        "",
+        options(),
+        arguments(),
+        [](const commline::app& app) { FAIL() << "Command should not run."; }
+    );
+
+    app.subcommand(commline::command(
+        "build",
+        "",
+        options(
+            option<int>({"jobs", "j"}, "", "n", 1),
+            option<std::string_view>({"output"}, "", "file"),
+            flag({"verbose"}, ""),
+            list<std::string_view>({"include"}, "", "dir")
+        ),
+        arguments(),
+        [&](const commline::app& app,
+            int j,
+            std::string_view o,
+            bool v,
+            std::vector<std::string_view> i) {
+            jobs = j;
+            output = o;
+            verbose = v;
+            include = i;
+        }
+    ));
+
+    app.use_environment("TEST_");
+    app.use_config(path);
+
+    const char* argv[] = {"tool", "build", "-j", "8"};
+    ASSERT_EQ(0, app.run(4, const_cast<char**>(argv)));
+
+    ::unsetenv("TEST_OUTPUT");
+
+    ASSERT_EQ(8, jobs);
+    ASSERT_EQ("environment", output);
+    ASSERT_TRUE(verbose);
+    ASSERT_EQ((std::vector<std::string_view> {"a", "b"}), include);
+}
+
+TEST_F(ConfigFileTest, FlagDisabledByEnvironment) {
+    write("verbose = true\n");
+
+    ::setenv("TEST_VERBOSE", "0", 1);
+
+    auto verbose = true;
+
+    auto app = application(
+        "tool",
+        "0.0.0",
+        "",
+        options(flag({"verbose"}, "")),
+        arguments(),
+        [&](const commline::app& app, bool v) { verbose = v; }
+    );
+
+    app.use_environment("TEST_");
+    app.use_config(path);
+
+    const char* argv[] = {"tool"};
+    ASSERT_EQ(0, app.run(1, const_cast<char**>(argv)));
+
+    ::unsetenv("TEST_VERBOSE");
+
+    ASSERT_FALSE(verbose);
+}
+
+TEST_F(ConfigFileTest, OwnerMoved) {
+    auto owner = commline::config_ptr(new config_file("tool", path));
+    auto moved = std::move(owner);
+
+    ASSERT_FALSE(owner);
+    ASSERT_TRUE(moved);
+    ASSERT_EQ(std::filesystem::absolute(path), moved->location());
+
+    owner = std::move(moved);
+
+    ASSERT_TRUE(owner);
+    ASSERT_FALSE(moved);
+}
+
+TEST_F(ConfigFileTest, UnknownOption) {
+    write("colour = always\n");
+
+    auto app = application(
+        "tool",
+        "0.0.0",
+        "",
+        options(flag({"color"}, "")),
+        arguments(),
+        [](const commline::app& app, bool color) {
+            FAIL() << "Command should not run.";
+        }
+    );
+
+    app.use_config(path);
+    app.on_error([](std::exception_ptr eptr) {
+#if __cpp_exceptions
+        try {
+            std::rethrow_exception(eptr);
+        }
+        catch (const cli_error& ex) {
+            ASSERT_EQ("unknown option in configuration: colour"s, ex.what());
+        }
+#endif
+    });
+
+    const char* argv[] = {"tool"};
+    ASSERT_EQ(EXIT_FAILURE, app.run(1, const_cast<char**>(argv)));
+}
+
+TEST_F(ConfigFileTest, HelpWithMalformedFile) {
+    write("[build\n");
+
+    auto app = application(
+        "tool",
+        "0.0.0",
+        "",
+        options(),
+        arguments(),
+        [](const commline::app& app) { FAIL() << "Command should not run."; }
+    );
+
+    app.use_config(path);
+    app.on_error([](std::exception_ptr) {});
+
+    auto out = std::ostringstream();
+
+    const char* help[] = {"tool", "--help"};
+    ASSERT_EQ(EXIT_SUCCESS, app.run(2, const_cast<char**>(help), out));
+    ASSERT_EQ(app.help(), out.str());
+
+    const char* argv[] = {"tool"};
+    ASSERT_EQ(EXIT_FAILURE, app.run(1, const_cast<char**>(argv)));
+}
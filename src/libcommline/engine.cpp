@@ -0,0 +1,462 @@
+#include <commline/engine.h>
+#include <commline/storage.h>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+extern char** environ;
+
+namespace {
+    using commline::argv;
+    using commline::expected;
+    using commline::iterator;
+    using commline::option_kind;
+    using commline::option_slot;
+    using commline::option_table;
+    using commline::option_values;
+    using commline::parse_error;
+
+    auto missing_value(std::string_view alias) -> parse_error {
+        return parse_error("missing value for: {}", alias);
+    }
+
+    auto unknown_option(std::string_view alias) -> parse_error {
+        return parse_error("unknown option: {}", alias);
+    }
+
+    // Gives a flag a value, whether or not that value turns it on.
+    auto set_flag(const option_values& values, option_slot target, bool value)
+        -> void {
+        values.flags[target.index] = value;
+        values.flag_set[target.index] = true;
+    }
+
+    // Stores the value of an option that takes one.
+    auto set(
+        const option_table& table,
+        const option_values& values,
+        option_slot target,
+        std::string_view argument
+    ) -> void {
+        if (target.kind == option_kind::single_argument) {
+            values.has_value[target.index] = true;
+            values.values[target.index] = argument;
+        }
+        else {
+            table.formats[target.index].append(
+                values.lists[target.index],
+                argument
+            );
+        }
+    }
+
+    auto handle_long_parameter(
+        const option_table& table,
+        const option_values& values,
+        std::string_view token,
+        iterator& first,
+        iterator last
+    ) -> expected<void> {
+        const auto equals_sign = token.find("=");
+        const auto has_equals_sign = equals_sign != std::string_view::npos;
+        const auto alias =
+            has_equals_sign ? token.substr(0, equals_sign) : token;
+
+        const auto index = table.aliases.find(alias);
+        if (index == commline::alias_table_base::npos) {
+            return unknown_option(alias);
+        }
+
+        const auto target = table.slots[index];
+
+        if (target.kind == option_kind::no_argument) {
+            if (has_equals_sign) {
+                return parse_error(
+                    "option '{}' does not support values",
+                    alias
+                );
+            }
+
+            set_flag(values, target, true);
+            return {};
+        }
+
+        if (has_equals_sign) {
+            if (equals_sign == token.size() - 1) return missing_value(alias);
+            set(table, values, target, token.substr(equals_sign + 1));
+            return {};
+        }
+
+        if (first == last) return missing_value(alias);
+        set(table, values, target, *first++);
+        return {};
+    }
+
+    auto handle_short_parameter(
+        const option_table& table,
+        const option_values& values,
+        std::string_view sequence,
+        iterator& first,
+        iterator last
+    ) -> expected<void> {
+        auto it = sequence.begin();
+        const auto end = sequence.end();
+
+        while (it != end) {
+            const auto alias = std::string_view(it++, 1);
+            const auto index = table.aliases.find(alias.front());
+
+            if (index == commline::alias_table_base::npos) {
+                return unknown_option(alias);
+            }
+
+            const auto target = table.slots[index];
+
+            if (target.kind == option_kind::no_argument) {
+                set_flag(values, target, true);
+                continue;
+            }
+
+            // The parameter requires a value.
+            // The option value is the next arg after the sequence of short
+            // options. If there are more options in the sequence or there are
+            // no more args after the sequence, the value is missing.
+            if (it != end || first == last) return missing_value(alias);
+            set(table, values, target, *first++);
+        }
+
+        return {};
+    }
+
+    auto takes_value(
+        const option_table& table,
+        commline::alias_table_base::index_type index
+    ) -> bool {
+        return index != commline::alias_table_base::npos &&
+               table.slots[index].kind != option_kind::no_argument;
+    }
+
+    // Finds the option whose long alias forms the variable 'name' after the
+    // application's prefix was removed from it. Aliases are mapped the same
+    // way as for the variables that help lists; the mapping cannot be
+    // reversed, so each alias is compared in turn.
+    auto find_prefixed(const option_table& table, std::string_view name)
+        -> commline::alias_table_base::index_type {
+        const auto matches = [name](std::string_view alias) {
+            return alias.size() == name.size() &&
+                   std::ranges::equal(
+                       alias,
+                       name,
+                       {},
+                       commline::environment_character
+                   );
+        };
+
+        for (std::size_t i = 0; i < table.long_names.size(); ++i) {
+            // Options with a variable of their own are only read from it.
+            if (!table.variable_names[i].empty()) continue;
+
+            const auto alias = table.long_names[i];
+            if (!alias.empty() && matches(alias)) {
+                return static_cast<commline::alias_table_base::index_type>(i);
+            }
+        }
+
+        return commline::alias_table_base::npos;
+    }
+
+    // Whether the value of a flag read from outside the command line sets
+    // the flag.
+    auto enabled(std::string_view value) -> bool {
+        return !value.empty() && value != "0" && value != "false";
+    }
+
+    auto is_set(const option_values& values, option_slot target) -> bool {
+        switch (target.kind) {
+            case option_kind::no_argument:
+                return values.flag_set[target.index];
+            case option_kind::single_argument:
+                return values.has_value[target.index];
+            case option_kind::multiple_arguments:
+                return !values.lists[target.index].empty();
+        }
+
+        return false;
+    }
+
+    // Sets 'target' from 'value' unless the command line already set it.
+    auto set_default(
+        const option_table& table,
+        const option_values& values,
+        option_slot target,
+        std::string_view value
+    ) -> void {
+        if (is_set(values, target)) return;
+
+        if (target.kind == option_kind::no_argument) {
+            set_flag(values, target, enabled(value));
+        }
+        else set(table, values, target, value);
+    }
+
+    auto missing_argument(std::string_view name) -> parse_error {
+        return parse_error("not enough arguments: missing value for: {}", name);
+    }
+
+    auto walk_options(
+        const option_table& table,
+        const option_values& values,
+        argv args,
+        std::pmr::vector<std::string_view>& positional
+    ) -> expected<void> {
+        constexpr auto long_opt = std::string_view("--");
+        constexpr auto short_opt = std::string_view("-");
+
+        auto first = args.begin();
+        const auto last = args.end();
+
+        positional.reserve(positional.size() + args.size());
+
+        while (first != last) {
+            const auto current = std::string_view(*(first++));
+            auto status = expected<void>();
+
+            // A '--' by itself signifies the end of options.
+            // Everything that follows is an argument.
+            if (current == long_opt) {
+                while (first != last) positional.emplace_back(*(first++));
+            }
+            // A '-' by itself is treated as an argument.
+            else if (current == short_opt) positional.push_back(current);
+            else if (current.starts_with(long_opt))
+                status = handle_long_parameter(
+                    table,
+                    values,
+                    current.substr(long_opt.size()),
+                    first,
+                    last
+                );
+            else if (current.starts_with(short_opt))
+                status = handle_short_parameter(
+                    table,
+                    values,
+                    current.substr(short_opt.size()),
+                    first,
+                    last
+                );
+            else positional.push_back(current);
+
+            if (!status) return status;
+        }
+
+        return {};
+    }
+}
+
+namespace commline {
+    auto reset_options(
+        const option_values& values,
+        std::pmr::memory_resource* resource
+    ) -> void {
+        std::ranges::fill(values.flags, false);
+        std::ranges::fill(values.flag_set, false);
+        std::ranges::fill(values.has_value, false);
+
+        // Assignment would keep the old memory resource.
+        for (auto& items : values.lists) {
+            std::destroy_at(&items);
+            std::construct_at(&items, resource);
+        }
+    }
+
+    auto parse_options(
+        const option_table& table,
+        const option_values& values,
+        argv args,
+        std::pmr::vector<std::string_view>& positional
+    ) -> expected<void> {
+        auto status = walk_options(table, values, args, positional);
+
+        // Values may be allocated from a fixed buffer, which a long enough
+        // command line exhausts.
+        const auto* const fixed = dynamic_cast<const fixed_buffer_resource*>(
+            positional.get_allocator().resource()
+        );
+
+        if (fixed && fixed->exhausted()) {
+            return parse_error("argument storage exhausted");
+        }
+
+        return status;
+    }
+
+    auto read_environment(
+        const option_table& table,
+        const option_values& values,
+        std::string_view prefix
+    ) -> void {
+        if (table.variables.empty() && prefix.empty()) return;
+
+        for (auto** variable = environ; *variable; ++variable) {
+            const auto entry = std::string_view(*variable);
+
+            const auto equals_sign = entry.find('=');
+            if (equals_sign == std::string_view::npos) continue;
+
+            const auto name = entry.substr(0, equals_sign);
+            auto index = table.variables.find(name);
+
+            if (index == alias_table_base::npos && !prefix.empty() &&
+                name.starts_with(prefix)) {
+                index = find_prefixed(table, name.substr(prefix.size()));
+            }
+
+            if (index == alias_table_base::npos) continue;
+
+            set_default(
+                table,
+                values,
+                table.slots[index],
+                entry.substr(equals_sign + 1)
+            );
+        }
+    }
+
+    auto read_config(
+        const option_table& table,
+        const option_values& values,
+        const config_section& section
+    ) -> expected<void> {
+        // Whether each entry was set before the configuration was read, in
+        // which case the configuration does not apply to it.
+        enum class origin : std::uint8_t { unknown, config, earlier };
+
+        if (section.empty()) return {};
+
+        auto origins = std::vector<origin>(table.slots.size());
+
+        for (std::uint64_t i = 0; i < section.size(); ++i) {
+            const auto [key, value] = section.at(i);
+            const auto index = table.aliases.find(key);
+
+            // The help flag, always the first entry, cannot be configured.
+            if (index == alias_table_base::npos || index == 0) {
+                return parse_error(
+                    "unknown option in configuration: {}",
+                    key
+                );
+            }
+
+            const auto target = table.slots[index];
+            auto& from = origins[index];
+
+            if (from == origin::unknown) {
+                from = is_set(values, target) ? origin::earlier
+                                              : origin::config;
+            }
+
+            if (from == origin::earlier) continue;
+
+            if (target.kind == option_kind::no_argument) {
+                set_flag(values, target, enabled(value));
+            }
+            else set(table, values, target, value);
+        }
+
+        return {};
+    }
+
+    auto scan_options(const option_table& table, argv args)
+        -> completion_point {
+        auto point = completion_point();
+
+        auto first = args.begin();
+        const auto last = args.end();
+
+        while (first != last) {
+            const auto current = std::string_view(*(first++));
+
+            if (point.options_ended || current == "-" ||
+                !current.starts_with('-')) {
+                ++point.argument;
+                continue;
+            }
+
+            if (current == "--") {
+                point.options_ended = true;
+                continue;
+            }
+
+            auto index = alias_table_base::npos;
+
+            // Only the last option in a sequence of short options may take
+            // the next word as its value.
+            if (!current.starts_with("--")) {
+                index = table.aliases.find(current.back());
+            }
+            else if (current.find('=') == std::string_view::npos) {
+                index = table.aliases.find(current.substr(2));
+            }
+
+            if (!takes_value(table, index)) continue;
+
+            if (first == last) point.option = index;
+            else ++first;
+        }
+
+        return point;
+    }
+
+    auto parse_arguments(
+        std::span<const argument_descriptor> arguments,
+        std::span<const std::string_view> args,
+        std::span<std::span<const std::string_view>> values
+    ) -> expected<void> {
+        auto args_begin = args.begin();
+        auto args_end = args.end();
+
+        auto begin = std::size_t(0);
+        auto end = arguments.size();
+
+        // Takes the next word from the front or, once a variadic argument
+        // has been reached, from the back. Returns false if a required
+        // argument is left without one.
+        const auto take = [&](std::size_t index, bool reverse) {
+            if (args_begin == args_end) {
+                values[index] = {};
+                return arguments[index].kind != argument_kind::required;
+            }
+
+            if (reverse) values[index] = std::span(--args_end, 1);
+            else values[index] = std::span(args_begin++, 1);
+
+            return true;
+        };
+
+        while (begin != end) {
+            const auto index = begin++;
+
+            if (arguments[index].kind != argument_kind::variadic) {
+                if (!take(index, false)) {
+                    return missing_argument(arguments[index].name);
+                }
+
+                continue;
+            }
+
+            while (begin != end &&
+                   arguments[end - 1].kind != argument_kind::variadic) {
+                if (!take(--end, true)) {
+                    return missing_argument(arguments[end].name);
+                }
+            }
+
+            values[index] = std::span(args_begin, args_end);
+            args_begin = args_end;
+        }
+
+        if (args_begin != args_end) return parse_error("too many arguments");
+        return {};
+    }
+}
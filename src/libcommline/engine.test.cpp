@@ -0,0 +1,164 @@
+#include "test.h"
+
+#include <commline/engine.h>
+
+#include <vector>
+
+using commline::alias_table;
+using commline::argument_descriptor;
+using commline::argument_kind;
+using commline::list_format;
+using commline::option_kind;
+using commline::option_slot;
+
+using entry = alias_table<0>::entry;
+
+namespace {
+    // Index 0 is reserved for 'help' in an option schema; these tables
+    // follow the same layout.
+    const auto entries = std::vector<entry> {
+        {"help", 0},
+        {"verbose", 1},
+        {"v", 1},
+        {"output", 2},
+        {"o", 2},
+        {"include", 3},
+        {"I", 3}};
+
+    const auto aliases = alias_table<7>(entries);
+
+    constexpr auto slots = std::array {
+        option_slot {option_kind::no_argument, 0},
+        option_slot {option_kind::no_argument, 1},
+        option_slot {option_kind::single_argument, 0},
+        option_slot {option_kind::multiple_arguments, 0}};
+
+    constexpr auto formats = std::array {list_format {",", true}};
+
+    const auto variables = alias_table<0>();
+}
+
+class EngineTest : public testing::Test {
+protected:
+    const commline::option_table table {
+        aliases.lookup(),
+        slots,
+        formats,
+        variables.lookup(),
+        {},
+        {}};
+
+    std::array<bool, 2> flags;
+    std::array<bool, 2> flag_set;
+    std::array<bool, 1> has_value;
+    std::array<std::string_view, 1> values;
+    std::array<std::pmr::vector<std::string_view>, 1> lists;
+
+    std::pmr::vector<std::string_view> positional;
+
+    auto state() -> commline::option_values {
+        return {flags, flag_set, has_value, values, lists};
+    }
+
+    auto parse(std::vector<const char*> words) -> commline::expected<void> {
+        commline::reset_options(state(), std::pmr::get_default_resource());
+        positional.clear();
+
+        return commline::parse_options(
+            table,
+            state(),
+            commline::argv(words),
+            positional
+        );
+    }
+};
+
+TEST_F(EngineTest, Options) {
+    ASSERT_TRUE(
+        parse({"-v", "--output=file", "a", "--include", "x,y", "-I", "z", "b"})
+    );
+
+    ASSERT_FALSE(flags[0]);
+    ASSERT_TRUE(flags[1]);
+    ASSERT_TRUE(has_value[0]);
+    ASSERT_EQ("file", values[0]);
+    ASSERT_EQ((std::vector {"x"sv, "y"sv, "z"sv}),
+              std::vector(lists[0].begin(), lists[0].end()));
+    ASSERT_EQ((std::vector {"a"sv, "b"sv}),
+              std::vector(positional.begin(), positional.end()));
+}
+
+TEST_F(EngineTest, ResetClearsState) {
+    ASSERT_TRUE(parse({"-v", "-o", "file"}));
+    ASSERT_TRUE(parse({}));
+
+    ASSERT_FALSE(flags[1]);
+    ASSERT_FALSE(has_value[0]);
+    ASSERT_TRUE(lists[0].empty());
+}
+
+TEST_F(EngineTest, UnknownOption) {
+    const auto result = parse({"--quiet"});
+
+    ASSERT_FALSE(result);
+    ASSERT_EQ("unknown option: quiet", result.error().message);
+}
+
+TEST_F(EngineTest, ArgumentsAfterVariadic) {
+    constexpr auto arguments = std::array {
+        argument_descriptor {argument_kind::required, "first"},
+        argument_descriptor {argument_kind::variadic, "middle"},
+        argument_descriptor {argument_kind::required, "last"},
+        argument_descriptor {argument_kind::optional, "extra"}};
+
+    constexpr auto args = std::array {"a"sv, "b"sv, "c"sv, "d"sv, "e"sv};
+    auto values = std::array<std::span<const std::string_view>, 4>();
+
+    ASSERT_TRUE(commline::parse_arguments(arguments, args, values));
+
+    ASSERT_EQ(1, values[0].size());
+    ASSERT_EQ("a", values[0].front());
+    ASSERT_EQ((std::vector {"b"sv, "c"sv}),
+              std::vector(values[1].begin(), values[1].end()));
+    ASSERT_EQ("d", values[2].front());
+    ASSERT_EQ("e", values[3].front());
+}
+
+TEST_F(EngineTest, OptionalArgumentAbsent) {
+    constexpr auto arguments = std::array {
+        argument_descriptor {argument_kind::required, "first"},
+        argument_descriptor {argument_kind::optional, "second"}};
+
+    constexpr auto args = std::array {"a"sv};
+    auto values = std::array<std::span<const std::string_view>, 2>();
+
+    ASSERT_TRUE(commline::parse_arguments(arguments, args, values));
+
+    ASSERT_EQ("a", values[0].front());
+    ASSERT_TRUE(values[1].empty());
+}
+
+TEST_F(EngineTest, ArgumentErrors) {
+    constexpr auto arguments = std::array {
+        argument_descriptor {argument_kind::required, "first"},
+        argument_descriptor {argument_kind::variadic, "middle"},
+        argument_descriptor {argument_kind::required, "last"}};
+
+    constexpr auto args = std::array {"a"sv};
+    auto values = std::array<std::span<const std::string_view>, 3>();
+
+    const auto missing = commline::parse_arguments(arguments, args, values);
+    ASSERT_FALSE(missing);
+    ASSERT_EQ(
+        "not enough arguments: missing value for: last",
+        missing.error().message
+    );
+
+    const auto extra = commline::parse_arguments(
+        std::span(arguments).first(1),
+        std::array {"a"sv, "b"sv},
+        std::span(values).first(1)
+    );
+    ASSERT_FALSE(extra);
+    ASSERT_EQ("too many arguments", extra.error().message);
+}
@@ -0,0 +1,54 @@
+#include <commline/expected.h>
+
+#include <cstdlib>
+#include <fmt/core.h>
+#include <stdexcept>
+
+namespace commline {
+    auto print_error(std::exception_ptr eptr) -> void {
+#if __cpp_exceptions
+        try {
+            if (eptr) std::rethrow_exception(eptr);
+        }
+        catch (const std::exception& ex) {
+            fmt::print(stderr, "{}\n", ex.what());
+        }
+#else
+        // The exception cannot be inspected without rethrowing it.
+        if (eptr) fmt::print(stderr, "unknown error\n");
+#endif
+    }
+
+    auto throw_length_error(const char* what) -> void {
+#if __cpp_exceptions
+        throw std::length_error(what);
+#else
+        fmt::print(stderr, "{}\n", what);
+        std::abort();
+#endif
+    }
+
+    auto parse_error::exception() const -> std::exception_ptr {
+        if (code) {
+            return std::make_exception_ptr(std::system_error(code, message));
+        }
+
+        return std::make_exception_ptr(cli_error("{}", message));
+    }
+
+    auto parse_error::print() const -> void {
+        // As 'print_error' prints the exception.
+        if (code) fmt::print(stderr, "{}: {}\n", message, code.message());
+        else fmt::print(stderr, "{}\n", message);
+    }
+
+    auto parse_error::raise() const -> void {
+#if __cpp_exceptions
+        if (code) throw std::system_error(code, message);
+        throw cli_error("{}", message);
+#else
+        print();
+        std::abort();
+#endif
+    }
+}
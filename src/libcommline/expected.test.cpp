@@ -0,0 +1,201 @@
+// Built with '-fno-exceptions': every error here must be returned.
+
+#include "test.h"
+
+#include <commline/application.h>
+
+#include <cerrno>
+#include <cstdlib>
+#include <memory_resource>
+#include <unistd.h>
+
+using commline::application;
+using commline::arguments;
+using commline::expected;
+using commline::list;
+using commline::option;
+using commline::option_list;
+using commline::options;
+using commline::parser;
+using commline::positional_arguments;
+using commline::required;
+using commline::variadic;
+
+namespace {
+    template <typename T>
+    auto error(const expected<T>& result) -> std::string {
+        if (result) return {};
+        return result.error().message;
+    }
+
+    auto errors = 0;
+
+    auto count_error(std::exception_ptr eptr) -> void { ++errors; }
+}
+
+TEST(ExpectedTest, Conversion) {
+    ASSERT_EQ(-12, *parser<int>::try_parse("-12"));
+    ASSERT_EQ(
+        "could not convert argument 'x' to integer",
+        error(parser<int>::try_parse("x"))
+    );
+    ASSERT_EQ(
+        "argument '200' is outside the range of -128 and 127",
+        error(parser<std::int8_t>::try_parse("200"))
+    );
+    ASSERT_EQ(
+        "could not convert argument '1.5x' to a floating-point number",
+        error(parser<double>::try_parse("1.5x"))
+    );
+    ASSERT_EQ(
+        "could not convert argument 'y' to integer",
+        error(parser<std::optional<int>>::try_parse("y"))
+    );
+}
+
+TEST(ExpectedTest, OptionErrors) {
+    auto resource = std::pmr::monotonic_buffer_resource();
+    auto opts = option_list(options(
+        option<int>({"jobs", "j"}, "", "n"),
+        list<int>({"level"}, "", "n", ",")
+    ));
+
+    const auto failure = [&](std::vector<const char*> words) {
+        return error(opts.try_parse(commline::argv(words), resource));
+    };
+
+    ASSERT_EQ("unknown option: quiet", failure({"--quiet"}));
+    ASSERT_EQ("unknown option: q", failure({"-q"}));
+    ASSERT_EQ("missing value for: jobs", failure({"--jobs"}));
+    ASSERT_EQ("missing value for: j", failure({"-j"}));
+    ASSERT_EQ("unknown option: {}", failure({"--{}"}));
+
+    constexpr auto invalid = std::array {"-j", "4", "--level=1,x"};
+    ASSERT_TRUE(opts.try_parse(invalid, resource));
+    ASSERT_EQ(
+        "could not convert argument 'x' to integer",
+        error(opts.try_extract())
+    );
+
+    constexpr auto valid = std::array {"-j", "4", "--level=1,2"};
+    ASSERT_TRUE(opts.try_parse(valid, resource));
+    const auto values = opts.try_extract();
+    ASSERT_TRUE(values);
+    ASSERT_EQ(4, std::get<0>(*values));
+    ASSERT_EQ((std::vector {1, 2}), std::get<1>(*values));
+}
+
+TEST(ExpectedTest, ArgumentErrors) {
+    auto args = positional_arguments(
+        arguments(required<int>("first"), variadic<int>("rest"))
+    );
+
+    ASSERT_EQ(
+        "not enough arguments: missing value for: first",
+        error(args.try_parse({}))
+    );
+
+    constexpr auto words = std::array {"1"sv, "2"sv, "z"sv};
+    ASSERT_EQ(
+        "could not convert argument 'z' to integer",
+        error(args.try_parse(words))
+    );
+
+    auto single = positional_arguments(arguments(required<int>("number")));
+    constexpr auto extra = std::array {"1"sv, "2"sv};
+    ASSERT_EQ("too many arguments", error(single.try_parse(extra)));
+}
+
+TEST(ExpectedTest, ExitStatus) {
+    auto app = application(
+        "tool",
+        "0.0.0",
+        "",
+        options(),
+        arguments(required<int>("status")),
+        [](const commline::app& app, int status) { return status; }
+    );
+
+    app.on_error(&count_error);
+    errors = 0;
+
+    const char* success[] = {"tool", "3"};
+    ASSERT_EQ(3, app.run(2, const_cast<char**>(success)));
+    ASSERT_EQ(0, errors);
+
+    const char* failure[] = {"tool", "three"};
+    ASSERT_EQ(EXIT_FAILURE, app.run(2, const_cast<char**>(failure)));
+    ASSERT_EQ(1, errors);
+}
+
+TEST(ExpectedTest, HiddenCommandErrors) {
+    constexpr auto index = std::array {"3", "--", "tool", "word"};
+    ASSERT_EQ(
+        "word index out of range: 3",
+        error(commline::completion_request::try_parse(index))
+    );
+
+    constexpr auto usage = std::array {"1", "tool"};
+    ASSERT_EQ(
+        "usage: __complete <index> -- <words>...",
+        error(commline::completion_request::try_parse(usage))
+    );
+
+    ASSERT_EQ(
+        "unknown schema format: ksh",
+        error(commline::try_parse_schema_format("ksh"))
+    );
+
+    auto app = application(
+        "tool",
+        "0.0.0",
+        "",
+        options(),
+        arguments(),
+        [](const commline::app& app) {}
+    );
+
+    app.on_error(&count_error);
+    errors = 0;
+
+    const char* complete[] = {"tool", "__complete", "x", "--", "tool"};
+    ASSERT_EQ(EXIT_FAILURE, app.run(5, const_cast<char**>(complete)));
+    ASSERT_EQ(1, errors);
+
+    const char* schema[] = {"tool", "__schema", "ksh"};
+    ASSERT_EQ(EXIT_FAILURE, app.run(3, const_cast<char**>(schema)));
+    ASSERT_EQ(2, errors);
+}
+
+TEST(ExpectedTest, FileErrors) {
+    auto app = application(
+        "tool",
+        "0.0.0",
+        "",
+        options(),
+        arguments(variadic<std::string_view>("words")),
+        [](const commline::app& app, std::vector<std::string_view> words) {}
+    );
+
+    app.on_error(&count_error);
+    app.expand_response_files(commline::response_format::lines);
+    errors = 0;
+
+    const char* missing[] = {"tool", "@/nonexistent/commline"};
+    ASSERT_EQ(ENOENT, app.run(2, const_cast<char**>(missing)));
+    ASSERT_EQ(1, errors);
+
+    char path[] = "/tmp/commline.test.XXXXXX";
+    const auto fd = ::mkstemp(path);
+    ASSERT_NE(-1, fd);
+    ASSERT_EQ(7, ::write(fd, "[words\n", 7));
+    ::close(fd);
+
+    app.use_config(path);
+
+    const char* words[] = {"tool", "word"};
+    ASSERT_EQ(EXIT_FAILURE, app.run(2, const_cast<char**>(words)));
+    ASSERT_EQ(2, errors);
+
+    ::unlink(path);
+}
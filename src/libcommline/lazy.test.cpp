@@ -0,0 +1,109 @@
+#include "test.h"
+
+#include <commline/command.h>
+#include <commline/lazy.h>
+
+using commline::arguments;
+using commline::command;
+using commline::flag;
+using commline::lazy;
+using commline::option;
+using commline::options;
+using commline::required;
+
+namespace {
+    struct counted {
+        static inline auto conversions = 0;
+
+        int value = 0;
+    };
+}
+
+template <>
+struct commline::parser<counted> {
+    static auto parse(std::string_view argument) -> counted {
+        ++counted::conversions;
+        return {parser<int>::parse(argument)};
+    }
+};
+
+class LazyTest : public testing::Test {
+protected:
+    static constexpr auto app_info =
+        commline::app {"testapp", "0.0.0", "Unit tests.", "/app"};
+
+    std::ostringstream out;
+
+    auto SetUp() -> void override { counted::conversions = 0; }
+};
+
+TEST_F(LazyTest, ConvertOnRead) {
+    const auto value = commline::parser<lazy<counted>>::parse("42");
+
+    ASSERT_FALSE(value.converted());
+    ASSERT_EQ(0, counted::conversions);
+
+    ASSERT_EQ(42, value->value);
+    ASSERT_EQ(42, (*value).value);
+    ASSERT_TRUE(value.converted());
+    ASSERT_EQ(1, counted::conversions);
+}
+
+TEST_F(LazyTest, Default) {
+    const auto empty = lazy<int>();
+    ASSERT_FALSE(empty.raw().has_value());
+    ASSERT_EQ(0, *empty);
+
+    const auto value = lazy<int>(7);
+    ASSERT_TRUE(value.converted());
+    ASSERT_EQ(7, *value);
+}
+
+TEST_F(LazyTest, UnreadValuesAreNotConverted) {
+    constexpr auto args = std::array {"--skip", "--count", "5", "10"};
+
+    command(
+        "name",
+        "",
+        options(
+            flag({"skip"}, ""),
+            option<lazy<counted>>({"count"}, "", "n")
+        ),
+        arguments(required<lazy<counted>>("number")),
+        [](const commline::app& app,
+           bool skip,
+           const lazy<counted>& count,
+           const lazy<counted>& number) {
+            ASSERT_TRUE(skip);
+            ASSERT_EQ("5", count.raw());
+            ASSERT_EQ("10", number.raw());
+        }
+    )->execute(app_info, args, out);
+
+    ASSERT_EQ(0, counted::conversions);
+}
+
+TEST_F(LazyTest, InvalidValueReportedOnRead) {
+    const auto value = commline::parser<lazy<int>>::parse("abc");
+
+    const auto result = value.try_get();
+    ASSERT_FALSE(result);
+    ASSERT_EQ(
+        "could not convert argument 'abc' to integer",
+        result.error().message
+    );
+    ASSERT_FALSE(value.converted());
+
+#if __cpp_exceptions
+    ASSERT_THROW(value.get(), commline::cli_error);
+#endif
+}
+
+TEST_F(LazyTest, TryGet) {
+    const auto value = commline::parser<lazy<int>>::parse("42");
+
+    const auto result = value.try_get();
+    ASSERT_TRUE(result);
+    ASSERT_EQ(42, result->get());
+    ASSERT_EQ(&value.get(), &result->get());
+}
@@ -0,0 +1,176 @@
+#include "bench.h"
+
+#include <commline/option_list.h>
+
+#include <string>
+#include <vector>
+
+using commline::flag;
+using commline::list;
+using commline::option;
+
+namespace {
+    // libstdc++ reaches its default template depth for tuples of around
+    // 300 elements, so wider option sets cannot be declared.
+    constexpr auto max_width = std::size_t(256);
+
+    // Number of option words on each benchmarked command line.
+    constexpr auto words = std::size_t(64);
+
+    auto names() -> const std::vector<std::string>& {
+        static const auto result = [] {
+            auto names = std::vector<std::string>();
+            names.reserve(max_width);
+
+            for (std::size_t i = 0; i < max_width; ++i) {
+                names.push_back("option-" + std::to_string(i));
+            }
+
+            return names;
+        }();
+
+        return result;
+    }
+
+    // Every fourth option is a flag and every fourth a list; the rest take
+    // a single value.
+    template <std::size_t I>
+    auto make_option() {
+        const auto name = std::string_view(names()[I]);
+
+        if constexpr (I % 4 == 0) return flag({name}, "A flag.");
+        else if constexpr (I % 4 == 3) {
+            return list<std::string_view>({name}, "A list.", "item");
+        }
+        else {
+            return option<std::string_view>({name}, "An option.", "value");
+        }
+    }
+
+    template <std::size_t... I>
+    auto make_options(std::index_sequence<I...>) {
+        return commline::options(make_option<I>()...);
+    }
+
+    template <std::size_t Width>
+    auto make_schema() {
+        static_assert(Width <= max_width);
+
+        return commline::option_schema(
+            make_options(std::make_index_sequence<Width>())
+        );
+    }
+
+    // Owns the strings of a command line and the pointers to them.
+    class command_line {
+        std::vector<std::string> strings;
+        std::vector<const char*> pointers;
+    public:
+        command_line(std::vector<std::string>&& strings) :
+            strings(std::move(strings)) {
+            pointers.reserve(this->strings.size());
+
+            for (const auto& string : this->strings) {
+                pointers.push_back(string.c_str());
+            }
+        }
+
+        auto args() const -> commline::argv { return pointers; }
+    };
+
+    // Options spread across the whole set, so that a parse reaches the
+    // state of many options. Long options with values use the
+    // '--name=value' form.
+    auto long_options(std::size_t width) -> command_line {
+        auto result = std::vector<std::string>();
+        result.reserve(words);
+
+        for (std::size_t i = 0; i < words; ++i) {
+            const auto index = (i * 101) % width;
+
+            result.push_back("--" + names()[index]);
+            if (index % 4 != 0) result.back().append("=value");
+        }
+
+        return result;
+    }
+
+    template <typename Schema>
+    auto parse(
+        benchmark::State& state,
+        const Schema& schema,
+        const command_line& line,
+        std::size_t items
+    ) -> void {
+        const auto args = line.args();
+
+        auto counter = cache_misses();
+        counter.resume();
+
+        for (auto _ : state) {
+            auto opts = commline::option_list(schema);
+            auto positional = opts.parse(args);
+
+            benchmark::DoNotOptimize(opts);
+            benchmark::DoNotOptimize(positional);
+        }
+
+        counter.report(state);
+
+        using list_type = decltype(commline::option_list(schema));
+        state.counters["state_bytes"] = sizeof(list_type);
+        state.SetItemsProcessed(state.iterations() * items);
+    }
+
+    template <std::size_t Width>
+    auto parse_long(benchmark::State& state) -> void {
+        const auto schema = make_schema<Width>();
+        parse(state, schema, long_options(Width), words);
+    }
+
+    // Clusters of single-character flags, as in '-abc'.
+    auto parse_short_cluster(benchmark::State& state) -> void {
+        const auto schema = commline::option_schema(commline::options(
+            flag({"a"}, ""),
+            flag({"b"}, ""),
+            flag({"c"}, ""),
+            flag({"d"}, ""),
+            flag({"e"}, ""),
+            flag({"f"}, ""),
+            flag({"g"}, ""),
+            flag({"h"}, ""),
+            option<std::string_view>({"o"}, "", "")
+        ));
+
+        const auto cluster_size = static_cast<std::size_t>(state.range(0));
+        const auto cluster = "-" + std::string("abcdefgh").substr(
+                                       0,
+                                       cluster_size
+                                   );
+
+        auto strings = std::vector<std::string>(words, cluster);
+        strings.back().append("o");
+        strings.emplace_back("value");
+
+        parse(state, schema, std::move(strings), words * cluster_size);
+    }
+
+    // Positional arguments with no options among them.
+    auto parse_positionals(benchmark::State& state) -> void {
+        const auto schema = make_schema<8>();
+
+        const auto count = static_cast<std::size_t>(state.range(0));
+        auto strings = std::vector<std::string>(count, "argument");
+
+        parse(state, schema, std::move(strings), count);
+    }
+}
+
+BENCHMARK_TEMPLATE(parse_long, 1);
+BENCHMARK_TEMPLATE(parse_long, 8);
+BENCHMARK_TEMPLATE(parse_long, 64);
+BENCHMARK_TEMPLATE(parse_long, 256);
+
+BENCHMARK(parse_short_cluster)->DenseRange(1, 8, 7);
+
+BENCHMARK(parse_positionals)->RangeMultiplier(10)->Range(10, 100'000);
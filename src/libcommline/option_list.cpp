@@ -0,0 +1,84 @@
+#include <commline/option_list.h>
+
+namespace commline {
+    auto print_options(
+        std::ostream& out,
+        std::span<const option_entry> entries,
+        std::string_view prefix
+    ) -> void {
+        if (entries.size() < 2) return;
+
+        print::header(out, "Options");
+
+        for (const auto& entry : entries.subspan(1)) {
+            std::visit(
+                [&](const auto* opt) { opt->print_help(out, prefix); },
+                entry
+            );
+        }
+    }
+
+    auto describe_options(
+        std::span<const option_entry> entries,
+        std::vector<option_info>& options
+    ) -> void {
+        options.reserve(entries.size());
+
+        for (const auto& entry : entries) {
+            std::visit(
+                [&options](const auto* opt) {
+                    options.push_back(opt->describe());
+                },
+                entry
+            );
+        }
+    }
+
+    auto complete_options(
+        const option_table& table,
+        std::span<const option_entry> entries,
+        completion& result
+    ) -> void {
+        const auto word = result.prefix;
+        const auto equals_sign = word.find('=');
+        const auto has_equals_sign = equals_sign != std::string_view::npos;
+
+        if (word.starts_with("--") && has_equals_sign) {
+            const auto index =
+                table.aliases.find(word.substr(2, equals_sign - 2));
+
+            if (index != alias_table_base::npos &&
+                table.slots[index].kind != option_kind::no_argument) {
+                result.narrow(equals_sign + 1);
+                complete_option(entries[index], result);
+            }
+
+            return;
+        }
+
+        for (const auto& entry : entries) {
+            std::visit(
+                [&result](const auto* opt) {
+                    for (const auto alias : opt->aliases) {
+                        auto name = std::string(alias.size() == 1 ? "-" : "--");
+                        name.append(alias);
+                        result.add(name);
+                    }
+                },
+                entry
+            );
+        }
+    }
+
+    auto complete_option(const option_entry& entry, completion& result)
+        -> void {
+        std::visit(
+            overloaded {
+                [](const no_argument*) {},
+                [&result](const auto* opt) {
+                    result.provide(opt->provider, opt->aliases.front());
+                }},
+            entry
+        );
+    }
+}
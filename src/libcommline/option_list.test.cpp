@@ -3,7 +3,23 @@
 #include <commline/option_list.h>
 
 #include <algorithm>
+#include <cstdlib>
 #include <functional>
+#include <iterator>
+
+namespace {
+    // Sets an environment variable for the lifetime of the object.
+    class scoped_variable {
+        std::string name;
+    public:
+        scoped_variable(std::string_view name, const char* value) :
+            name(name) {
+            setenv(this->name.c_str(), value, 1);
+        }
+
+        ~scoped_variable() { unsetenv(name.c_str()); }
+    };
+}
 
 class ParameterListTest : public testing::Test {
 protected:
@@ -23,6 +39,20 @@ protected:
         argv = args;
         arguments = list.parse(argv);
     }
+
+    // The message of the error parsing 'args', or an empty string if they
+    // parsed.
+    template <typename OptionList>
+    auto error(OptionList& list, std::initializer_list<const char*> args)
+        -> std::string {
+        argv = args;
+
+        const auto result =
+            list.try_parse(argv, *std::pmr::get_default_resource());
+
+        if (result) return {};
+        return result.error().message;
+    }
 };
 
 TEST_F(ParameterListTest, NoOptions) {
@@ -141,6 +171,7 @@ TEST_F(ParameterListTest, LongOptionEquals) {
 TEST_F(ParameterListTest, LongOptionEqualsMissingValue) {
     auto list = options(commline::option<std::string_view>({"name"}, "", ""));
 
+#if __cpp_exceptions
     try {
         parse(list, {"--name="});
         FAIL() << "option value missing";
@@ -148,11 +179,15 @@ TEST_F(ParameterListTest, LongOptionEqualsMissingValue) {
     catch (const commline::cli_error& ex) {
         ASSERT_EQ("missing value for: name"s, ex.what());
     }
+#endif
+
+    ASSERT_EQ("missing value for: name", error(list, {"--name="}));
 }
 
 TEST_F(ParameterListTest, FlagEquals) {
     auto list = options(commline::flag({"version"}, ""));
 
+#if __cpp_exceptions
     try {
         parse(list, {"--version=foo"});
         FAIL() << "flag given a value";
@@ -160,6 +195,12 @@ TEST_F(ParameterListTest, FlagEquals) {
     catch (const commline::cli_error& ex) {
         ASSERT_EQ("option 'version' does not support values"s, ex.what());
     }
+#endif
+
+    ASSERT_EQ(
+        "option 'version' does not support values",
+        error(list, {"--version=foo"})
+    );
 }
 
 TEST_F(ParameterListTest, ValueOptionShort) {
@@ -175,6 +216,7 @@ TEST_F(ParameterListTest, ValueOptionShort) {
 TEST_F(ParameterListTest, UnknownOption) {
     auto list = options(commline::flag({"hello", "h"}, ""));
 
+#if __cpp_exceptions
     try {
         parse(list, {"--version"});
         FAIL() << "Option 'version' does not exist.";
@@ -190,6 +232,10 @@ TEST_F(ParameterListTest, UnknownOption) {
     catch (const commline::cli_error& ex) {
         ASSERT_EQ("unknown option: e"s, ex.what());
     }
+#endif
+
+    ASSERT_EQ("unknown option: version", error(list, {"--version"}));
+    ASSERT_EQ("unknown option: e", error(list, {"-hello"}));
 }
 
 TEST_F(ParameterListTest, MissingValue) {
@@ -198,6 +244,7 @@ TEST_F(ParameterListTest, MissingValue) {
         commline::flag({"v"}, "")
     );
 
+#if __cpp_exceptions
     try {
         parse(list, {"--name"});
         FAIL() << "No name was given.";
@@ -221,6 +268,11 @@ TEST_F(ParameterListTest, MissingValue) {
     catch (const commline::cli_error& ex) {
         ASSERT_EQ("missing value for: n"s, ex.what());
     }
+#endif
+
+    ASSERT_EQ("missing value for: name", error(list, {"--name"}));
+    ASSERT_EQ("missing value for: n", error(list, {"-n"}));
+    ASSERT_EQ("missing value for: n", error(list, {"-nv", "hello"}));
 }
 
 TEST_F(ParameterListTest, SequenceValue) {
@@ -271,6 +323,7 @@ TEST_F(ParameterListTest, ListMany) {
 TEST_F(ParameterListTest, ListNoValue) {
     auto list = options(commline::list<std::string_view>({"include"}, "", ""));
 
+#if __cpp_exceptions
     try {
         parse(list, {"--include"});
         FAIL() << "No value provided";
@@ -278,6 +331,9 @@ TEST_F(ParameterListTest, ListNoValue) {
     catch (const commline::cli_error& ex) {
         ASSERT_EQ("missing value for: include"s, ex.what());
     }
+#endif
+
+    ASSERT_EQ("missing value for: include", error(list, {"--include"}));
 }
 
 TEST_F(ParameterListTest, ListDelimiter) {
@@ -367,3 +423,145 @@ TEST_F(ParameterListTest, ListDelimiterKeepEmptyTrailing) {
     EXPECT_EQ("two", result.at(1));
     EXPECT_EQ("", result.at(2));
 }
+
+TEST_F(ParameterListTest, ListView) {
+    auto list = options(commline::list_view<int>({"numbers"}, "", "", ","));
+
+    parse(list, {"--numbers=10", "--numbers=100,-8,40"});
+    const auto result = list.get<0>();
+
+    ASSERT_EQ(4, result.size());
+
+    auto values = std::vector<int>();
+    std::ranges::copy(result, std::back_inserter(values));
+
+    ASSERT_EQ((std::vector<int> {10, 100, -8, 40}), values);
+}
+
+TEST_F(ParameterListTest, InterleavedKinds) {
+    auto list = options(
+        commline::list<std::string_view>({"include", "I"}, "", ""),
+        commline::flag({"verbose", "v"}, ""),
+        commline::option<std::string_view>({"output", "o"}, "", ""),
+        commline::flag({"quiet", "q"}, ""),
+        commline::list<int>({"level", "l"}, "", "", ","),
+        commline::option<int>({"jobs", "j"}, "", "")
+    );
+
+    parse(
+        list,
+        {"-I", "a", "--output=out", "-vj", "4", "--level=1,2", "-I", "b", "x"}
+    );
+
+    ASSERT_EQ((std::vector<std::string_view> {"a", "b"}), list.get<0>());
+    ASSERT_TRUE(list.get<1>());
+    ASSERT_EQ("out", list.get<2>());
+    ASSERT_FALSE(list.get<3>());
+    ASSERT_EQ((std::vector<int> {1, 2}), list.get<4>());
+    ASSERT_EQ(4, list.get<5>());
+
+    ASSERT_EQ(1, arguments.size());
+    ASSERT_EQ("x", arguments[0]);
+}
+
+TEST_F(ParameterListTest, EnvironmentVariable) {
+    const auto jobs = scoped_variable("TEST_JOBS", "8");
+    const auto quiet = scoped_variable("TEST_QUIET", "1");
+
+    auto list = options(
+        commline::env("TEST_JOBS", commline::option<int>({"jobs"}, "", "")),
+        commline::env("TEST_QUIET", commline::flag({"quiet"}, ""))
+    );
+
+    parse(list, {});
+    list.read_environment();
+
+    ASSERT_EQ(8, list.get<0>());
+    ASSERT_TRUE(list.get<1>());
+}
+
+TEST_F(ParameterListTest, EnvironmentPrecedence) {
+    const auto jobs = scoped_variable("TEST_JOBS", "8");
+
+    const auto schema = commline::option_schema(commline::options(
+        commline::env("TEST_JOBS", commline::option<int>({"jobs"}, "", "", 2))
+    ));
+
+    auto set = commline::option_list(schema);
+    parse(set, {"--jobs=4"});
+    set.read_environment();
+    ASSERT_EQ(4, set.get<0>());
+
+    auto unset = commline::option_list(schema);
+    parse(unset, {});
+    unset.read_environment();
+    ASSERT_EQ(8, unset.get<0>());
+}
+
+TEST_F(ParameterListTest, EnvironmentPrefix) {
+    const auto dry_run = scoped_variable("TEST_DRY_RUN", "true");
+    const auto include = scoped_variable("TEST_INCLUDE", "a:b");
+    const auto alias = scoped_variable("TEST_I", "c");
+    const auto help = scoped_variable("TEST_HELP", "1");
+
+    auto list = options(
+        commline::flag({"n", "dry-run"}, ""),
+        commline::list<std::string_view>({"I", "include"}, "", "", ":")
+    );
+
+    parse(list, {});
+    list.read_environment("TEST_");
+
+    ASSERT_TRUE(list.get<0>());
+    ASSERT_EQ((std::vector<std::string_view> {"a", "b"}), list.get<1>());
+    ASSERT_FALSE(list.help());
+}
+
+TEST_F(ParameterListTest, EnvironmentPrefixAdvertised) {
+    // The names help shows for aliases that are not all lower case and
+    // dashes.
+    const auto dry_run = scoped_variable(
+        commline::environment_variable("TEST_", "dry_run"),
+        "true"
+    );
+    const auto jobs = scoped_variable(
+        commline::environment_variable("TEST_", "maxJobs"),
+        "3"
+    );
+
+    auto list = options(
+        commline::flag({"dry_run"}, ""),
+        commline::option<int>({"maxJobs"}, "", "")
+    );
+
+    parse(list, {});
+    list.read_environment("TEST_");
+
+    ASSERT_TRUE(list.get<0>());
+    ASSERT_EQ(3, list.get<1>());
+}
+
+TEST_F(ParameterListTest, EnvironmentFlagDisabled) {
+    const auto quiet = scoped_variable("TEST_QUIET", "0");
+
+    auto list = options(commline::flag({"quiet"}, ""));
+
+    parse(list, {});
+    list.read_environment("TEST_");
+
+    ASSERT_FALSE(list.get<0>());
+}
+
+TEST_F(ParameterListTest, EnvironmentOwnVariableOnly) {
+    const auto prefixed = scoped_variable("TEST_OUTPUT", "prefixed");
+
+    auto list = options(commline::env(
+        "OUTPUT_FILE",
+        commline::option<std::string_view>({"output"}, "", "")
+    ));
+
+    parse(list, {});
+    list.read_environment("TEST_");
+
+    ASSERT_EQ("", list.get<0>());
+}
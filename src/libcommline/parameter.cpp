@@ -3,58 +3,38 @@
 #include <ext/string.h>
 
 namespace commline {
-    describable::describable(std::string_view description) :
-        description(description) {}
-
-    no_argument::no_argument(
-        std::initializer_list<std::string> aliases,
-        std::string_view description
-    ) :
-        option_base(aliases, description) {
-        value = false;
-    }
+    auto environment_variable(std::string_view prefix, std::string_view name)
+        -> std::string {
+        auto result = std::string(prefix);
+        result.reserve(prefix.size() + name.size());
 
-    auto no_argument::set() -> void { value = true; }
+        for (const auto c : name) result.push_back(environment_character(c));
 
-    single_argument::single_argument(
-        std::initializer_list<std::string> aliases,
-        std::string_view description,
-        std::string_view argument_name
-    ) :
-        takes_argument(aliases, description, argument_name) {}
+        return result;
+    }
 
-    auto single_argument::set(std::string_view argument) -> void {
-        value = argument;
+    auto multiple_arguments::describe() const -> option_info {
+        auto info = takes_argument::describe();
+        info.repeatable = true;
+        return info;
     }
 
-    multiple_arguments::multiple_arguments(
-        std::initializer_list<std::string> aliases,
-        std::string_view description,
-        std::string_view argument_name,
-        std::string_view delimiter,
-        bool discard_empty
-    ) :
-        takes_argument(aliases, description, argument_name),
-        delimiter(delimiter),
-        discard_empty(discard_empty) {}
-
-    auto multiple_arguments::set(std::string_view argument) -> void {
+    auto list_format::append(
+        std::pmr::vector<std::string_view>& items,
+        std::string_view argument
+    ) const -> void {
         if (delimiter.empty()) {
-            value.push_back(argument);
+            items.push_back(argument);
             return;
         }
 
         for (const auto& token : ext::string_range(argument, delimiter)) {
             if (discard_empty && token.empty()) continue;
-            value.push_back(token);
+            items.push_back(token);
         }
     }
 
-    flag::flag(
-        std::initializer_list<std::string> aliases,
-        std::string_view description
-    ) :
-        base(aliases, description) {}
-
-    auto flag::get() const -> type { return base.get(); }
+    auto flag::get(const no_argument::state& value) const -> type {
+        return value;
+    }
 }
@@ -0,0 +1,104 @@
+#include "bench.h"
+
+#include <commline/lazy.h>
+#include <commline/parser.h>
+
+#include <array>
+#include <cstdint>
+
+namespace {
+    // Cycles through 'inputs' so that the branch predictor cannot learn a
+    // single value.
+    template <typename T, std::size_t N>
+    auto parse(
+        benchmark::State& state,
+        const std::array<std::string_view, N>& inputs
+    ) -> void {
+        auto i = std::size_t(0);
+
+        for (auto _ : state) {
+            auto value = commline::parser<T>::parse(inputs[i]);
+            benchmark::DoNotOptimize(value);
+
+            if (++i == N) i = 0;
+        }
+
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    constexpr auto text = std::array<std::string_view, 4> {
+        "file.txt",
+        "a much longer argument that does not fit in a small string buffer",
+        "",
+        "--"};
+
+    constexpr auto small_integers =
+        std::array<std::string_view, 4> {"0", "42", "-7", "0x7f"};
+
+    constexpr auto integers =
+        std::array<std::string_view, 4> {"0", "12345", "-9876", "0x7fff"};
+
+    constexpr auto small_unsigned_integers =
+        std::array<std::string_view, 4> {"0", "200", "017", "0xff"};
+
+    constexpr auto unsigned_integers =
+        std::array<std::string_view, 4> {"0", "12345", "0755", "0xffff"};
+
+    constexpr auto reals = std::array<std::string_view, 6> {
+        "0",
+        "3.14159",
+        "-2.5e-3",
+        "1e10",
+        "0x1.8p3",
+        "inf"};
+
+    template <typename T>
+    auto parse_text(benchmark::State& state) -> void {
+        parse<T>(state, text);
+    }
+
+    template <typename T>
+    auto parse_small_integer(benchmark::State& state) -> void {
+        parse<T>(state, small_integers);
+    }
+
+    template <typename T>
+    auto parse_integer(benchmark::State& state) -> void {
+        parse<T>(state, integers);
+    }
+
+    template <typename T>
+    auto parse_small_unsigned(benchmark::State& state) -> void {
+        parse<T>(state, small_unsigned_integers);
+    }
+
+    template <typename T>
+    auto parse_unsigned(benchmark::State& state) -> void {
+        parse<T>(state, unsigned_integers);
+    }
+
+    template <typename T>
+    auto parse_real(benchmark::State& state) -> void {
+        parse<T>(state, reals);
+    }
+}
+
+BENCHMARK_TEMPLATE(parse_text, std::string_view);
+BENCHMARK_TEMPLATE(parse_text, std::string);
+BENCHMARK_TEMPLATE(parse_text, std::optional<std::string_view>);
+BENCHMARK_TEMPLATE(parse_text, commline::lazy<std::string>);
+
+BENCHMARK_TEMPLATE(parse_small_integer, std::int8_t);
+BENCHMARK_TEMPLATE(parse_integer, std::int16_t);
+BENCHMARK_TEMPLATE(parse_integer, std::int32_t);
+BENCHMARK_TEMPLATE(parse_integer, std::int64_t);
+BENCHMARK_TEMPLATE(parse_small_unsigned, std::uint8_t);
+BENCHMARK_TEMPLATE(parse_unsigned, std::uint16_t);
+BENCHMARK_TEMPLATE(parse_unsigned, std::uint32_t);
+BENCHMARK_TEMPLATE(parse_unsigned, std::uint64_t);
+BENCHMARK_TEMPLATE(parse_integer, std::optional<int>);
+BENCHMARK_TEMPLATE(parse_integer, commline::lazy<int>);
+
+BENCHMARK_TEMPLATE(parse_real, float);
+BENCHMARK_TEMPLATE(parse_real, double);
+BENCHMARK_TEMPLATE(parse_real, long double);
@@ -1,7 +1,89 @@
 #include <commline/parser.h>
 
+#include <algorithm>
+
 namespace commline {
     auto parser<std::string>::parse(std::string_view argument) -> std::string {
         return std::string(argument);
     }
+
+    auto integer_literal::split(std::string_view argument) noexcept
+        -> integer_literal {
+        auto result = integer_literal {argument, 10, false};
+        auto& digits = result.digits;
+
+        if (digits.starts_with('-') || digits.starts_with('+')) {
+            result.negative = digits.front() == '-';
+            digits.remove_prefix(1);
+        }
+
+        if (digits.starts_with("0x") || digits.starts_with("0X")) {
+            result.base = 16;
+            digits.remove_prefix(2);
+        }
+        else if (digits.size() > 1 && digits.front() == '0') {
+            result.base = 8;
+            digits.remove_prefix(1);
+        }
+
+        return result;
+    }
+
+    auto floating_literal::split(std::string_view argument) noexcept
+        -> floating_literal {
+        auto result =
+            floating_literal {argument, std::chars_format::general, false};
+        auto& digits = result.digits;
+
+        if (digits.starts_with('-') || digits.starts_with('+')) {
+            result.negative = digits.front() == '-';
+            digits.remove_prefix(1);
+        }
+
+        if (digits.starts_with("0x") || digits.starts_with("0X")) {
+            result.format = std::chars_format::hex;
+            digits.remove_prefix(2);
+        }
+
+        return result;
+    }
+
+    auto floating_literal::tiny() const noexcept -> bool {
+        const auto hex = format == std::chars_format::hex;
+        const auto marker = digits.find_first_of(hex ? "pP" : "eE");
+        const auto mantissa = digits.substr(0, marker);
+
+        const auto point = std::min(mantissa.find('.'), mantissa.size());
+        const auto leading = mantissa.find_first_not_of("0.");
+        if (leading == std::string_view::npos) return true;
+
+        // The power of the base just above the mantissa: positive for the
+        // number of integer digits, otherwise minus the zeros after the
+        // point.
+        auto scale = leading < point
+            ? static_cast<std::int64_t>(point - leading)
+            : -static_cast<std::int64_t>(leading - point - 1);
+
+        // Hexadecimal exponents count binary digits.
+        if (hex) scale *= 4;
+
+        if (marker == std::string_view::npos) return scale <= 0;
+
+        auto exponent = digits.substr(marker + 1);
+        if (exponent.starts_with('+')) exponent.remove_prefix(1);
+
+        auto power = std::int64_t();
+        const auto [ptr, ec] = std::from_chars(
+            exponent.data(),
+            exponent.data() + exponent.size(),
+            power
+        );
+
+        // An exponent too long to read outweighs any mantissa.
+        if (ec == std::errc::result_out_of_range) {
+            return exponent.starts_with('-');
+        }
+
+        return scale + power <= 0;
+    }
 }
@@ -0,0 +1,181 @@
+#include "test.h"
+
+#include <commline/parser.h>
+
+#include <cmath>
+#include <cstdint>
+
+using commline::cli_error;
+
+class ParserTest : public testing::Test {
+protected:
+    template <typename T>
+    static auto parse(std::string_view argument) -> T {
+        return commline::parser<T>::parse(argument);
+    }
+
+    template <typename T>
+    static auto error(std::string_view argument) -> std::string {
+        const auto result = commline::parser<T>::try_parse(argument);
+
+#if __cpp_exceptions
+        // The throwing parser reports the same error.
+        try {
+            parse<T>(argument);
+            EXPECT_TRUE(result) << "parse did not throw";
+        }
+        catch (const cli_error& ex) {
+            if (result) ADD_FAILURE() << "try_parse succeeded";
+            else EXPECT_EQ(result.error().message, ex.what());
+        }
+#endif
+
+        if (result) return {};
+        return result.error().message;
+    }
+};
+
+TEST_F(ParserTest, Integer) {
+    ASSERT_EQ(42, parse<int>("42"));
+    ASSERT_EQ(42, parse<int>("+42"));
+    ASSERT_EQ(-42, parse<int>("-42"));
+    ASSERT_EQ(0, parse<int>("0"));
+    ASSERT_EQ(0, parse<unsigned>("-0"));
+}
+
+TEST_F(ParserTest, IntegerBase) {
+    ASSERT_EQ(255, parse<int>("0xff"));
+    ASSERT_EQ(255, parse<int>("0XFF"));
+    ASSERT_EQ(-16, parse<int>("-0x10"));
+}
+
+TEST_F(ParserTest, IntegerBaseZero) {
+    ASSERT_EQ(8, parse<int>("010"));
+    ASSERT_EQ(-8, parse<long>("-010"));
+    ASSERT_EQ(7, parse<unsigned>("0007"));
+    ASSERT_EQ(16, parse<int>("0x10"));
+    ASSERT_EQ(0, parse<int>("00"));
+    ASSERT_EQ(10, parse<int>("10"));
+
+    constexpr auto message = "could not convert argument '{}' to integer";
+
+    ASSERT_EQ(fmt::format(message, "08"), error<int>("08"));
+    ASSERT_EQ(fmt::format(message, "09"), error<int>("09"));
+}
+
+TEST_F(ParserTest, IntegerLimits) {
+    ASSERT_EQ(INT8_MIN, parse<std::int8_t>("-128"));
+    ASSERT_EQ(INT8_MAX, parse<std::int8_t>("127"));
+    ASSERT_EQ(INT64_MIN, parse<std::int64_t>("-9223372036854775808"));
+    ASSERT_EQ(UINT64_MAX, parse<std::uint64_t>("18446744073709551615"));
+    ASSERT_EQ(UINT64_MAX, parse<std::uint64_t>("0xffffffffffffffff"));
+}
+
+TEST_F(ParserTest, IntegerOutOfRange) {
+    constexpr auto message = "argument '{}' is outside the range of {} and {}";
+
+    ASSERT_EQ(fmt::format(message, "128", -128, 127), error<std::int8_t>("128"));
+    ASSERT_EQ(
+        fmt::format(message, "-129", -128, 127),
+        error<std::int8_t>("-129")
+    );
+    ASSERT_EQ(
+        fmt::format(message, "-1", 0, UINT64_MAX),
+        error<std::uint64_t>("-1")
+    );
+    ASSERT_EQ(
+        fmt::format(message, "18446744073709551616", 0, UINT64_MAX),
+        error<std::uint64_t>("18446744073709551616")
+    );
+}
+
+TEST_F(ParserTest, IntegerInvalid) {
+    for (const auto argument :
+         {""sv, "-"sv, "abc"sv, "12abc"sv, " 12"sv, "0x"sv, "1.5"sv, "--1"sv}) {
+        ASSERT_EQ(
+            fmt::format("could not convert argument '{}' to integer", argument),
+            error<int>(argument)
+        );
+    }
+}
+
+TEST_F(ParserTest, Floating) {
+    ASSERT_EQ(0.5, parse<double>("0.5"));
+    ASSERT_EQ(-0.5, parse<double>("-.5"));
+    ASSERT_EQ(1500.0, parse<double>("+1.5e3"));
+    ASSERT_EQ(0.1f, parse<float>("0.1"));
+    ASSERT_EQ(0.1L, parse<long double>("0.1"));
+}
+
+TEST_F(ParserTest, FloatingHex) {
+    ASSERT_EQ(1.0, parse<double>("0x1p0"));
+    ASSERT_EQ(-10.0, parse<double>("-0x1.4p3"));
+    ASSERT_EQ(255.0f, parse<float>("0XFF"));
+    ASSERT_EQ(0.5L, parse<long double>("0x1p-1"));
+}
+
+TEST_F(ParserTest, FloatingSpecialValues) {
+    ASSERT_EQ(INFINITY, parse<double>("inf"));
+    ASSERT_EQ(-INFINITY, parse<double>("-Infinity"));
+    ASSERT_TRUE(std::isnan(parse<double>("nan")));
+    ASSERT_TRUE(std::isnan(parse<float>("-NaN")));
+}
+
+TEST_F(ParserTest, FloatingOutOfRange) {
+    ASSERT_EQ(
+        fmt::format(
+            "argument '1e999' is outside the range of {} and {}",
+            std::numeric_limits<double>::lowest(),
+            std::numeric_limits<double>::max()
+        ),
+        error<double>("1e999")
+    );
+    ASSERT_FALSE(error<float>("-1e39").empty());
+}
+
+TEST_F(ParserTest, FloatingUnderflow) {
+    ASSERT_EQ(
+        fmt::format(
+            "argument '1e-400' is smaller in magnitude than {}",
+            std::numeric_limits<double>::denorm_min()
+        ),
+        error<double>("1e-400")
+    );
+    ASSERT_EQ(
+        fmt::format(
+            "argument '-0x1p-2000' is smaller in magnitude than {}",
+            std::numeric_limits<double>::denorm_min()
+        ),
+        error<double>("-0x1p-2000")
+    );
+    ASSERT_EQ(
+        fmt::format(
+            "argument '0.0001e-50' is smaller in magnitude than {}",
+            std::numeric_limits<float>::denorm_min()
+        ),
+        error<float>("0.0001e-50")
+    );
+    ASSERT_EQ(0x1p-1070, parse<double>("0x1p-1070"));
+    ASSERT_EQ(1e-310, parse<double>("1e-310"));
+    ASSERT_NE(
+        std::string::npos,
+        error<double>("1000e-99999999999999999999").find("magnitude")
+    );
+    ASSERT_NE(
+        std::string::npos,
+        error<double>("0x100000p1021").find("outside the range")
+    );
+}
+
+TEST_F(ParserTest, FloatingInvalid) {
+    for (const auto argument :
+         {""sv, "-"sv, "abc"sv, "1.5x"sv, " 1"sv, "--1"sv, "+-1"sv, "0x"sv}) {
+        ASSERT_EQ(
+            fmt::format(
+                "could not convert argument '{}' to a floating-point number",
+                argument
+            ),
+            error<double>(argument)
+        );
+    }
+}
@@ -1,7 +1,22 @@
 #include <commline/print.h>
 
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <iostream>
+#include <unistd.h>
+
 namespace {
     constexpr auto indent_size = 4;
+
+    constexpr auto blanks = std::string_view(
+        "                                                                "
+    );
+
+    // Text bound for this buffer is written straight to the descriptor.
+    // Saved before 'main' runs, so that a 'std::cout' redirected through
+    // 'rdbuf' is written to as any other stream.
+    const auto* const stdout_buffer = std::cout.rdbuf();
 }
 
 namespace commline::print {
@@ -12,6 +27,35 @@ namespace commline::print {
     auto indent(std::ostream& out) -> void { spaces(out, indent_size); }
 
     auto spaces(std::ostream& out, int amount) -> void {
-        for (auto i = 0; i < amount; ++i) out << " ";
+        while (amount > 0) {
+            const auto count = std::min<int>(amount, blanks.size());
+            out.write(blanks.data(), count);
+            amount -= count;
+        }
+    }
+
+    auto write(std::ostream& out, std::string_view text) -> void {
+        if (out.rdbuf() != stdout_buffer) {
+            out.write(text.data(), text.size());
+            return;
+        }
+
+        // Anything already buffered must come first.
+        out.flush();
+        std::fflush(stdout);
+
+        while (!text.empty()) {
+            const auto written =
+                ::write(STDOUT_FILENO, text.data(), text.size());
+
+            if (written == -1) {
+                if (errno == EINTR) continue;
+
+                out.setstate(std::ios::badbit);
+                return;
+            }
+
+            text.remove_prefix(written);
+        }
     }
 }
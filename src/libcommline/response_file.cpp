@@ -0,0 +1,268 @@
+#include <commline/response_file.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <system_error>
+#include <unistd.h>
+#include <utility>
+
+namespace {
+    auto file_error(std::string_view what, const char* path)
+        -> commline::parse_error {
+        return commline::parse_error(
+            std::error_code(errno, std::generic_category()),
+            std::string(what) + " response file '" + path + "'"
+        );
+    }
+
+    // Reads the file open on 'fd' into 'buffer', which is given one byte
+    // more than the contents for a terminator, and returns the number of
+    // bytes read. Regular files are read up to the size 'fstat' reported.
+    // Pipes and other files without a size, such as '@/dev/stdin' or a
+    // process substitution, are read until end of file.
+    auto read_file(
+        int fd,
+        const char* path,
+        std::unique_ptr<char[]>& buffer
+    ) -> commline::expected<std::size_t> {
+        constexpr auto chunk = std::size_t(4096);
+
+        struct stat st;
+        if (::fstat(fd, &st) == -1) return file_error("failed to stat", path);
+
+        const auto regular = S_ISREG(st.st_mode);
+        auto capacity = regular ? static_cast<std::size_t>(st.st_size) : chunk;
+        auto size = std::size_t(0);
+
+        buffer.reset(new char[capacity + 1]);
+
+        while (true) {
+            if (size == capacity) {
+                if (regular) break;
+
+                capacity *= 2;
+
+                auto larger = std::unique_ptr<char[]>(new char[capacity + 1]);
+                std::memcpy(larger.get(), buffer.get(), size);
+                buffer = std::move(larger);
+            }
+
+            const auto count = ::read(fd, buffer.get() + size, capacity - size);
+
+            if (count == -1) {
+                if (errno == EINTR) continue;
+                return file_error("failed to read", path);
+            }
+
+            // End of file, or a regular file that shrank after it was
+            // measured.
+            if (count == 0) break;
+
+            size += count;
+        }
+
+        return size;
+    }
+}
+
+namespace commline {
+    auto mapped_file::map(const char* path) -> expected<mapped_file> {
+        const auto fd = ::open(path, O_RDONLY | O_CLOEXEC);
+        if (fd == -1) return file_error("failed to open", path);
+
+        struct stat st;
+
+        if (::fstat(fd, &st) == -1) {
+            const auto error = file_error("failed to stat", path);
+            ::close(fd);
+            return error;
+        }
+
+        auto result = mapped_file();
+        result.size = st.st_size;
+
+        if (result.size > 0) {
+            auto* const data =
+                ::mmap(nullptr, result.size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+            if (data == MAP_FAILED) {
+                const auto error = file_error("failed to map", path);
+                ::close(fd);
+                return error;
+            }
+
+            result.data = static_cast<char*>(data);
+            ::madvise(result.data, result.size, MADV_SEQUENTIAL);
+        }
+
+        ::close(fd);
+        return result;
+    }
+
+    mapped_file::mapped_file(const char* path) :
+        mapped_file(map(path).value()) {}
+
+    mapped_file::mapped_file(mapped_file&& other) noexcept :
+        data(std::exchange(other.data, nullptr)),
+        size(std::exchange(other.size, 0)) {}
+
+    mapped_file::~mapped_file() {
+        if (data) ::munmap(data, size);
+    }
+
+    auto mapped_file::operator=(mapped_file&& other) noexcept -> mapped_file& {
+        if (this != &other) {
+            if (data) ::munmap(data, size);
+
+            data = std::exchange(other.data, nullptr);
+            size = std::exchange(other.size, 0);
+        }
+
+        return *this;
+    }
+
+    response_files::response_files(argv args) : args(args) {}
+
+    response_files::response_files(argv args, response_format format) :
+        args(args) {
+        expand(format).value();
+    }
+
+    auto response_files::expand(response_format format) -> expected<argv> {
+        if (format == response_format::none) return args;
+
+        const auto is_response_file = [](std::string_view arg) {
+            return arg.size() > 1 && arg.front() == '@';
+        };
+
+        // The first argument is the program name.
+        auto first = args.begin();
+        if (first != args.end()) ++first;
+
+        const auto options_end = std::find_if(first, args.end(), [](auto arg) {
+            return std::string_view(arg) == "--";
+        });
+
+        if (std::none_of(first, options_end, is_response_file)) return args;
+
+        expanded.reserve(args.size());
+
+        for (auto it = args.begin(); it != args.end(); ++it) {
+            if (it != args.begin() && it < options_end &&
+                is_response_file(*it)) {
+                const auto* const path = *it + 1;
+                auto status = format == response_format::lines ?
+                    read_lines(path) :
+                    read_null(path);
+                if (!status) return std::move(status).error();
+            }
+            else expanded.push_back(*it);
+        }
+
+        args = expanded;
+        return args;
+    }
+
+    auto response_files::read_lines(const char* path) -> expected<void> {
+        const auto fd = ::open(path, O_RDONLY | O_CLOEXEC);
+        if (fd == -1) return file_error("failed to open", path);
+
+        auto& copy = copies.emplace_back();
+        const auto size = read_file(fd, path, copy);
+
+        ::close(fd);
+        if (!size) return std::move(size).error();
+
+        auto* token = copy.get();
+        auto* const end = token + *size;
+        *end = '\n';
+
+        while (token != end) {
+            auto* const next = std::find(token, end + 1, '\n');
+
+            *next = '\0';
+            if (next != token && next[-1] == '\r') next[-1] = '\0';
+
+            // Blank lines, including those holding only a carriage return,
+            // are not arguments.
+            if (*token != '\0') expanded.push_back(token);
+            if (next == end) break;
+
+            token = next + 1;
+        }
+
+        return {};
+    }
+
+    auto response_files::read_null(const char* path) -> expected<void> {
+        struct stat st;
+
+        // Files without a size cannot be mapped and are read instead.
+        if (::stat(path, &st) == 0 && !S_ISREG(st.st_mode)) {
+            return read_null_stream(path);
+        }
+
+        auto mapped = mapped_file::map(path);
+        if (!mapped) return std::move(mapped).error();
+
+        const auto contents = files.emplace_back(*std::move(mapped)).contents();
+
+        const auto* token = contents.data();
+        const auto* const end = token + contents.size();
+
+        while (token != end) {
+            const auto* const next = std::find(token, end, '\0');
+
+            if (next == end) {
+                // The last argument is not terminated, and the mapping cannot
+                // be written past its end, so this one argument is copied.
+                const auto size = static_cast<std::size_t>(end - token);
+                auto& tail = copies.emplace_back(new char[size + 1]);
+
+                std::memcpy(tail.get(), token, size);
+                tail[size] = '\0';
+
+                expanded.push_back(tail.get());
+                return {};
+            }
+
+            expanded.push_back(token);
+            token = next + 1;
+        }
+
+        return {};
+    }
+
+    auto response_files::read_null_stream(const char* path) -> expected<void> {
+        const auto fd = ::open(path, O_RDONLY | O_CLOEXEC);
+        if (fd == -1) return file_error("failed to open", path);
+
+        auto& copy = copies.emplace_back();
+        const auto size = read_file(fd, path, copy);
+
+        ::close(fd);
+        if (!size) return std::move(size).error();
+
+        auto* token = copy.get();
+        auto* const end = token + *size;
+        *end = '\0';
+
+        while (token != end) {
+            auto* const next = std::find(token, end, '\0');
+
+            expanded.push_back(token);
+            if (next == end) break;
+
+            token = next + 1;
+        }
+
+        return {};
+    }
+}
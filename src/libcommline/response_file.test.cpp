@@ -0,0 +1,176 @@
+#include "test.h"
+
+#include <commline/application.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <unistd.h>
+
+using commline::application;
+using commline::arguments;
+using commline::flag;
+using commline::options;
+using commline::response_format;
+using commline::variadic;
+
+class ResponseFileTest : public testing::Test {
+protected:
+    std::vector<std::string> paths;
+    // Copies: the arguments point into mappings released by 'run'.
+    std::vector<std::string> values;
+    bool verbose = false;
+
+    auto TearDown() -> void override {
+        for (const auto& path : paths) ::unlink(path.c_str());
+    }
+
+    auto file(std::string_view contents) -> std::string {
+        auto path = std::string("/tmp/commline.test.XXXXXX");
+        const auto fd = ::mkstemp(path.data());
+
+        if (fd == -1) {
+            ADD_FAILURE() << "failed to create file: " << std::strerror(errno);
+        }
+        else ::close(fd);
+
+        std::ofstream(path, std::ios::binary) << contents;
+
+        paths.push_back(path);
+        return "@" + path;
+    }
+
+    auto run(
+        response_format format,
+        std::initializer_list<std::string_view> args
+    ) -> int {
+        auto app = application(
+            "app",
+            "0.0.0",
+            "Response file test.",
+            options(flag({"verbose", "v"}, "")),
+            arguments(variadic<std::string_view>("values")),
+            [this](
+                const commline::app& app,
+                bool verbose,
+                const std::vector<std::string_view>& values
+            ) {
+                this->verbose = verbose;
+                this->values.assign(values.begin(), values.end());
+            }
+        );
+
+        app.expand_response_files(format);
+        app.on_error([](std::exception_ptr) {});
+
+        auto storage = std::vector<std::string>(args.begin(), args.end());
+        auto argv = std::vector<char*>();
+
+        for (auto& arg : storage) argv.push_back(arg.data());
+
+        return app.run(argv.size(), argv.data());
+    }
+};
+
+TEST_F(ResponseFileTest, Lines) {
+    const auto arg = file("-v\none\r\ntwo\nthree\n");
+
+    ASSERT_EQ(0, run(response_format::lines, {"./app", "zero", arg, "four"}));
+
+    ASSERT_TRUE(verbose);
+    ASSERT_EQ(
+        (std::vector<std::string> {"zero", "one", "two", "three", "four"}),
+        values
+    );
+}
+
+TEST_F(ResponseFileTest, BlankLines) {
+    const auto arg = file("\none\n\n\r\ntwo\n\r\n");
+
+    ASSERT_EQ(0, run(response_format::lines, {"./app", arg}));
+    ASSERT_EQ((std::vector<std::string> {"one", "two"}), values);
+}
+
+TEST_F(ResponseFileTest, LastLineUnterminated) {
+    const auto arg = file("one\r\ntwo\r");
+
+    ASSERT_EQ(0, run(response_format::lines, {"./app", arg, arg}));
+    ASSERT_EQ(
+        (std::vector<std::string> {"one", "two", "one", "two"}),
+        values
+    );
+}
+
+TEST_F(ResponseFileTest, Null) {
+    const auto arg = file("one\0two\nlines\0three"sv);
+
+    ASSERT_EQ(0, run(response_format::null, {"./app", arg}));
+
+    ASSERT_EQ(
+        (std::vector<std::string> {"one", "two\nlines", "three"}),
+        values
+    );
+}
+
+TEST_F(ResponseFileTest, Pipe) {
+    // Longer than one read, and than the size 'fstat' reports for a pipe.
+    auto contents = std::string();
+    auto expected = std::vector<std::string>();
+
+    for (auto i = 0; i < 2000; ++i) {
+        expected.push_back(std::to_string(i));
+        contents += expected.back() + "\n";
+    }
+
+    for (const auto format : {response_format::lines, response_format::null}) {
+        if (format == response_format::null) {
+            std::replace(contents.begin(), contents.end(), '\n', '\0');
+        }
+
+        int fds[2];
+        ASSERT_EQ(0, ::pipe(fds));
+
+        const auto written =
+            ::write(fds[1], contents.data(), contents.size());
+        ASSERT_EQ(static_cast<ssize_t>(contents.size()), written);
+        ::close(fds[1]);
+
+        const auto arg = "@/dev/fd/" + std::to_string(fds[0]);
+        const auto status = run(format, {"./app", arg});
+
+        ::close(fds[0]);
+
+        ASSERT_EQ(0, status);
+        ASSERT_EQ(expected, values);
+    }
+}
+
+TEST_F(ResponseFileTest, Empty) {
+    const auto arg = file("");
+
+    ASSERT_EQ(0, run(response_format::lines, {"./app", arg, "one"}));
+    ASSERT_EQ((std::vector<std::string> {"one"}), values);
+}
+
+TEST_F(ResponseFileTest, Disabled) {
+    const auto arg = file("one\n");
+
+    ASSERT_EQ(0, run(response_format::none, {"./app", arg}));
+    ASSERT_EQ((std::vector<std::string> {arg}), values);
+}
+
+TEST_F(ResponseFileTest, EndOfOptions) {
+    const auto arg = file("one\n");
+
+    ASSERT_EQ(0, run(response_format::lines, {"./app", "--", arg, "@"}));
+    ASSERT_EQ((std::vector<std::string> {arg, "@"}), values);
+}
+
+TEST_F(ResponseFileTest, Missing) {
+    ASSERT_EQ(
+        ENOENT,
+        run(response_format::lines, {"./app", "@/nonexistent/commline"})
+    );
+}
@@ -0,0 +1,718 @@
+#include <commline/completion.h>
+#include <commline/schema.h>
+
+#include <algorithm>
+#include <cctype>
+#include <fmt/format.h>
+#include <fmt/ostream.h>
+
+namespace {
+    using commline::argument_info;
+    using commline::argument_kind;
+    using commline::command_info;
+    using commline::option_info;
+
+    // A command and the names leading to it from the root, as typed.
+    struct command_path {
+        std::string path;
+        const command_info* command;
+    };
+
+    auto paths(const command_info& root) -> std::vector<command_path> {
+        auto result = std::vector<command_path>();
+
+        const auto visit = [&result](
+                               const auto& self,
+                               const std::string& path,
+                               const command_info& command
+                           ) -> void {
+            result.push_back({path, &command});
+
+            for (const auto& child : command.commands) {
+                self(self, path + " " + std::string(child.name), child);
+            }
+        };
+
+        visit(visit, std::string(root.name), root);
+        return result;
+    }
+
+    // Whether any value of the command must be listed by running the
+    // program's completion command.
+    auto dynamic(const command_info& command) -> bool {
+        return std::ranges::any_of(
+                   command.options,
+                   [](const option_info& option) { return option.dynamic; }
+               ) ||
+               std::ranges::any_of(
+                   command.arguments,
+                   [](const argument_info& argument) { return argument.dynamic; }
+               );
+    }
+
+    auto dashed(std::string_view alias) -> std::string {
+        return (alias.size() == 1 ? "-" : "--") + std::string(alias);
+    }
+
+    auto identifier(std::string_view name) -> std::string {
+        auto result = std::string(name);
+
+        std::replace_if(
+            result.begin(),
+            result.end(),
+            [](char c) { return !std::isalnum(static_cast<unsigned char>(c)); },
+            '_'
+        );
+
+        return result;
+    }
+
+    auto uppercase(std::string_view text) -> std::string {
+        auto result = std::string(text);
+
+        std::transform(
+            result.begin(),
+            result.end(),
+            result.begin(),
+            [](char c) { return std::toupper(static_cast<unsigned char>(c)); }
+        );
+
+        return result;
+    }
+
+    // Quotes text for a POSIX shell.
+    auto quoted(std::string_view text) -> std::string {
+        auto result = std::string("'");
+
+        for (const auto c : text) {
+            if (c == '\'') result += "'\\''";
+            else result += c;
+        }
+
+        result += '\'';
+        return result;
+    }
+
+    auto json_string(std::string_view text) -> std::string {
+        auto result = std::string("\"");
+
+        for (const auto c : text) {
+            switch (c) {
+                case '"': result += "\\\""; break;
+                case '\\': result += "\\\\"; break;
+                case '\n': result += "\\n"; break;
+                case '\t': result += "\\t"; break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20) {
+                        result += fmt::format("\\u{:04x}", c);
+                    }
+                    else result += c;
+            }
+        }
+
+        result += '"';
+        return result;
+    }
+
+    auto kind_name(argument_kind kind) -> std::string_view {
+        switch (kind) {
+            case argument_kind::required: return "required";
+            case argument_kind::optional: return "optional";
+            case argument_kind::variadic: return "variadic";
+        }
+
+        return {};
+    }
+
+    auto write_json(
+        std::ostream& out,
+        const command_info& command,
+        std::string_view version,
+        std::size_t depth
+    ) -> void {
+        const auto outer = std::string(depth * 2, ' ');
+        const auto inner = std::string((depth + 1) * 2, ' ');
+        const auto item = "\n" + inner + "  ";
+
+        const auto close = [&inner](bool empty) {
+            return empty ? std::string() : "\n" + inner;
+        };
+
+        fmt::print(
+            out,
+            "{{\n{}\"name\": {},\n",
+            inner,
+            json_string(command.name)
+        );
+
+        if (depth == 0) {
+            fmt::print(
+                out,
+                "{}\"version\": {},\n",
+                inner,
+                json_string(version)
+            );
+        }
+
+        fmt::print(
+            out,
+            "{}\"description\": {},\n",
+            inner,
+            json_string(command.description)
+        );
+
+        fmt::print(out, "{}\"options\": [", inner);
+
+        for (std::size_t i = 0; i < command.options.size(); ++i) {
+            const auto& option = command.options[i];
+
+            auto aliases = std::vector<std::string>();
+            for (const auto& alias : option.aliases) {
+                aliases.push_back(json_string(alias));
+            }
+
+            fmt::print(
+                out,
+                "{}{}{{\"aliases\": [{}], \"description\": {}, "
+                "\"argument\": {}, \"repeatable\": {}, \"dynamic\": {}}}",
+                i == 0 ? "" : ",",
+                item,
+                fmt::join(aliases, ", "),
+                json_string(option.description),
+                option.argument_name.empty()
+                    ? "null"
+                    : json_string(option.argument_name),
+                option.repeatable,
+                option.dynamic
+            );
+        }
+
+        fmt::print(
+            out,
+            "{}],\n{}\"arguments\": [",
+            close(command.options.empty()),
+            inner
+        );
+
+        for (std::size_t i = 0; i < command.arguments.size(); ++i) {
+            const auto& argument = command.arguments[i];
+
+            fmt::print(
+                out,
+                "{}{}{{\"name\": {}, \"kind\": \"{}\", \"dynamic\": {}}}",
+                i == 0 ? "" : ",",
+                item,
+                json_string(argument.name),
+                kind_name(argument.kind),
+                argument.dynamic
+            );
+        }
+
+        fmt::print(
+            out,
+            "{}],\n{}\"commands\": [",
+            close(command.arguments.empty()),
+            inner
+        );
+
+        for (std::size_t i = 0; i < command.commands.size(); ++i) {
+            fmt::print(out, "{}{}", i == 0 ? "" : ",", item);
+            write_json(out, command.commands[i], version, depth + 2);
+        }
+
+        fmt::print(out, "{}]\n{}}}", close(command.commands.empty()), outer);
+
+        if (depth == 0) out << "\n";
+    }
+
+    // Matches the words following the program name against subcommand
+    // names the way 'command_node::find' does, stopping at the first word
+    // that is not one.
+    auto write_shell_walk(
+        std::ostream& out,
+        const std::vector<command_path>& commands,
+        std::string_view indent,
+        std::string_view open_pattern
+    ) -> void {
+        auto patterns = std::vector<std::string>();
+        for (const auto& command : commands) {
+            if (command.command != commands.front().command) {
+                patterns.push_back(quoted(command.path));
+            }
+        }
+
+        fmt::print(out, "{}case \"$cmd $word\" in\n", indent);
+
+        if (!patterns.empty()) {
+            fmt::print(
+                out,
+                "{}    {}{}) cmd=\"$cmd $word\" ;;\n",
+                indent,
+                open_pattern,
+                fmt::join(patterns, "|")
+            );
+        }
+
+        fmt::print(out, "{}    {}*) break ;;\n", indent, open_pattern);
+        fmt::print(out, "{}esac\n", indent);
+    }
+
+    auto argument_aliases(const command_info& command)
+        -> std::vector<std::string> {
+        auto result = std::vector<std::string>();
+
+        for (const auto& option : command.options) {
+            if (option.argument_name.empty()) continue;
+
+            for (const auto& alias : option.aliases) {
+                result.push_back(quoted(dashed(alias)));
+            }
+        }
+
+        return result;
+    }
+
+    auto write_bash(std::ostream& out, const command_info& root) -> void {
+        const auto commands = paths(root);
+        const auto function = "_" + identifier(root.name);
+
+        fmt::print(
+            out,
+            "# bash completion for {0}\n\n"
+            "{1}() {{\n"
+            "    local cur=${{COMP_WORDS[COMP_CWORD]}}\n"
+            "    local prev=${{COMP_WORDS[COMP_CWORD-1]}}\n"
+            "    local cmd={2}\n"
+            "    local words=\n"
+            "    COMPREPLY=()\n"
+            "    local i word\n\n"
+            "    for ((i = 1; i < COMP_CWORD; i++)); do\n"
+            "        word=${{COMP_WORDS[i]}}\n",
+            root.name,
+            function,
+            quoted(root.name)
+        );
+
+        write_shell_walk(out, commands, "        ", "");
+
+        fmt::print(out, "    done\n\n    case \"$cmd\" in\n");
+
+        for (const auto& [path, command] : commands) {
+            auto words = std::vector<std::string>();
+
+            for (const auto& child : command->commands) {
+                words.emplace_back(child.name);
+            }
+
+            for (const auto& option : command->options) {
+                for (const auto& alias : option.aliases) {
+                    words.push_back(dashed(alias));
+                }
+            }
+
+            fmt::print(out, "        {})\n", quoted(path));
+
+            if (dynamic(*command)) {
+                fmt::print(
+                    out,
+                    "            mapfile -t COMPREPLY < <(\"${{COMP_WORDS[0]}}\" "
+                    "{} \"$COMP_CWORD\" -- \"${{COMP_WORDS[@]}}\")\n"
+                    "            return\n"
+                    "            ;;\n",
+                    commline::complete_command
+                );
+                continue;
+            }
+
+            if (const auto aliases = argument_aliases(*command);
+                !aliases.empty()) {
+                fmt::print(
+                    out,
+                    "            case \"$prev\" in\n"
+                    "                {}) return ;;\n"
+                    "            esac\n",
+                    fmt::join(aliases, "|")
+                );
+            }
+
+            fmt::print(
+                out,
+                "            words={}\n"
+                "            ;;\n",
+                quoted(fmt::format("{}", fmt::join(words, " ")))
+            );
+        }
+
+        fmt::print(
+            out,
+            "    esac\n\n"
+            "    COMPREPLY=($(compgen -W \"$words\" -- \"$cur\"))\n"
+            "}}\n\n"
+            "complete -o default -F {} {}\n",
+            function,
+            root.name
+        );
+    }
+
+    auto write_zsh(std::ostream& out, const command_info& root) -> void {
+        const auto commands = paths(root);
+
+        fmt::print(
+            out,
+            "#compdef {}\n\n"
+            "local cmd={} word prev=${{words[CURRENT-1]}}\n"
+            "local -a subcommands flags\n"
+            "local files=0 i\n\n"
+            "for ((i = 2; i < CURRENT; i++)); do\n"
+            "    word=${{words[i]}}\n",
+            root.name,
+            quoted(root.name)
+        );
+
+        write_shell_walk(out, commands, "    ", "(");
+
+        fmt::print(out, "done\n\ncase \"$cmd\" in\n");
+
+        const auto described = [](std::string_view name, std::string_view d) {
+            auto entry = std::string();
+
+            for (const auto c : name) {
+                if (c == ':') entry += '\\';
+                entry += c;
+            }
+
+            return quoted(entry + ":" + std::string(d));
+        };
+
+        for (const auto& [path, command] : commands) {
+            fmt::print(out, "    ({})\n", quoted(path));
+
+            if (dynamic(*command)) {
+                fmt::print(
+                    out,
+                    "        local -a candidates\n"
+                    "        candidates=(${{(f)\"$(\"${{words[1]}}\" {} "
+                    "$((CURRENT - 1)) -- \"${{words[@]}}\")\"}})\n"
+                    "        compadd -a candidates\n"
+                    "        return\n"
+                    "        ;;\n",
+                    commline::complete_command
+                );
+                continue;
+            }
+
+            if (const auto aliases = argument_aliases(*command);
+                !aliases.empty()) {
+                fmt::print(
+                    out,
+                    "        case \"$prev\" in\n"
+                    "            ({}) _files; return ;;\n"
+                    "        esac\n",
+                    fmt::join(aliases, "|")
+                );
+            }
+
+            auto entries = std::vector<std::string>();
+            for (const auto& child : command->commands) {
+                entries.push_back(described(child.name, child.description));
+            }
+            fmt::print(
+                out,
+                "        subcommands=({})\n",
+                fmt::join(entries, " ")
+            );
+
+            entries.clear();
+            for (const auto& option : command->options) {
+                for (const auto& alias : option.aliases) {
+                    entries.push_back(
+                        described(dashed(alias), option.description)
+                    );
+                }
+            }
+            fmt::print(out, "        flags=({})\n", fmt::join(entries, " "));
+
+            if (!command->arguments.empty()) {
+                fmt::print(out, "        files=1\n");
+            }
+
+            fmt::print(out, "        ;;\n");
+        }
+
+        fmt::print(
+            out,
+            "esac\n\n"
+            "_describe -t commands 'command' subcommands\n"
+            "_describe -t options 'option' flags\n"
+            "(( files )) && _files\n"
+            "return 0\n"
+        );
+    }
+
+    // Quotes text for fish, in which a single-quoted string only treats
+    // backslash and the single quote specially.
+    auto fish_quoted(std::string_view text) -> std::string {
+        auto result = std::string("'");
+
+        for (const auto c : text) {
+            if (c == '\'' || c == '\\') result += '\\';
+            result += c;
+        }
+
+        result += '\'';
+        return result;
+    }
+
+    auto write_fish(std::ostream& out, const command_info& root) -> void {
+        const auto commands = paths(root);
+        const auto function = "__" + identifier(root.name) + "_command";
+
+        auto subcommands = std::vector<std::string>();
+        for (const auto& command : commands) {
+            if (command.command == &root) continue;
+            subcommands.push_back(fish_quoted(command.path));
+        }
+
+        fmt::print(
+            out,
+            "# fish completion for {0}\n\n"
+            "function {1}\n"
+            "    set -l cmd {2}\n"
+            "    for word in (commandline -opc)[2..-1]\n"
+            "        contains -- \"$cmd $word\" {3}; or break\n"
+            "        set cmd \"$cmd $word\"\n"
+            "    end\n"
+            "    test \"$cmd\" = \"$argv\"\n"
+            "end\n",
+            root.name,
+            function,
+            fish_quoted(root.name),
+            fmt::join(subcommands, " ")
+        );
+
+        const auto complete = "__" + identifier(root.name) + "_complete";
+
+        if (std::ranges::any_of(commands, [](const command_path& command) {
+                return dynamic(*command.command);
+            })) {
+            fmt::print(
+                out,
+                "\n"
+                "function {}\n"
+                "    set -l words (commandline -opc)\n"
+                "    command $words[1] {} (count $words) -- $words "
+                "(commandline -ct)\n"
+                "end\n",
+                complete,
+                commline::complete_command
+            );
+        }
+
+        for (const auto& [path, command] : commands) {
+            const auto condition =
+                fish_quoted(fmt::format("{} {}", function, path));
+            const auto prefix =
+                fmt::format("complete -c {} -n {}", root.name, condition);
+
+            fmt::print(out, "\n");
+
+            if (command->arguments.empty()) fmt::print(out, "{} -f\n", prefix);
+
+            // The completion command lists subcommands along with values.
+            if (dynamic(*command)) {
+                fmt::print(
+                    out,
+                    "{} -f -a {}\n",
+                    prefix,
+                    fish_quoted(fmt::format("({})", complete))
+                );
+            }
+            else {
+                for (const auto& child : command->commands) {
+                    fmt::print(
+                        out,
+                        "{} -f -a {} -d {}\n",
+                        prefix,
+                        fish_quoted(child.name),
+                        fish_quoted(child.description)
+                    );
+                }
+            }
+
+            for (const auto& option : command->options) {
+                fmt::print(out, "{}", prefix);
+
+                for (const auto& alias : option.aliases) {
+                    fmt::print(
+                        out,
+                        " -{} {}",
+                        alias.size() == 1 ? "s" : "l",
+                        fish_quoted(alias)
+                    );
+                }
+
+                if (!option.argument_name.empty()) fmt::print(out, " -r");
+
+                fmt::print(out, " -d {}\n", fish_quoted(option.description));
+            }
+        }
+    }
+
+    auto roff(std::string_view text) -> std::string {
+        auto result = std::string();
+
+        // A control character at the start of a line would be taken as a
+        // request.
+        if (text.starts_with('.') || text.starts_with('\'')) result += "\\&";
+
+        for (const auto c : text) {
+            switch (c) {
+                case '\\': result += "\\e"; break;
+                case '-': result += "\\-"; break;
+                case '\n': result += "\n.br\n"; break;
+                default: result += c;
+            }
+        }
+
+        return result;
+    }
+
+    // A roff request argument, which may contain spaces.
+    auto quoted_roff(std::string_view text) -> std::string {
+        auto result = std::string("\"");
+
+        for (const auto c : roff(text)) {
+            if (c == '"') result += '"';
+            result += c;
+        }
+
+        result += '"';
+        return result;
+    }
+
+    auto write_synopsis(
+        std::ostream& out,
+        std::string_view path,
+        const command_info& command
+    ) -> void {
+        fmt::print(out, "\\fB{}\\fR", roff(path));
+
+        if (command.options.size() > 1) {
+            fmt::print(out, " [options]");
+            if (!command.arguments.empty()) fmt::print(out, " [\\-\\-]");
+        }
+
+        for (const auto& argument : command.arguments) {
+            const auto name = roff(uppercase(argument.name));
+
+            switch (argument.kind) {
+                case argument_kind::required:
+                    fmt::print(out, " \\fI{}\\fR", name);
+                    break;
+                case argument_kind::optional:
+                    fmt::print(out, " [\\fI{}\\fR]", name);
+                    break;
+                case argument_kind::variadic:
+                    fmt::print(out, " \\fI{}\\fR...", name);
+                    break;
+            }
+        }
+
+        fmt::print(out, "\n");
+    }
+
+    auto write_options(std::ostream& out, const command_info& command)
+        -> void {
+        for (const auto& option : command.options) {
+            auto aliases = std::vector<std::string>();
+            for (const auto& alias : option.aliases) {
+                aliases.push_back(
+                    fmt::format("\\fB{}\\fR", roff(dashed(alias)))
+                );
+            }
+
+            fmt::print(out, ".TP\n{}", fmt::join(aliases, ", "));
+
+            if (!option.argument_name.empty()) {
+                fmt::print(out, " \\fI{}\\fR", roff(option.argument_name));
+            }
+
+            fmt::print(out, "\n{}\n", roff(option.description));
+        }
+    }
+
+    auto write_man(
+        std::ostream& out,
+        const command_info& root,
+        std::string_view version
+    ) -> void {
+        const auto commands = paths(root);
+
+        fmt::print(
+            out,
+            ".TH {} 1 \"\" {} \"User Commands\"\n"
+            ".SH NAME\n"
+            "{} \\- {}\n"
+            ".SH SYNOPSIS\n",
+            roff(uppercase(root.name)),
+            quoted_roff(fmt::format("{} {}", root.name, version)),
+            roff(root.name),
+            roff(root.description)
+        );
+
+        write_synopsis(out, root.name, root);
+
+        fmt::print(out, ".SH OPTIONS\n");
+        write_options(out, root);
+
+        if (commands.size() == 1) return;
+
+        fmt::print(out, ".SH COMMANDS\n");
+
+        for (const auto& [path, command] : commands) {
+            if (command == &root) continue;
+
+            fmt::print(
+                out,
+                ".SS {}\n{}\n.PP\n",
+                quoted_roff(path),
+                roff(command->description)
+            );
+
+            write_synopsis(out, path, *command);
+            write_options(out, *command);
+        }
+    }
+}
+
+namespace commline {
+    auto parse_schema_format(std::string_view format) -> schema_format {
+        return try_parse_schema_format(format).value();
+    }
+
+    auto try_parse_schema_format(std::string_view format)
+        -> expected<schema_format> {
+        if (format == "json") return schema_format::json;
+        if (format == "bash") return schema_format::bash;
+        if (format == "zsh") return schema_format::zsh;
+        if (format == "fish") return schema_format::fish;
+        if (format == "man") return schema_format::man;
+
+        return parse_error("unknown schema format: {}", format);
+    }
+
+    auto write_schema(
+        std::ostream& out,
+        schema_format format,
+        const command_info& root,
+        std::string_view version
+    ) -> void {
+        switch (format) {
+            case schema_format::json: write_json(out, root, version, 0); break;
+            case schema_format::bash: write_bash(out, root); break;
+            case schema_format::zsh: write_zsh(out, root); break;
+            case schema_format::fish: write_fish(out, root); break;
+            case schema_format::man: write_man(out, root, version); break;
+        }
+    }
+}
@@ -0,0 +1,189 @@
+#include "test.h"
+
+#include <commline/application.h>
+
+using commline::application;
+using commline::arguments;
+using commline::command;
+using commline::flag;
+using commline::list;
+using commline::option;
+using commline::optional;
+using commline::options;
+using commline::required;
+using commline::variadic;
+
+class SchemaTest : public testing::Test {
+protected:
+    static auto app() {
+        return application(
+            "tool",
+            "1.2.3",
+            "A tool for tests.",
+            options(
+                flag({"verbose", "v"}, "Print more"),
+                option<std::string_view>({"config", "c"}, "Config file", "path")
+            ),
+            arguments(optional<std::string_view>("target")),
+            [](
+                const commline::app& app,
+                bool verbose,
+                std::string_view config,
+                const std::optional<std::string_view>& target
+            ) {}
+        );
+    }
+
+    template <typename App>
+    static auto setup(App& app) -> void {
+        auto* const remote = app.subcommand(command(
+            "remote",
+            "Manage remotes",
+            options(),
+            arguments(),
+            [](const commline::app& app) {}
+        ));
+
+        remote->subcommand(command(
+            "add",
+            "Add a \"remote\"",
+            options(list<std::string_view>({"tag", "t"}, "Tags", "name")),
+            arguments(required<std::string_view>("name"), variadic<int>("ids")),
+            [](
+                const commline::app& app,
+                const std::vector<std::string_view>& tags,
+                std::string_view name,
+                const std::vector<int>& ids
+            ) {}
+        ));
+
+        app.on_error([](std::exception_ptr) {});
+    }
+
+    template <typename App>
+    static auto schema(App& app, std::string_view format) -> std::string {
+        auto out = std::ostringstream();
+
+        auto argv0 = std::string("tool");
+        auto argv1 = std::string(commline::schema_command);
+        auto argv2 = std::string(format);
+        char* argv[] = {argv0.data(), argv1.data(), argv2.data(), nullptr};
+
+        if (app.run(3, argv, out) != EXIT_SUCCESS) return "error";
+        return out.str();
+    }
+};
+
+TEST_F(SchemaTest, Describe) {
+    auto tool = app();
+    setup(tool);
+
+    const auto info = tool.describe();
+
+    ASSERT_EQ("tool", info.name);
+    ASSERT_EQ(3, info.options.size());
+    ASSERT_EQ("help", info.options[0].aliases[0]);
+    ASSERT_EQ("path", info.options[2].argument_name);
+    ASSERT_EQ(1, info.arguments.size());
+    ASSERT_EQ(commline::argument_kind::optional, info.arguments[0].kind);
+
+    ASSERT_EQ(1, info.commands.size());
+    const auto& add = info.commands[0].commands.at(0);
+
+    ASSERT_EQ("add", add.name);
+    ASSERT_TRUE(add.options[1].repeatable);
+    ASSERT_EQ(commline::argument_kind::required, add.arguments[0].kind);
+    ASSERT_EQ(commline::argument_kind::variadic, add.arguments[1].kind);
+}
+
+TEST_F(SchemaTest, Json) {
+    auto tool = app();
+    setup(tool);
+
+    ASSERT_EQ(
+        R"({
+  "name": "tool",
+  "version": "1.2.3",
+  "description": "A tool for tests.",
+  "options": [
+    {"aliases": ["help", "?"], "description": "Print information about a command", "argument": null, "repeatable": false, "dynamic": false},
+    {"aliases": ["verbose", "v"], "description": "Print more", "argument": null, "repeatable": false, "dynamic": false},
+    {"aliases": ["config", "c"], "description": "Config file", "argument": "path", "repeatable": false, "dynamic": false}
+  ],
+  "arguments": [
+    {"name": "target", "kind": "optional", "dynamic": false}
+  ],
+  "commands": [
+    {
+      "name": "remote",
+      "description": "Manage remotes",
+      "options": [
+        {"aliases": ["help", "?"], "description": "Print information about a command", "argument": null, "repeatable": false, "dynamic": false}
+      ],
+      "arguments": [],
+      "commands": [
+        {
+          "name": "add",
+          "description": "Add a \"remote\"",
+          "options": [
+            {"aliases": ["help", "?"], "description": "Print information about a command", "argument": null, "repeatable": false, "dynamic": false},
+            {"aliases": ["tag", "t"], "description": "Tags", "argument": "name", "repeatable": true, "dynamic": false}
+          ],
+          "arguments": [
+            {"name": "name", "kind": "required", "dynamic": false},
+            {"name": "ids", "kind": "variadic", "dynamic": false}
+          ],
+          "commands": []
+        }
+      ]
+    }
+  ]
+}
+)",
+        schema(tool, "json")
+    );
+}
+
+TEST_F(SchemaTest, Completion) {
+    auto tool = app();
+    setup(tool);
+
+    const auto bash = schema(tool, "bash");
+    ASSERT_NE(std::string::npos, bash.find("complete -o default -F _tool tool"));
+    ASSERT_NE(std::string::npos, bash.find("'tool remote'|'tool remote add'"));
+    ASSERT_NE(std::string::npos, bash.find("'--tag'|'-t') return ;;"));
+
+    const auto zsh = schema(tool, "zsh");
+    ASSERT_TRUE(zsh.starts_with("#compdef tool\n"));
+    ASSERT_NE(std::string::npos, zsh.find("'remote:Manage remotes'"));
+
+    const auto fish = schema(tool, "fish");
+    ASSERT_NE(
+        std::string::npos,
+        fish.find("complete -c tool -n '__tool_command tool remote add' "
+                  "-l 'tag' -s 't' -r -d 'Tags'")
+    );
+}
+
+TEST_F(SchemaTest, Man) {
+    auto tool = app();
+    setup(tool);
+
+    const auto man = schema(tool, "man");
+
+    ASSERT_TRUE(man.starts_with(".TH TOOL 1 \"\" \"tool 1.2.3\""));
+    ASSERT_NE(std::string::npos, man.find("tool \\- A tool for tests.\n"));
+    ASSERT_NE(std::string::npos, man.find(".SS \"tool remote add\"\n"));
+    ASSERT_NE(
+        std::string::npos,
+        man.find("\\fBtool remote add\\fR [options] [\\-\\-] "
+                 "\\fINAME\\fR \\fIIDS\\fR...\n")
+    );
+}
+
+TEST_F(SchemaTest, UnknownFormat) {
+    auto tool = app();
+    setup(tool);
+
+    ASSERT_EQ("error", schema(tool, "xml"));
+}
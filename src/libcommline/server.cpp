@@ -0,0 +1,736 @@
+#include <commline/application.h>
+#include <commline/error.h>
+#include <commline/server.h>
+
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <poll.h>
+#include <stdexcept>
+#include <stdio_ext.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <system_error>
+#include <unistd.h>
+#include <vector>
+
+extern char** environ;
+
+namespace {
+    using commline::standard_streams;
+
+    struct header {
+        std::uint32_t argc;
+        std::uint32_t envc;
+        std::uint32_t size;
+    };
+
+    // The largest payload a request may carry. The kernel limits the
+    // arguments and environment of a new process to a quarter of its stack,
+    // which by default is far less than this.
+    constexpr auto max_payload = std::uint32_t(16) << 20;
+
+    // The exit status of a zygote child that could not accept a connection.
+    // Every other child that exits on its own has answered its request.
+    constexpr auto accept_failed = 255;
+
+    // Children in a row that may fail to accept a connection before the
+    // zygote stops forking more.
+    constexpr auto max_accept_failures = std::size_t(8);
+
+    [[noreturn]]
+    auto fail(std::string_view what) -> void {
+        throw std::system_error(errno, std::generic_category(), what.data());
+    }
+
+    class descriptor {
+        int fd = -1;
+    public:
+        descriptor() = default;
+
+        explicit descriptor(int fd) : fd(fd) {}
+
+        descriptor(const descriptor&) = delete;
+
+        descriptor(descriptor&& other) noexcept : fd(other.release()) {}
+
+        ~descriptor() {
+            if (fd != -1) ::close(fd);
+        }
+
+        auto operator=(descriptor&& other) noexcept -> descriptor& {
+            if (this != &other) {
+                if (fd != -1) ::close(fd);
+                fd = other.release();
+            }
+
+            return *this;
+        }
+
+        auto get() const noexcept -> int { return fd; }
+
+        auto release() noexcept -> int {
+            const auto result = fd;
+            fd = -1;
+            return result;
+        }
+    };
+
+    auto address(std::string_view path) -> sockaddr_un {
+        auto result = sockaddr_un();
+        result.sun_family = AF_UNIX;
+
+        if (path.size() >= sizeof(result.sun_path)) {
+            throw std::system_error(
+                ENAMETOOLONG,
+                std::generic_category(),
+                "socket path too long"
+            );
+        }
+
+        path.copy(result.sun_path, path.size());
+        return result;
+    }
+
+    // Removes the socket left at 'path' by an earlier server, if any.
+    // Anything other than a socket is left alone and reported.
+    auto remove_socket(const char* path) -> void {
+        struct stat status;
+
+        if (::lstat(path, &status) == -1) {
+            if (errno == ENOENT) return;
+            fail("failed to check socket path");
+        }
+
+        if (!S_ISSOCK(status.st_mode)) {
+            throw std::system_error(
+                EEXIST,
+                std::generic_category(),
+                "socket path exists and is not a socket"
+            );
+        }
+
+        if (::unlink(path) == -1 && errno != ENOENT) {
+            fail("failed to remove socket");
+        }
+    }
+
+    auto write_all(int fd, const void* data, std::size_t size) -> void {
+        const auto* bytes = static_cast<const char*>(data);
+
+        while (size > 0) {
+            const auto written = ::send(fd, bytes, size, MSG_NOSIGNAL);
+
+            if (written == -1) {
+                if (errno == EINTR) continue;
+                fail("failed to write to socket");
+            }
+
+            bytes += written;
+            size -= written;
+        }
+    }
+
+    auto read_all(int fd, void* data, std::size_t size) -> void {
+        auto* bytes = static_cast<char*>(data);
+
+        while (size > 0) {
+            const auto count = ::read(fd, bytes, size);
+
+            if (count == -1) {
+                if (errno == EINTR) continue;
+                fail("failed to read from socket");
+            }
+
+            if (count == 0) {
+                throw std::system_error(
+                    ECONNRESET,
+                    std::generic_category(),
+                    "connection closed"
+                );
+            }
+
+            bytes += count;
+            size -= count;
+        }
+    }
+
+    // The header is sent along with the standard streams.
+    auto send_header(int fd, const header& head, const standard_streams& fds)
+        -> void {
+        auto data = iovec {const_cast<header*>(&head), sizeof(header)};
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * 3)] = {};
+
+        auto message = msghdr();
+        message.msg_iov = &data;
+        message.msg_iovlen = 1;
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+
+        auto* cmsg = CMSG_FIRSTHDR(&message);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int) * 3);
+        std::memcpy(CMSG_DATA(cmsg), fds.data(), sizeof(int) * 3);
+
+        while (::sendmsg(fd, &message, MSG_NOSIGNAL) == -1) {
+            if (errno != EINTR) fail("failed to send request");
+        }
+    }
+
+    auto receive_header(int fd, header& head) -> std::array<descriptor, 3> {
+        auto data = iovec {&head, sizeof(header)};
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * 3)] = {};
+
+        auto message = msghdr();
+        message.msg_iov = &data;
+        message.msg_iovlen = 1;
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+
+        auto received = ::recvmsg(fd, &message, MSG_CMSG_CLOEXEC);
+        while (received == -1 && errno == EINTR) {
+            received = ::recvmsg(fd, &message, MSG_CMSG_CLOEXEC);
+        }
+
+        if (received == -1) fail("failed to receive request");
+
+        auto result = std::array<descriptor, 3>();
+        const auto* cmsg = CMSG_FIRSTHDR(&message);
+
+        if (cmsg && cmsg->cmsg_level == SOL_SOCKET &&
+            cmsg->cmsg_type == SCM_RIGHTS &&
+            cmsg->cmsg_len == CMSG_LEN(sizeof(int) * 3)) {
+            int fds[3];
+            std::memcpy(fds, CMSG_DATA(cmsg), sizeof(fds));
+
+            for (auto i = 0; i < 3; ++i) result[i] = descriptor(fds[i]);
+        }
+        else {
+            throw std::system_error(
+                EPROTO,
+                std::generic_category(),
+                "request is missing standard streams"
+            );
+        }
+
+        if (received < static_cast<ssize_t>(sizeof(header))) {
+            read_all(
+                fd,
+                reinterpret_cast<char*>(&head) + received,
+                sizeof(header) - received
+            );
+        }
+
+        return result;
+    }
+
+    struct request {
+        std::array<descriptor, 3> streams;
+        std::vector<char> buffer;
+        std::vector<char*> argv;
+        std::vector<char*> env;
+        const char* cwd = nullptr;
+    };
+
+    // Requests run as the server's user, so only that user may send them.
+    auto check_peer(int fd) -> void {
+        auto peer = ucred();
+        auto size = socklen_t(sizeof(peer));
+
+        if (::getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &peer, &size) == -1) {
+            fail("failed to identify client");
+        }
+
+        if (peer.uid != ::geteuid()) {
+            throw std::system_error(
+                EACCES,
+                std::generic_category(),
+                "client belongs to another user"
+            );
+        }
+    }
+
+    auto receive(int fd) -> request {
+        auto head = header();
+        auto result = request();
+        result.streams = receive_header(fd, head);
+
+        // Every string takes at least its terminator, which also bounds the
+        // counts before they are used to reserve space.
+        if (head.size > max_payload ||
+            std::uint64_t(head.argc) + head.envc + 1 > head.size) {
+            throw std::system_error(
+                EMSGSIZE,
+                std::generic_category(),
+                "request is too large or malformed"
+            );
+        }
+
+        result.buffer.resize(head.size);
+        read_all(fd, result.buffer.data(), result.buffer.size());
+
+        // The payload is the working directory, the arguments and then the
+        // environment, each terminated by a NUL character.
+        auto* it = result.buffer.data();
+        auto* const end = it + result.buffer.size();
+
+        const auto next = [&]() -> char* {
+            auto* const string = it;
+            auto* const terminator = static_cast<char*>(
+                std::memchr(it, '\0', static_cast<std::size_t>(end - it))
+            );
+
+            if (!terminator) {
+                throw std::system_error(
+                    EPROTO,
+                    std::generic_category(),
+                    "malformed request"
+                );
+            }
+
+            it = terminator + 1;
+            return string;
+        };
+
+        result.cwd = next();
+
+        result.argv.reserve(head.argc + 1);
+        for (std::uint32_t i = 0; i < head.argc; ++i) {
+            result.argv.push_back(next());
+        }
+        result.argv.push_back(nullptr);
+
+        result.env.reserve(head.envc + 1);
+        for (std::uint32_t i = 0; i < head.envc; ++i) {
+            result.env.push_back(next());
+        }
+        result.env.push_back(nullptr);
+
+        // Checked once the request has been read in full, so that the
+        // client has finished sending when it is turned away.
+        check_peer(fd);
+
+        return result;
+    }
+
+    auto flush() -> void {
+        std::cout.flush();
+        std::cerr.flush();
+        std::clog.flush();
+        std::fflush(nullptr);
+    }
+
+    // Drops whatever was read ahead from standard input, so that none of it
+    // reaches the next request.
+    auto discard_input() -> void {
+        ::__fpurge(stdin);
+        std::cin.sync();
+        std::cin.clear();
+        std::clearerr(stdin);
+    }
+
+    // Makes a request's standard streams, working directory and environment
+    // those of the process. The working directory is changed first, since
+    // failing then leaves the streams untouched.
+    auto enter(const request& req) -> void {
+        if (::chdir(req.cwd) == -1) fail("failed to change directory");
+
+        for (auto i = 0; i < 3; ++i) {
+            if (::dup2(req.streams[i].get(), i) == -1) {
+                fail("failed to redirect stream");
+            }
+        }
+
+        discard_input();
+
+        environ = const_cast<char**>(req.env.data());
+    }
+
+    // Runs the handler on a request that is in place. Whatever it throws is
+    // reported on the request's standard error, as an application reports
+    // its own errors, and answered with a failing status.
+    auto handle(const commline::request_handler& handler, request& req)
+        -> std::int32_t {
+        try {
+            return handler(
+                static_cast<int>(req.argv.size() - 1),
+                req.argv.data()
+            );
+        }
+        catch (const std::system_error& ex) {
+            commline::print_error(std::current_exception());
+            return ex.code().value();
+        }
+        catch (...) {
+            commline::print_error(std::current_exception());
+            return EXIT_FAILURE;
+        }
+    }
+
+    auto respond(int connection, std::int32_t status) -> void {
+        try {
+            write_all(connection, &status, sizeof(status));
+        }
+        catch (const std::system_error&) {
+            // The client went away.
+        }
+    }
+
+    // Puts a request's standard streams, working directory and environment
+    // in place for the lifetime of the object. SIGPIPE is ignored meanwhile:
+    // a client whose output is closed early, as in 'tool | head -1', should
+    // end the handler's writes with EPIPE rather than end the server.
+    class context {
+        std::array<descriptor, 3> saved_streams;
+        descriptor saved_cwd;
+        char** saved_environ;
+        struct sigaction saved_sigpipe;
+
+        // Saves everything a request changes. The public constructor
+        // delegates to this one, so once it returns the destructor restores
+        // the process even if putting the request in place fails partway.
+        context() : saved_environ(environ) {
+            flush();
+
+            for (auto i = 0; i < 3; ++i) {
+                auto& saved = saved_streams[i];
+
+                saved = descriptor(::fcntl(i, F_DUPFD_CLOEXEC, 3));
+                if (saved.get() == -1) fail("failed to save stream");
+            }
+
+            saved_cwd = descriptor(
+                ::open(".", O_RDONLY | O_DIRECTORY | O_CLOEXEC)
+            );
+            if (saved_cwd.get() == -1) {
+                fail("failed to save working directory");
+            }
+
+            if (::sigaction(SIGPIPE, nullptr, &saved_sigpipe) == -1) {
+                fail("failed to save SIGPIPE action");
+            }
+        }
+    public:
+        context(const request& req) : context() {
+            struct sigaction ignore = {};
+            ignore.sa_handler = SIG_IGN;
+
+            if (::sigaction(SIGPIPE, &ignore, nullptr) == -1) {
+                fail("failed to ignore SIGPIPE");
+            }
+
+            enter(req);
+        }
+
+        context(const context&) = delete;
+
+        ~context() {
+            flush();
+
+            environ = saved_environ;
+            ::fchdir(saved_cwd.get());
+
+            for (auto i = 0; i < 3; ++i) ::dup2(saved_streams[i].get(), i);
+
+            discard_input();
+            std::cout.clear();
+            std::clearerr(stdout);
+
+            ::sigaction(SIGPIPE, &saved_sigpipe, nullptr);
+        }
+
+        auto operator=(const context&) -> context& = delete;
+    };
+}
+
+namespace commline {
+    server::server(std::string_view path) : path(path) {
+        const auto addr = address(path);
+
+        remove_socket(this->path.c_str());
+
+        listener = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (listener == -1) fail("failed to create socket");
+
+        // The socket file is created with the socket's mode less the umask,
+        // so restricting the socket first keeps other users from connecting.
+        if (::fchmod(listener, S_IRUSR | S_IWUSR) == -1 ||
+            ::bind(
+                listener,
+                reinterpret_cast<const sockaddr*>(&addr),
+                sizeof(addr)
+            ) == -1 ||
+            ::listen(listener, SOMAXCONN) == -1) {
+            const auto error = errno;
+            ::close(listener);
+            errno = error;
+            fail("failed to listen on socket");
+        }
+    }
+
+    server::~server() {
+        ::close(listener);
+
+        // Whatever replaced the socket since it was bound is left in place.
+        struct stat status;
+        if (::lstat(path.c_str(), &status) == 0 && S_ISSOCK(status.st_mode)) {
+            ::unlink(path.c_str());
+        }
+    }
+
+    auto server::serve(const request_handler& handler, std::size_t max_requests)
+        -> void {
+        auto count = std::size_t(0);
+
+        while (max_requests == 0 || count < max_requests) {
+            const auto connection = descriptor(
+                ::accept4(listener, nullptr, nullptr, SOCK_CLOEXEC)
+            );
+
+            if (connection.get() == -1) {
+                if (errno == EINTR || errno == ECONNABORTED) continue;
+                fail("failed to accept connection");
+            }
+
+            // Only accepted connections count as requests.
+            ++count;
+
+            auto status = std::int32_t(EXIT_FAILURE);
+
+            try {
+                auto req = receive(connection.get());
+                const auto ctx = context(req);
+
+                status = handle(handler, req);
+            }
+            catch (const std::system_error& ex) {
+                // The request could not be read or put in place. The client
+                // is still owed an answer.
+                print_error(std::current_exception());
+                status = ex.code().value();
+            }
+            catch (...) {
+                print_error(std::current_exception());
+            }
+
+            respond(connection.get(), status);
+        }
+    }
+
+    auto server::fork(
+        const request_handler& handler,
+        const zygote_config& config
+    ) -> void {
+        // Each child owns its pidfd, so that only children forked here are
+        // ever waited for.
+        auto children = std::vector<pollfd>();
+        auto completed = std::size_t(0);
+
+        // Children in a row that failed to accept a connection. No more are
+        // forked while too many have, as their replacements would likely
+        // fail as well; an answered request starts the count over.
+        auto failures = std::size_t(0);
+
+        // Waiting children count against the requests left, so that no more
+        // are forked than there are requests for them to answer.
+        const auto more = [&]() {
+            if (failures >= max_accept_failures) return false;
+
+            return config.max_requests == 0 ||
+                completed + children.size() < config.max_requests;
+        };
+
+        const auto spawn = [&]() {
+            flush();
+
+            const auto pid = ::fork();
+            if (pid == -1) fail("failed to fork");
+
+            if (pid == 0) {
+                // The child handles a single request with everything the
+                // parent set up already in memory, then exits without running
+                // the parent's cleanup.
+                auto status = std::int32_t(EXIT_FAILURE);
+
+                auto connection = descriptor(
+                    ::accept4(listener, nullptr, nullptr, SOCK_CLOEXEC)
+                );
+
+                while (connection.get() == -1) {
+                    if (errno != EINTR && errno != ECONNABORTED) {
+                        print_error(std::make_exception_ptr(std::system_error(
+                            errno,
+                            std::generic_category(),
+                            "failed to accept connection"
+                        )));
+                        flush();
+                        ::_exit(accept_failed);
+                    }
+
+                    connection = descriptor(
+                        ::accept4(listener, nullptr, nullptr, SOCK_CLOEXEC)
+                    );
+                }
+
+                ::close(listener);
+                for (const auto& child : children) ::close(child.fd);
+
+                try {
+                    auto req = receive(connection.get());
+                    enter(req);
+
+                    status = handle(handler, req);
+                }
+                catch (const std::system_error& ex) {
+                    print_error(std::current_exception());
+                    status = ex.code().value();
+                }
+                catch (...) {
+                    print_error(std::current_exception());
+                }
+
+                flush();
+                respond(connection.get(), status);
+
+                // The client has the handler's status. The parent only needs
+                // to know that the request was answered.
+                ::_exit(EXIT_SUCCESS);
+            }
+
+            const auto pidfd =
+                static_cast<int>(::syscall(SYS_pidfd_open, pid, 0));
+            if (pidfd == -1) fail("failed to open child process");
+
+            children.push_back({pidfd, POLLIN, 0});
+        };
+
+        while (children.size() < config.pool_size && more()) spawn();
+
+        while (!children.empty()) {
+            if (::poll(children.data(), children.size(), -1) == -1) {
+                if (errno == EINTR) continue;
+                fail("failed to wait for child processes");
+            }
+
+            std::erase_if(children, [&](const pollfd& child) {
+                if (!child.revents) return false;
+
+                auto info = siginfo_t();
+                ::waitid(P_PIDFD, child.fd, &info, WEXITED);
+                ::close(child.fd);
+
+                // A child that failed or was killed before answering is
+                // replaced without using up a request.
+                if (info.si_code == CLD_EXITED) {
+                    if (info.si_status == EXIT_SUCCESS) {
+                        ++completed;
+                        failures = 0;
+                    }
+                    else if (info.si_status == accept_failed) {
+                        ++failures;
+                    }
+                }
+
+                return true;
+            });
+
+            while (children.size() < config.pool_size && more()) spawn();
+        }
+
+        if (failures >= max_accept_failures) {
+            throw std::runtime_error(
+                "child processes repeatedly failed to accept connections"
+            );
+        }
+    }
+
+    auto forward(
+        std::string_view path,
+        int argc,
+        char** argv,
+        standard_streams streams
+    ) -> int {
+        const auto addr = address(path);
+        const auto connection =
+            descriptor(::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0));
+
+        if (connection.get() == -1) fail("failed to create socket");
+
+        if (::connect(
+                connection.get(),
+                reinterpret_cast<const sockaddr*>(&addr),
+                sizeof(addr)
+            ) == -1) {
+            fail("failed to connect to server");
+        }
+
+        auto cwd = std::vector<char>(256);
+        while (!::getcwd(cwd.data(), cwd.size())) {
+            if (errno != ERANGE) fail("failed to get working directory");
+            cwd.resize(cwd.size() * 2);
+        }
+
+        auto payload = std::vector<char>();
+        const auto append = [&payload](const char* string) {
+            payload.insert(payload.end(), string, string + std::strlen(string));
+            payload.push_back('\0');
+        };
+
+        append(cwd.data());
+        for (auto i = 0; i < argc; ++i) append(argv[i]);
+
+        auto envc = std::uint32_t(0);
+        for (auto** env = environ; *env; ++env, ++envc) append(*env);
+
+        if (payload.size() > max_payload) {
+            throw std::system_error(
+                E2BIG,
+                std::generic_category(),
+                "command line is too large to forward"
+            );
+        }
+
+        const auto head = header {
+            static_cast<std::uint32_t>(argc),
+            envc,
+            static_cast<std::uint32_t>(payload.size())};
+
+        send_header(connection.get(), head, streams);
+        write_all(connection.get(), payload.data(), payload.size());
+
+        auto status = std::int32_t();
+        read_all(connection.get(), &status, sizeof(status));
+
+        return status;
+    }
+
+    auto application_base::serve(server& server, std::size_t max_requests)
+        -> void {
+        server.serve(
+            [this](int argc, char** argv) { return run(argc, argv); },
+            max_requests
+        );
+    }
+
+    auto application_base::zygote(server& server) -> void {
+        zygote(server, {});
+    }
+
+    auto application_base::zygote(
+        server& server,
+        const zygote_config& config
+    ) -> void {
+        server.fork(
+            [this](int argc, char** argv) { return run(argc, argv); },
+            config
+        );
+    }
+}
@@ -0,0 +1,626 @@
+#include "test.h"
+
+#include <commline/application.h>
+#include <commline/server.h>
+
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+
+using commline::application;
+using commline::arguments;
+using commline::flag;
+using commline::options;
+using commline::variadic;
+
+namespace {
+    struct pipe_pair {
+        int read = -1;
+        int write = -1;
+
+        pipe_pair() {
+            int fds[2];
+            if (::pipe2(fds, O_CLOEXEC) == -1) {
+                throw std::system_error(errno, std::generic_category());
+            }
+
+            read = fds[0];
+            write = fds[1];
+        }
+
+        ~pipe_pair() {
+            close_read();
+            close_write();
+        }
+
+        auto close_read() -> void {
+            if (read != -1) ::close(std::exchange(read, -1));
+        }
+
+        auto close_write() -> void {
+            if (write != -1) ::close(std::exchange(write, -1));
+        }
+
+        auto contents() -> std::string {
+            close_write();
+
+            auto result = std::string();
+            char buffer[256];
+
+            while (true) {
+                const auto count = ::read(read, buffer, sizeof(buffer));
+                if (count <= 0) break;
+                result.append(buffer, count);
+            }
+
+            return result;
+        }
+    };
+
+    // Sends a request header claiming a payload of 'size' bytes, along
+    // with the standard streams, and returns the status the server answers
+    // with.
+    auto send_header(const std::string& path, std::uint32_t size) -> int {
+        const auto fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+        auto addr = sockaddr_un();
+        addr.sun_family = AF_UNIX;
+        path.copy(addr.sun_path, sizeof(addr.sun_path) - 1);
+
+        if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr))) {
+            throw std::system_error(errno, std::generic_category());
+        }
+
+        std::uint32_t head[] = {1, 0, size};
+        int streams[] = {STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO};
+
+        auto data = iovec {head, sizeof(head)};
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(streams))] = {};
+
+        auto message = msghdr();
+        message.msg_iov = &data;
+        message.msg_iovlen = 1;
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+
+        auto* cmsg = CMSG_FIRSTHDR(&message);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(streams));
+        std::memcpy(CMSG_DATA(cmsg), streams, sizeof(streams));
+
+        auto status = std::int32_t(-1);
+
+        if (::sendmsg(fd, &message, MSG_NOSIGNAL) == -1 ||
+            ::read(fd, &status, sizeof(status)) != sizeof(status)) {
+            status = -1;
+        }
+
+        ::close(fd);
+        return status;
+    }
+}
+
+class ServerTest : public testing::Test {
+protected:
+    const std::string path =
+        "/tmp/commline.test." + std::to_string(::getpid()) + ".sock";
+
+    pipe_pair in;
+    pipe_pair out;
+    pipe_pair err;
+
+    // Forwards a command line 'requests' times from a separate process,
+    // which runs in 'directory' with 'COMMLINE_TEST' set to 'env'. Returns
+    // the sum of the exit statuses once 'serve' has returned.
+    template <typename Serve>
+    auto forward(
+        const char* directory,
+        const char* env,
+        std::vector<std::string> args,
+        Serve&& serve,
+        int requests = 1
+    ) -> int {
+        auto server = commline::server(path);
+
+        const auto pid = ::fork();
+        if (pid == -1) throw std::system_error(errno, std::generic_category());
+
+        if (pid == 0) {
+            auto argv = std::vector<char*>();
+            for (auto& arg : args) argv.push_back(arg.data());
+
+            if (::chdir(directory) == -1) ::_exit(127);
+            ::setenv("COMMLINE_TEST", env, 1);
+
+            try {
+                auto sum = 0;
+
+                for (auto i = 0; i < requests; ++i) {
+                    sum += commline::forward(
+                        path,
+                        argv.size(),
+                        argv.data(),
+                        {in.read, out.write, err.write}
+                    );
+                }
+
+                ::_exit(sum);
+            }
+            catch (...) {
+                ::_exit(127);
+            }
+        }
+
+        serve(server);
+
+        int status = 0;
+        ::waitpid(pid, &status, 0);
+        return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    }
+};
+
+TEST_F(ServerTest, RequestContext) {
+    auto input = std::string();
+    auto env = std::string();
+    auto cwd = std::string();
+    auto values = std::vector<std::string>();
+    auto verbose = false;
+
+    auto app = application(
+        "app",
+        "0.0.0",
+        "Server test.",
+        options(flag({"verbose", "v"}, "")),
+        arguments(variadic<std::string_view>("values")),
+        [&](
+            const commline::app& app,
+            bool v,
+            const std::vector<std::string_view>& vals
+        ) {
+            verbose = v;
+            values.assign(vals.begin(), vals.end());
+
+            std::getline(std::cin, input);
+
+            const auto* const var = std::getenv("COMMLINE_TEST");
+            env = var ? var : "";
+
+            char buffer[256];
+            cwd = ::getcwd(buffer, sizeof(buffer));
+
+            std::cout << "out: " << app.argv0 << std::endl;
+            std::cerr << "err" << std::endl;
+        }
+    );
+
+    const auto* const before = std::getenv("COMMLINE_TEST");
+    char saved_cwd[256];
+    ::getcwd(saved_cwd, sizeof(saved_cwd));
+
+    ASSERT_EQ(3, ::write(in.write, "in\n", 3));
+    in.close_write();
+
+    const auto status = forward(
+        "/",
+        "remote",
+        {"./client", "-v", "one", "two"},
+        [&](commline::server& server) { app.serve(server, 1); }
+    );
+
+    ASSERT_EQ(EXIT_SUCCESS, status);
+    ASSERT_TRUE(verbose);
+    ASSERT_EQ((std::vector<std::string> {"one", "two"}), values);
+    ASSERT_EQ("in", input);
+    ASSERT_EQ("remote", env);
+    ASSERT_EQ("/", cwd);
+    ASSERT_EQ("out: ./client\n", out.contents());
+    ASSERT_EQ("err\n", err.contents());
+
+    char after_cwd[256];
+    ::getcwd(after_cwd, sizeof(after_cwd));
+
+    ASSERT_EQ(before, std::getenv("COMMLINE_TEST"));
+    ASSERT_STREQ(saved_cwd, after_cwd);
+}
+
+TEST_F(ServerTest, ExitStatus) {
+    auto app = application(
+        "app",
+        "0.0.0",
+        "Server test.",
+        options(),
+        arguments(),
+        [](const commline::app& app) {
+            throw std::system_error(
+                ENOENT,
+                std::generic_category(),
+                "remote failure"
+            );
+        }
+    );
+
+    const auto status = forward(
+        "/tmp",
+        "",
+        {"./client"},
+        [&](commline::server& server) { app.serve(server, 1); }
+    );
+
+    ASSERT_EQ(ENOENT, status);
+    ASSERT_TRUE(err.contents().starts_with("remote failure"));
+    ASSERT_EQ("", out.contents());
+}
+
+TEST_F(ServerTest, ManyRequests) {
+    auto calls = 0;
+
+    auto app = application(
+        "app",
+        "0.0.0",
+        "Server test.",
+        options(),
+        arguments(),
+        [&calls](const commline::app& app) {
+            std::cout << ++calls << std::endl;
+        }
+    );
+
+    auto server = commline::server(path);
+    auto handled = std::thread([&] { app.serve(server, 3); });
+
+    char arg[] = "./client";
+    char* argv[] = {arg, nullptr};
+
+    auto statuses = std::vector<int>();
+
+    for (auto i = 0; i < 3; ++i) {
+        statuses.push_back(
+            commline::forward(path, 1, argv, {in.read, out.write, err.write})
+        );
+    }
+
+    handled.join();
+
+    ASSERT_EQ((std::vector<int> {0, 0, 0}), statuses);
+    ASSERT_EQ(3, calls);
+    ASSERT_EQ("1\n2\n3\n", out.contents());
+}
+
+TEST_F(ServerTest, InputNotShared) {
+    auto lines = std::vector<std::string>();
+
+    auto server = commline::server(path);
+    auto handled = std::thread([&] {
+        server.serve(
+            [&lines](int argc, char** argv) -> int {
+                auto line = std::string();
+                std::getline(std::cin, line);
+                lines.push_back(line);
+                return EXIT_SUCCESS;
+            },
+            2
+        );
+    });
+
+    char arg[] = "./client";
+    char* argv[] = {arg, nullptr};
+
+    // The first client sends more than its handler reads, all of which
+    // stdio is likely to have read ahead. The second sends nothing.
+    auto first = pipe_pair();
+    const auto input = std::string_view("first-a\nsecret-b\n");
+    ASSERT_EQ(
+        static_cast<ssize_t>(input.size()),
+        ::write(first.write, input.data(), input.size())
+    );
+    first.close_write();
+
+    auto second = pipe_pair();
+    second.close_write();
+
+    const auto first_status =
+        commline::forward(path, 1, argv, {first.read, out.write, err.write});
+    const auto second_status =
+        commline::forward(path, 1, argv, {second.read, out.write, err.write});
+
+    handled.join();
+
+    ASSERT_EQ(0, first_status);
+    ASSERT_EQ(0, second_status);
+    ASSERT_EQ((std::vector<std::string> {"first-a", ""}), lines);
+}
+
+TEST_F(ServerTest, Zygote) {
+    auto calls = 0;
+
+    auto app = application(
+        "app",
+        "0.0.0",
+        "Server test.",
+        options(),
+        arguments(),
+        [&calls](const commline::app& app) {
+            // Changes made by one request must not be seen by the next.
+            if (std::getenv("COMMLINE_ZYGOTE")) std::cout << "leaked ";
+            ::setenv("COMMLINE_ZYGOTE", "1", 1);
+
+            std::cout << ++calls << std::endl;
+        }
+    );
+
+    const auto status = forward(
+        "/",
+        "",
+        {"./client"},
+        [&](commline::server& server) {
+            app.zygote(server, {.pool_size = 2, .max_requests = 3});
+        },
+        3
+    );
+
+    ASSERT_EQ(EXIT_SUCCESS, status);
+    ASSERT_EQ("1\n1\n1\n", out.contents());
+    ASSERT_EQ(0, calls);
+    ASSERT_EQ(nullptr, std::getenv("COMMLINE_ZYGOTE"));
+}
+
+TEST_F(ServerTest, ZygoteExitStatus) {
+    auto app = application(
+        "app",
+        "0.0.0",
+        "Server test.",
+        options(),
+        arguments(),
+        [](const commline::app& app) {
+            throw std::system_error(
+                EACCES,
+                std::generic_category(),
+                "child failure"
+            );
+        }
+    );
+
+    const auto status = forward(
+        "/",
+        "",
+        {"./client"},
+        [&](commline::server& server) {
+            app.zygote(server, {.pool_size = 1, .max_requests = 1});
+        }
+    );
+
+    ASSERT_EQ(EACCES, status);
+    ASSERT_TRUE(err.contents().starts_with("child failure"));
+}
+
+TEST_F(ServerTest, ZygoteReplacesKilledChild) {
+    auto server = commline::server(path);
+
+    const auto pid = ::fork();
+    ASSERT_NE(-1, pid);
+
+    if (pid == 0) {
+        char name[] = "client";
+        char kill[] = "kill";
+        char* first[] = {name, kill, nullptr};
+        char* second[] = {name, nullptr};
+
+        const auto streams =
+            commline::standard_streams {in.read, out.write, err.write};
+
+        try {
+            commline::forward(path, 2, first, streams);
+        }
+        catch (const std::system_error& ex) {
+            try {
+                ::_exit(commline::forward(path, 1, second, streams));
+            }
+            catch (...) {}
+        }
+
+        ::_exit(127);
+    }
+
+    // The request that killed its child was never answered, so it does not
+    // count towards the one request the server waits for.
+    server.fork(
+        [](int argc, char** argv) -> int {
+            if (argc > 1) std::raise(SIGKILL);
+            return 3;
+        },
+        {.pool_size = 1, .max_requests = 1}
+    );
+
+    int status = 0;
+    ::waitpid(pid, &status, 0);
+
+    ASSERT_TRUE(WIFEXITED(status));
+    ASSERT_EQ(3, WEXITSTATUS(status));
+}
+
+TEST_F(ServerTest, OversizedRequest) {
+    auto server = commline::server(path);
+    auto statuses = std::vector<int>();
+
+    auto handled = std::thread([&] {
+        server.serve([](int argc, char** argv) { return 3; }, 3);
+    });
+
+    statuses.push_back(send_header(path, 0xffffffff));
+    statuses.push_back(send_header(path, 0));
+
+    char arg[] = "./client";
+    char* argv[] = {arg, nullptr};
+    statuses.push_back(
+        commline::forward(path, 1, argv, {in.read, out.write, err.write})
+    );
+
+    handled.join();
+
+    ASSERT_EQ((std::vector<int> {EMSGSIZE, EMSGSIZE, 3}), statuses);
+}
+
+TEST_F(ServerTest, HandlerError) {
+    const auto status = forward(
+        "/",
+        "",
+        {"./client"},
+        [&](commline::server& server) {
+            server.serve(
+                [](int argc, char** argv) -> int {
+                    throw std::runtime_error("handler failure");
+                },
+                1
+            );
+        }
+    );
+
+    ASSERT_EQ(EXIT_FAILURE, status);
+    ASSERT_TRUE(err.contents().starts_with("handler failure"));
+}
+
+TEST_F(ServerTest, ClosedOutput) {
+    // Nothing reads the request's standard output, as when the client is
+    // piped into 'head' and it has already exited.
+    out.close_read();
+
+    const auto status = forward(
+        "/",
+        "",
+        {"./client"},
+        [&](commline::server& server) {
+            server.serve(
+                [](int argc, char** argv) -> int {
+                    if (::write(STDOUT_FILENO, "x", 1) == -1) return errno;
+                    return EXIT_SUCCESS;
+                },
+                1
+            );
+        }
+    );
+
+    ASSERT_EQ(EPIPE, status);
+
+    struct sigaction action;
+    ASSERT_EQ(0, ::sigaction(SIGPIPE, nullptr, &action));
+    ASSERT_EQ(SIG_DFL, action.sa_handler);
+}
+
+TEST_F(ServerTest, ZygoteHandlerError) {
+    const auto status = forward(
+        "/",
+        "",
+        {"./client"},
+        [&](commline::server& server) {
+            server.fork(
+                [](int argc, char** argv) -> int {
+                    throw std::runtime_error("handler failure");
+                },
+                {.pool_size = 1, .max_requests = 1}
+            );
+        }
+    );
+
+    ASSERT_EQ(EXIT_FAILURE, status);
+    ASSERT_TRUE(err.contents().starts_with("handler failure"));
+}
+
+TEST_F(ServerTest, ZygoteAcceptFailure) {
+    auto server = commline::server(path);
+
+    // With no client waiting, every child fails to accept a connection.
+    const auto flags = ::fcntl(server.socket(), F_GETFL);
+    ASSERT_NE(-1, ::fcntl(server.socket(), F_SETFL, flags | O_NONBLOCK));
+
+    auto calls = 0;
+
+    ASSERT_THROW(
+        server.fork(
+            [&calls](int argc, char** argv) { return ++calls; },
+            {.pool_size = 2}
+        ),
+        std::runtime_error
+    );
+    ASSERT_EQ(0, calls);
+}
+
+TEST_F(ServerTest, OwnerOnly) {
+    auto server = commline::server(path);
+
+    struct stat status;
+    ASSERT_EQ(0, ::stat(path.c_str(), &status));
+    ASSERT_EQ(S_IRUSR | S_IWUSR, status.st_mode & 07777);
+}
+
+TEST_F(ServerTest, ForeignPeer) {
+    if (::geteuid() != 0) GTEST_SKIP() << "Switching users requires root.";
+
+    auto server = commline::server(path);
+
+    // Let the other user reach the socket, so that the server itself must
+    // turn the request away.
+    ASSERT_EQ(0, ::chmod(path.c_str(), 0666));
+
+    const auto pid = ::fork();
+    ASSERT_NE(-1, pid);
+
+    if (pid == 0) {
+        if (::setgid(65534) == -1 || ::setuid(65534) == -1) ::_exit(126);
+
+        char name[] = "client";
+        char* argv[] = {name, nullptr};
+
+        try {
+            ::_exit(commline::forward(path, 1, argv));
+        }
+        catch (...) {
+            ::_exit(127);
+        }
+    }
+
+    auto called = false;
+
+    server.serve(
+        [&called](int argc, char** argv) -> int {
+            called = true;
+            return EXIT_SUCCESS;
+        },
+        1
+    );
+
+    int status = 0;
+    ::waitpid(pid, &status, 0);
+
+    ASSERT_TRUE(WIFEXITED(status));
+    ASSERT_EQ(EACCES, WEXITSTATUS(status));
+    ASSERT_FALSE(called);
+}
+
+TEST_F(ServerTest, PathIsNotSocket) {
+    const auto fd = ::open(path.c_str(), O_CREAT | O_WRONLY | O_CLOEXEC, 0600);
+    ASSERT_NE(-1, fd);
+    ::close(fd);
+
+    try {
+        auto server = commline::server(path);
+        FAIL() << "The server should not replace a regular file";
+    }
+    catch (const std::system_error& ex) {
+        ASSERT_EQ(EEXIST, ex.code().value());
+    }
+
+    struct stat status;
+    ASSERT_EQ(0, ::lstat(path.c_str(), &status));
+    ASSERT_TRUE(S_ISREG(status.st_mode));
+
+    ::unlink(path.c_str());
+}
@@ -0,0 +1,29 @@
+#include <commline/storage.h>
+
+#include <cstdint>
+
+namespace commline {
+    auto fixed_buffer_resource::do_allocate(
+        std::size_t bytes,
+        std::size_t alignment
+    ) -> void* {
+        const auto address =
+            reinterpret_cast<std::uintptr_t>(buffer.data()) + used;
+        const auto padding = (alignment - address % alignment) % alignment;
+
+        if (padding + bytes <= buffer.size() - used) {
+            auto* const result = buffer.data() + used + padding;
+            used += padding + bytes;
+            return result;
+        }
+
+        overflowed = true;
+        return overflow.allocate(bytes, alignment);
+    }
+
+    auto fixed_buffer_resource::release() -> void {
+        used = 0;
+        overflowed = false;
+        overflow.release();
+    }
+}
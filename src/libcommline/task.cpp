@@ -0,0 +1,266 @@
+#include <commline/task.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <ctime>
+#include <stdexcept>
+#include <sys/epoll.h>
+#include <sys/syscall.h>
+#include <sys/timerfd.h>
+#include <sys/wait.h>
+#include <system_error>
+#include <unistd.h>
+
+namespace {
+    thread_local commline::event_loop* running = nullptr;
+
+    [[noreturn]]
+    auto fail(const char* what) -> void {
+        throw std::system_error(errno, std::generic_category(), what);
+    }
+}
+
+namespace commline {
+    event_loop::event_loop() : epoll(::epoll_create1(EPOLL_CLOEXEC)) {
+        if (epoll == -1) fail("failed to create event loop");
+    }
+
+    event_loop::~event_loop() { ::close(epoll); }
+
+    auto event_loop::current() -> event_loop& {
+        if (!running) throw std::logic_error("no event loop is running");
+        return *running;
+    }
+
+    auto event_loop::run(task& task) -> void {
+        struct scope {
+            event_loop* const loop;
+            event_loop* const previous;
+
+            ~scope() {
+                running = previous;
+                loop->clear();
+            }
+        } const scope {this, std::exchange(running, this)};
+
+        task.get().resume();
+
+        epoll_event events[64];
+
+        while (!task.done()) {
+            if (waiting == 0) {
+                throw std::logic_error(
+                    "task is suspended but not waiting for any event"
+                );
+            }
+
+            const auto count =
+                ::epoll_wait(epoll, events, std::size(events), -1);
+
+            if (count == -1) {
+                if (errno == EINTR) continue;
+                fail("failed to wait for events");
+            }
+
+            for (auto i = 0; i < count; ++i) {
+                dispatch(events[i].data.fd, events[i].events);
+            }
+        }
+
+        task.result();
+    }
+
+    auto event_loop::arm(int fd, int op, const std::vector<waiter>& list)
+        -> bool {
+        // Registrations are one-shot, so that a descriptor is not reported
+        // again before its waiters have been dispatched.
+        auto event = epoll_event();
+        event.events = EPOLLONESHOT;
+        event.data.fd = fd;
+
+        for (const auto& waiter : list) event.events |= waiter.events;
+
+        if (::epoll_ctl(epoll, op, fd, &event) == -1) {
+            if (errno == EPERM) return false;
+            fail("failed to wait for file descriptor");
+        }
+
+        return true;
+    }
+
+    auto event_loop::clear() -> void {
+        for (const auto& [fd, list] : waiters) {
+            ::epoll_ctl(epoll, EPOLL_CTL_DEL, fd, nullptr);
+        }
+
+        waiters.clear();
+        waiting = 0;
+    }
+
+    auto event_loop::dispatch(int fd, std::uint32_t events) -> void {
+        auto entry = waiters.find(fd);
+        if (entry == waiters.end()) return;
+
+        auto& list = entry->second;
+        auto ready = std::vector<std::coroutine_handle<>>();
+
+        // Errors and hangups are reported to every waiter, whatever it was
+        // waiting for, since its next call on the descriptor will see them.
+        const auto any = (events & (EPOLLERR | EPOLLHUP)) != 0;
+
+        std::erase_if(list, [&](const waiter& waiter) {
+            if (!any && (waiter.events & events) == 0) return false;
+
+            ready.push_back(waiter.coroutine);
+            return true;
+        });
+
+        // The waiters left are rearmed before any are resumed, as resumed
+        // coroutines may wait on the descriptor again or close it.
+        if (list.empty()) {
+            waiters.erase(entry);
+            ::epoll_ctl(epoll, EPOLL_CTL_DEL, fd, nullptr);
+        }
+        else arm(fd, EPOLL_CTL_MOD, list);
+
+        waiting -= ready.size();
+        for (const auto coroutine : ready) coroutine.resume();
+    }
+
+    auto event_loop::wait(
+        int fd,
+        std::uint32_t events,
+        std::coroutine_handle<> coroutine
+    ) -> bool {
+        auto [entry, inserted] = waiters.try_emplace(fd);
+        auto& list = entry->second;
+
+        list.push_back({events, coroutine});
+
+        if (!arm(fd, inserted ? EPOLL_CTL_ADD : EPOLL_CTL_MOD, list)) {
+            list.pop_back();
+            if (list.empty()) waiters.erase(entry);
+            return false;
+        }
+
+        ++waiting;
+        return true;
+    }
+
+    auto run(task task) -> void {
+        if (running) {
+            auto loop = event_loop();
+            loop.run(task);
+            return;
+        }
+
+        thread_local auto loop = event_loop();
+        loop.run(task);
+    }
+
+    auto readable(int fd) -> fd_awaiter { return {fd, EPOLLIN}; }
+
+    auto writable(int fd) -> fd_awaiter { return {fd, EPOLLOUT}; }
+
+    read_awaiter::read_awaiter(int fd, std::span<std::byte> buffer) :
+        ready(readable(fd)),
+        buffer(buffer) {}
+
+    auto read_awaiter::await_resume() const -> std::size_t {
+        while (true) {
+            const auto count = ::read(ready.fd, buffer.data(), buffer.size());
+
+            if (count >= 0) return count;
+            if (errno != EINTR) fail("failed to read");
+        }
+    }
+
+    auto read(int fd, std::span<std::byte> buffer) -> read_awaiter {
+        return read_awaiter(fd, buffer);
+    }
+
+    sleep_awaiter::sleep_awaiter(std::chrono::nanoseconds duration) :
+        timer(::timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC)) {
+        if (timer == -1) fail("failed to create timer");
+
+        // A zero expiration would disarm the timer instead.
+        const auto ns = std::max(duration.count(), std::int64_t(1));
+
+        auto spec = itimerspec();
+        spec.it_value.tv_sec = ns / 1'000'000'000;
+        spec.it_value.tv_nsec = ns % 1'000'000'000;
+
+        if (::timerfd_settime(timer, 0, &spec, nullptr) == -1) {
+            const auto error = errno;
+            ::close(timer);
+            errno = error;
+            fail("failed to set timer");
+        }
+    }
+
+    sleep_awaiter::~sleep_awaiter() { ::close(timer); }
+
+    auto sleep_awaiter::await_suspend(std::coroutine_handle<> coroutine) const
+        -> bool {
+        return event_loop::current().wait(timer, EPOLLIN, coroutine);
+    }
+
+    auto sleep_for(std::chrono::nanoseconds duration) -> sleep_awaiter {
+        return sleep_awaiter(duration);
+    }
+
+    process_awaiter::process_awaiter(pid_t pid) :
+        pidfd(static_cast<int>(::syscall(SYS_pidfd_open, pid, 0))) {
+        if (pidfd == -1) fail("failed to open process");
+    }
+
+    process_awaiter::~process_awaiter() { ::close(pidfd); }
+
+    auto process_awaiter::await_suspend(std::coroutine_handle<> coroutine)
+        const -> bool {
+        return event_loop::current().wait(pidfd, EPOLLIN, coroutine);
+    }
+
+    auto process_awaiter::await_resume() const -> int {
+        auto info = siginfo_t();
+
+        while (::waitid(P_PIDFD, pidfd, &info, WEXITED) == -1) {
+            if (errno != EINTR) fail("failed to wait for process");
+        }
+
+        if (info.si_code == CLD_EXITED) return info.si_status;
+        return 128 + info.si_status;
+    }
+
+    auto wait_process(pid_t pid) -> process_awaiter {
+        return process_awaiter(pid);
+    }
+
+    all_awaiter::all_awaiter(std::vector<task>&& tasks) :
+        tasks(std::move(tasks)) {}
+
+    auto all_awaiter::await_suspend(std::coroutine_handle<> coroutine)
+        -> bool {
+        // The extra count keeps a task that finishes right away from
+        // resuming the awaiting coroutine before all have started.
+        remaining = tasks.size() + 1;
+
+        for (auto& task : tasks) {
+            auto& promise = task.get().promise();
+            promise.continuation = coroutine;
+            promise.remaining = &remaining;
+
+            task.get().resume();
+        }
+
+        return --remaining > 0;
+    }
+
+    auto all_awaiter::await_resume() const -> void {
+        for (const auto& task : tasks) task.result();
+    }
+
+    auto when_all(std::vector<task>&& tasks) -> all_awaiter {
+        return all_awaiter(std::move(tasks));
+    }
+}
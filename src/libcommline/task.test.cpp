@@ -0,0 +1,247 @@
+#include "test.h"
+
+#include <commline/application.h>
+#include <commline/task.h>
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using commline::application;
+using commline::arguments;
+using commline::options;
+using commline::required;
+using commline::task;
+
+using namespace std::chrono_literals;
+
+class TaskTest : public testing::Test {
+protected:
+    static inline auto error = false;
+
+    int pipe[2] = {-1, -1};
+
+    auto SetUp() -> void override {
+        error = false;
+        ASSERT_EQ(0, ::pipe2(pipe, O_CLOEXEC));
+    }
+
+    auto TearDown() -> void override {
+        for (const auto fd : pipe) {
+            if (fd != -1) ::close(fd);
+        }
+    }
+
+    template <typename Callable>
+    static auto app(Callable&& fn) {
+        return application(
+            "app",
+            "0.0.0",
+            "Task test.",
+            options(),
+            arguments(required<int>("n")),
+            std::move(fn)
+        );
+    }
+
+    template <typename App>
+    static auto run(App& app, std::string_view n) -> int {
+        app.on_error([](std::exception_ptr) { error = true; });
+
+        auto arg0 = std::string("app");
+        auto arg1 = std::string(n);
+        char* argv[] = {arg0.data(), arg1.data(), nullptr};
+
+        return app.run(2, argv);
+    }
+};
+
+TEST_F(TaskTest, Read) {
+    auto received = std::string();
+
+    auto test = app([&](const commline::app& app, int n) -> task {
+        co_await commline::sleep_for(1ms);
+
+        auto buffer = std::array<std::byte, 16>();
+        const auto count = co_await commline::read(pipe[0], buffer);
+
+        received.assign(reinterpret_cast<const char*>(buffer.data()), count);
+        received += std::to_string(n);
+    });
+
+    ASSERT_EQ(5, ::write(pipe[1], "hello", 5));
+
+    ASSERT_EQ(EXIT_SUCCESS, run(test, "1"));
+    ASSERT_EQ("hello1", received);
+}
+
+TEST_F(TaskTest, WhenAll) {
+    auto finished = std::vector<int>();
+
+    const auto sleep = [&finished](int ms) -> task {
+        co_await commline::sleep_for(std::chrono::milliseconds(ms));
+        finished.push_back(ms);
+    };
+
+    auto test = app([&](const commline::app& app, int n) -> task {
+        auto tasks = std::vector<task>();
+
+        tasks.push_back(sleep(30 * n));
+        tasks.push_back(sleep(10 * n));
+        tasks.push_back(sleep(20 * n));
+        tasks.push_back(sleep(0));
+
+        co_await commline::when_all(std::move(tasks));
+        finished.push_back(-1);
+    });
+
+    ASSERT_EQ(EXIT_SUCCESS, run(test, "1"));
+    ASSERT_EQ((std::vector<int> {0, 10, 20, 30, -1}), finished);
+}
+
+TEST_F(TaskTest, WaitSameDescriptor) {
+    auto received = std::string();
+
+    const auto read = [&](int fd) -> task {
+        auto buffer = std::array<std::byte, 1>();
+        const auto count = co_await commline::read(fd, buffer);
+
+        received.append(reinterpret_cast<const char*>(buffer.data()), count);
+    };
+
+    auto test = app([&](const commline::app& app, int n) -> task {
+        auto tasks = std::vector<task>();
+
+        for (auto i = 0; i < n; ++i) tasks.push_back(read(pipe[0]));
+
+        co_await commline::when_all(std::move(tasks));
+    });
+
+    ASSERT_EQ(2, ::write(pipe[1], "ab", 2));
+
+    ASSERT_EQ(EXIT_SUCCESS, run(test, "2"));
+    ASSERT_EQ("ab", received);
+}
+
+TEST_F(TaskTest, WaitReadAndWrite) {
+    int sockets[2] = {-1, -1};
+    ASSERT_EQ(
+        0,
+        ::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sockets)
+    );
+
+    auto steps = std::vector<std::string>();
+
+    const auto reader = [&]() -> task {
+        co_await commline::readable(sockets[0]);
+        steps.push_back("read");
+    };
+
+    // Becomes writable right away and wakes the reader.
+    const auto writer = [&]() -> task {
+        co_await commline::writable(sockets[0]);
+        steps.push_back("write");
+
+        if (::write(sockets[1], "x", 1) != 1) {
+            throw std::system_error(errno, std::generic_category());
+        }
+    };
+
+    auto test = app([&](const commline::app& app, int n) -> task {
+        auto tasks = std::vector<task>();
+
+        tasks.push_back(reader());
+        tasks.push_back(writer());
+
+        co_await commline::when_all(std::move(tasks));
+    });
+
+    const auto status = run(test, "1");
+
+    for (const auto fd : sockets) ::close(fd);
+
+    ASSERT_EQ(EXIT_SUCCESS, status);
+    ASSERT_EQ((std::vector<std::string> {"write", "read"}), steps);
+}
+
+TEST_F(TaskTest, Await) {
+    auto steps = std::vector<int>();
+
+    const auto step = [&steps](int n) -> task {
+        co_await commline::sleep_for(1ms);
+        steps.push_back(n);
+    };
+
+    auto test = app([&](const commline::app& app, int n) -> task {
+        for (auto i = 0; i < n; ++i) co_await step(i);
+    });
+
+    ASSERT_EQ(EXIT_SUCCESS, run(test, "3"));
+    ASSERT_EQ((std::vector<int> {0, 1, 2}), steps);
+}
+
+TEST_F(TaskTest, WaitProcess) {
+    auto status = -1;
+
+    auto test = app([&](const commline::app& app, int n) -> task {
+        const auto pid = ::fork();
+        if (pid == 0) ::_exit(n);
+
+        status = co_await commline::wait_process(pid);
+    });
+
+    ASSERT_EQ(EXIT_SUCCESS, run(test, "7"));
+    ASSERT_EQ(7, status);
+}
+
+TEST_F(TaskTest, Error) {
+    auto test = app([&](const commline::app& app, int n) -> task {
+        co_await commline::sleep_for(1ms);
+
+        throw std::system_error(n, std::generic_category());
+    });
+
+    ASSERT_EQ(ENOENT, run(test, std::to_string(ENOENT)));
+    ASSERT_TRUE(error);
+}
+
+TEST_F(TaskTest, ErrorInGroup) {
+    const auto fail = []() -> task {
+        co_await commline::sleep_for(1ms);
+        throw commline::cli_error("failed");
+    };
+
+    auto test = app([&](const commline::app& app, int n) -> task {
+        auto tasks = std::vector<task>();
+        tasks.push_back(fail());
+
+        co_await commline::when_all(std::move(tasks));
+    });
+
+    ASSERT_EQ(EXIT_FAILURE, run(test, "1"));
+    ASSERT_TRUE(error);
+}
+
+TEST_F(TaskTest, NestedRun) {
+    auto steps = std::vector<int>();
+
+    const auto inner = [&steps]() -> task {
+        co_await commline::sleep_for(1ms);
+        steps.push_back(2);
+    };
+
+    auto test = app([&](const commline::app& app, int n) -> task {
+        co_await commline::sleep_for(1ms);
+        steps.push_back(1);
+
+        commline::run(inner());
+
+        co_await commline::sleep_for(1ms);
+        steps.push_back(3);
+    });
+
+    // The second command reuses the loop the first one ran on.
+    ASSERT_EQ(EXIT_SUCCESS, run(test, "1"));
+    ASSERT_EQ(EXIT_SUCCESS, run(test, "1"));
+    ASSERT_EQ((std::vector<int> {1, 2, 3, 1, 2, 3}), steps);
+}
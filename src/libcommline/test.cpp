@@ -0,0 +1,149 @@
+#include "test.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+namespace {
+    thread_local std::size_t allocations = 0;
+
+    auto allocate(std::size_t size) noexcept -> void* {
+        ++allocations;
+        return std::malloc(size == 0 ? 1 : size);
+    }
+
+    [[noreturn]]
+    auto out_of_memory() -> void {
+#if __cpp_exceptions
+        throw std::bad_alloc();
+#else
+        std::abort();
+#endif
+    }
+
+    auto allocate_or_throw(std::size_t size) -> void* {
+        if (auto* ptr = allocate(size)) return ptr;
+        out_of_memory();
+    }
+
+    auto allocate(std::size_t size, std::align_val_t alignment) noexcept
+        -> void* {
+        const auto align = static_cast<std::size_t>(alignment);
+        ++allocations;
+
+        // 'aligned_alloc' requires a size that is a multiple of the
+        // alignment.
+        return std::aligned_alloc(
+            align,
+            (std::max(size, std::size_t(1)) + align - 1) / align * align
+        );
+    }
+
+    auto allocate_or_throw(std::size_t size, std::align_val_t alignment)
+        -> void* {
+        if (auto* ptr = allocate(size, alignment)) return ptr;
+        out_of_memory();
+    }
+}
+
+// Every form is replaced so that allocations and deallocations always pair
+// up, including under sanitizers. The aligned forms serve the allocations
+// of 'std::pmr::new_delete_resource', such as those a parse makes once its
+// buffer is exhausted.
+
+auto operator new(std::size_t size) -> void* {
+    return allocate_or_throw(size);
+}
+
+auto operator new[](std::size_t size) -> void* {
+    return allocate_or_throw(size);
+}
+
+auto operator new(std::size_t size, const std::nothrow_t&) noexcept -> void* {
+    return allocate(size);
+}
+
+auto operator new[](std::size_t size, const std::nothrow_t&) noexcept
+    -> void* {
+    return allocate(size);
+}
+
+auto operator delete(void* ptr) noexcept -> void { std::free(ptr); }
+
+auto operator delete[](void* ptr) noexcept -> void { std::free(ptr); }
+
+auto operator delete(void* ptr, std::size_t) noexcept -> void {
+    std::free(ptr);
+}
+
+auto operator delete[](void* ptr, std::size_t) noexcept -> void {
+    std::free(ptr);
+}
+
+auto operator delete(void* ptr, const std::nothrow_t&) noexcept -> void {
+    std::free(ptr);
+}
+
+auto operator delete[](void* ptr, const std::nothrow_t&) noexcept -> void {
+    std::free(ptr);
+}
+
+auto operator new(std::size_t size, std::align_val_t alignment) -> void* {
+    return allocate_or_throw(size, alignment);
+}
+
+auto operator new[](std::size_t size, std::align_val_t alignment) -> void* {
+    return allocate_or_throw(size, alignment);
+}
+
+auto operator new(
+    std::size_t size,
+    std::align_val_t alignment,
+    const std::nothrow_t&
+) noexcept -> void* {
+    return allocate(size, alignment);
+}
+
+auto operator new[](
+    std::size_t size,
+    std::align_val_t alignment,
+    const std::nothrow_t&
+) noexcept -> void* {
+    return allocate(size, alignment);
+}
+
+auto operator delete(void* ptr, std::align_val_t) noexcept -> void {
+    std::free(ptr);
+}
+
+auto operator delete[](void* ptr, std::align_val_t) noexcept -> void {
+    std::free(ptr);
+}
+
+auto operator delete(void* ptr, std::size_t, std::align_val_t) noexcept
+    -> void {
+    std::free(ptr);
+}
+
+auto operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept
+    -> void {
+    std::free(ptr);
+}
+
+auto operator delete(
+    void* ptr,
+    std::align_val_t,
+    const std::nothrow_t&
+) noexcept -> void {
+    std::free(ptr);
+}
+
+auto operator delete[](
+    void* ptr,
+    std::align_val_t,
+    const std::nothrow_t&
+) noexcept -> void {
+    std::free(ptr);
+}
+
+auto allocation_count() -> std::size_t { return allocations; }
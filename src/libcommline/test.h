@@ -1,3 +1,7 @@
 #include <gtest/gtest.h>
 
 using namespace std::literals;
+
+// Number of calls to any form of the global 'operator new' made by the
+// current thread.
+auto allocation_count() -> std::size_t;
@@ -0,0 +1,156 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <unistd.h>
+
+namespace {
+    std::size_t allocations = 0;
+
+    auto allocate(std::size_t size) noexcept -> void* {
+        ++allocations;
+        return std::malloc(size == 0 ? 1 : size);
+    }
+
+    auto allocate_or_throw(std::size_t size) -> void* {
+        if (auto* ptr = allocate(size)) return ptr;
+        throw std::bad_alloc();
+    }
+
+    auto allocate(std::size_t size, std::align_val_t alignment) noexcept
+        -> void* {
+        const auto align = static_cast<std::size_t>(alignment);
+        ++allocations;
+
+        // 'aligned_alloc' requires a size that is a multiple of the
+        // alignment.
+        return std::aligned_alloc(
+            align,
+            (std::max(size, std::size_t(1)) + align - 1) / align * align
+        );
+    }
+
+    auto allocate_or_throw(std::size_t size, std::align_val_t alignment)
+        -> void* {
+        if (auto* ptr = allocate(size, alignment)) return ptr;
+        throw std::bad_alloc();
+    }
+
+    // Writes the number of allocations made by the program to the file
+    // descriptor named by 'STARTUP_ALLOCATIONS_FD', when the harness sets
+    // it, as the program exits.
+    struct reporter {
+        ~reporter() {
+            const auto* const fd = std::getenv("STARTUP_ALLOCATIONS_FD");
+            if (!fd) return;
+
+            char buffer[32];
+            const auto size = std::snprintf(
+                buffer,
+                sizeof(buffer),
+                "%zu",
+                allocations
+            );
+
+            if (size > 0) ::write(std::atoi(fd), buffer, size);
+        }
+    } report;
+}
+
+auto operator new(std::size_t size) -> void* {
+    return allocate_or_throw(size);
+}
+
+auto operator new[](std::size_t size) -> void* {
+    return allocate_or_throw(size);
+}
+
+auto operator new(std::size_t size, const std::nothrow_t&) noexcept -> void* {
+    return allocate(size);
+}
+
+auto operator new[](std::size_t size, const std::nothrow_t&) noexcept
+    -> void* {
+    return allocate(size);
+}
+
+auto operator delete(void* ptr) noexcept -> void { std::free(ptr); }
+
+auto operator delete[](void* ptr) noexcept -> void { std::free(ptr); }
+
+auto operator delete(void* ptr, std::size_t) noexcept -> void {
+    std::free(ptr);
+}
+
+auto operator delete[](void* ptr, std::size_t) noexcept -> void {
+    std::free(ptr);
+}
+
+auto operator delete(void* ptr, const std::nothrow_t&) noexcept -> void {
+    std::free(ptr);
+}
+
+auto operator delete[](void* ptr, const std::nothrow_t&) noexcept -> void {
+    std::free(ptr);
+}
+
+// The aligned forms are counted too, since 'std::pmr::new_delete_resource'
+// allocates through them.
+
+auto operator new(std::size_t size, std::align_val_t alignment) -> void* {
+    return allocate_or_throw(size, alignment);
+}
+
+auto operator new[](std::size_t size, std::align_val_t alignment) -> void* {
+    return allocate_or_throw(size, alignment);
+}
+
+auto operator new(
+    std::size_t size,
+    std::align_val_t alignment,
+    const std::nothrow_t&
+) noexcept -> void* {
+    return allocate(size, alignment);
+}
+
+auto operator new[](
+    std::size_t size,
+    std::align_val_t alignment,
+    const std::nothrow_t&
+) noexcept -> void* {
+    return allocate(size, alignment);
+}
+
+auto operator delete(void* ptr, std::align_val_t) noexcept -> void {
+    std::free(ptr);
+}
+
+auto operator delete[](void* ptr, std::align_val_t) noexcept -> void {
+    std::free(ptr);
+}
+
+auto operator delete(void* ptr, std::size_t, std::align_val_t) noexcept
+    -> void {
+    std::free(ptr);
+}
+
+auto operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept
+    -> void {
+    std::free(ptr);
+}
+
+auto operator delete(
+    void* ptr,
+    std::align_val_t,
+    const std::nothrow_t&
+) noexcept -> void {
+    std::free(ptr);
+}
+
+auto operator delete[](
+    void* ptr,
+    std::align_val_t,
+    const std::nothrow_t&
+) noexcept -> void {
+    std::free(ptr);
+}
@@ -0,0 +1,62 @@
+#include "names.h"
+
+#include <commline/application.h>
+
+using commline::flag;
+using commline::list;
+using commline::option;
+using commline::variadic;
+
+namespace {
+    constexpr auto names = startup::name_table<100>("command-");
+
+    struct handler {
+        auto operator()(
+            const commline::app& app,
+            bool verbose,
+            std::string_view message,
+            std::vector<std::string_view> paths,
+            std::vector<std::string_view> args
+        ) const -> void {}
+    };
+
+    template <std::size_t I>
+    constexpr auto make_command() {
+        return commline::subcommand(
+            names[I],
+            "A subcommand.",
+            commline::options(
+                flag({"verbose", "v"}, "Print more information."),
+                option<std::string_view>(
+                    {"message", "m"},
+                    "Use the given message.",
+                    "text"
+                ),
+                list<std::string_view>(
+                    {"path", "p"},
+                    "Limit the command to a path.",
+                    "path"
+                )
+            ),
+            commline::arguments(variadic<std::string_view>("args")),
+            handler()
+        );
+    }
+
+    template <std::size_t... I>
+    constexpr auto make_commands(std::index_sequence<I...>) {
+        return commline::commands(make_command<I>()...);
+    }
+
+    constinit auto app = commline::application(
+        "startup-git",
+        "0.0.0",
+        "A version control tool with many subcommands.",
+        commline::options(),
+        commline::arguments(),
+        [](const commline::app& app) {},
+        make_commands(std::make_index_sequence<names.size()>())
+    );
+}
+
+auto main(int argc, char** argv) -> int { return app.run(argc, argv); }
@@ -0,0 +1,51 @@
+#include "names.h"
+
+#include <cstring>
+#include <getopt.h>
+#include <vector>
+
+namespace {
+    constexpr auto names = startup::name_table<100>("command-");
+
+    const option long_options[] = {
+        {"verbose", no_argument, nullptr, 'v'},
+        {"message", required_argument, nullptr, 'm'},
+        {"path", required_argument, nullptr, 'p'},
+        {nullptr, 0, nullptr, 0}};
+
+    auto find_command(const char* name) -> bool {
+        for (std::size_t i = 0; i < names.size(); ++i) {
+            if (names[i] == name) return true;
+        }
+
+        return false;
+    }
+}
+
+// The same command line interface as 'startup-git', parsed by hand.
+auto main(int argc, char** argv) -> int {
+    if (argc < 2 || !find_command(argv[1])) return 1;
+
+    [[maybe_unused]] auto verbose = false;
+    [[maybe_unused]] const char* message = nullptr;
+    auto paths = std::vector<const char*>();
+
+    --argc;
+    ++argv;
+
+    while (true) {
+        const auto opt =
+            getopt_long(argc, argv, "vm:p:", long_options, nullptr);
+        if (opt == -1) break;
+
+        switch (opt) {
+            case 'v': verbose = true; break;
+            case 'm': message = optarg; break;
+            case 'p': paths.push_back(optarg); break;
+            default: return 1;
+        }
+    }
+
+    const auto args = std::vector<const char*>(argv + optind, argv + argc);
+    return 0;
+}
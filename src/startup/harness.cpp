@@ -0,0 +1,348 @@
+#include <commline/application.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <fcntl.h>
+#include <filesystem>
+#include <fmt/format.h>
+#include <numeric>
+#include <sched.h>
+#include <spawn.h>
+#include <string>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <system_error>
+#include <unistd.h>
+#include <vector>
+
+extern char** environ;
+
+using commline::flag;
+using commline::option;
+using commline::variadic;
+
+namespace fs = std::filesystem;
+
+namespace {
+    [[noreturn]]
+    auto fail(std::string_view what) -> void {
+        throw std::system_error(errno, std::generic_category(), what.data());
+    }
+
+    // A sample application and the command line it is timed with.
+    struct scenario {
+        std::string_view name;
+        std::string_view program;
+        std::vector<std::string> (*arguments)();
+    };
+
+    auto git_arguments() -> std::vector<std::string> {
+        return {
+            "command-57",
+            "--verbose",
+            "--message=hello",
+            "-p",
+            "src",
+            "--path=include",
+            "a",
+            "b",
+            "c"};
+    }
+
+    // As many arguments as fit comfortably within the default 'ARG_MAX'.
+    auto xargs_arguments() -> std::vector<std::string> {
+        auto result =
+            std::vector<std::string> {"-n", "100", "-P", "4", "echo"};
+        result.resize(result.size() + 50'000, "item");
+        return result;
+    }
+
+    // Options spread across the whole set.
+    auto options_arguments() -> std::vector<std::string> {
+        auto result = std::vector<std::string>();
+
+        for (std::size_t i = 0; i < 64; ++i) {
+            const auto index = (i * 101) % 300;
+            auto& word =
+                result.emplace_back(fmt::format("--option-{}", index));
+
+            switch (index % 4) {
+                case 1: word.append("=42"); break;
+                case 2: word.append("=item"); break;
+                case 3: word.append("=value"); break;
+            }
+        }
+
+        result.emplace_back("file");
+        return result;
+    }
+
+    const auto scenarios = std::array {
+        scenario {"git", "startup-git", git_arguments},
+        scenario {"xargs", "startup-xargs", xargs_arguments},
+        scenario {"options", "startup-options", options_arguments}};
+
+    struct sample {
+        std::chrono::nanoseconds wall;
+        long minor_faults;
+        long major_faults;
+        std::size_t allocations;
+    };
+
+    // Runs 'program' once with its output discarded.
+    auto run(const fs::path& program, const std::vector<std::string>& args)
+        -> sample {
+        int fds[2];
+        if (pipe2(fds, O_CLOEXEC) == -1) fail("failed to create pipe");
+
+        const auto read_end = fds[0];
+        const auto write_end = fds[1];
+
+        auto actions = posix_spawn_file_actions_t();
+        posix_spawn_file_actions_init(&actions);
+        posix_spawn_file_actions_addopen(
+            &actions,
+            STDOUT_FILENO,
+            "/dev/null",
+            O_WRONLY,
+            0
+        );
+        posix_spawn_file_actions_adddup2(
+            &actions,
+            STDOUT_FILENO,
+            STDERR_FILENO
+        );
+
+        // The child reports its allocations on descriptor 3.
+        constexpr auto report_fd = 3;
+        posix_spawn_file_actions_adddup2(&actions, write_end, report_fd);
+
+        auto env = std::vector<char*>();
+        for (auto** var = environ; *var; ++var) env.push_back(*var);
+
+        auto report = fmt::format("STARTUP_ALLOCATIONS_FD={}", report_fd);
+        env.push_back(report.data());
+        env.push_back(nullptr);
+
+        const auto path = program.string();
+
+        auto argv = std::vector<char*>();
+        argv.push_back(const_cast<char*>(path.c_str()));
+        for (const auto& arg : args) {
+            argv.push_back(const_cast<char*>(arg.c_str()));
+        }
+        argv.push_back(nullptr);
+
+        const auto start = std::chrono::steady_clock::now();
+
+        auto pid = pid_t();
+        const auto error = posix_spawn(
+            &pid,
+            path.c_str(),
+            &actions,
+            nullptr,
+            argv.data(),
+            env.data()
+        );
+
+        posix_spawn_file_actions_destroy(&actions);
+        close(write_end);
+
+        if (error != 0) {
+            close(read_end);
+            errno = error;
+            fail("failed to start " + path);
+        }
+
+        auto status = 0;
+        auto usage = rusage();
+        while (wait4(pid, &status, 0, &usage) == -1) {
+            if (errno != EINTR) fail("failed to wait for " + path);
+        }
+
+        const auto end = std::chrono::steady_clock::now();
+
+        char buffer[32] = {};
+        const auto size = read(read_end, buffer, sizeof(buffer) - 1);
+        close(read_end);
+
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            throw commline::cli_error("{} did not exit successfully", path);
+        }
+
+        return {
+            end - start,
+            usage.ru_minflt,
+            usage.ru_majflt,
+            size > 0 ? std::stoul(buffer) : 0};
+    }
+
+    auto percentile(std::vector<sample>& samples, double fraction)
+        -> std::chrono::nanoseconds {
+        const auto index = static_cast<std::size_t>(
+            fraction * static_cast<double>(samples.size() - 1)
+        );
+
+        std::ranges::nth_element(
+            samples,
+            samples.begin() + index,
+            {},
+            &sample::wall
+        );
+        return samples[index].wall;
+    }
+
+    auto microseconds(std::chrono::nanoseconds duration) -> double {
+        return std::chrono::duration<double, std::micro>(duration).count();
+    }
+
+    // Times 'runs' executions of 'program' after 'warmup' untimed ones, and
+    // prints one row of results. Returns the median wall time.
+    auto measure(
+        std::string_view scenario,
+        const fs::path& program,
+        const std::vector<std::string>& args,
+        int warmup,
+        int runs
+    ) -> std::chrono::nanoseconds {
+        for (auto i = 0; i < warmup; ++i) run(program, args);
+
+        auto samples = std::vector<sample>();
+        samples.reserve(runs);
+
+        for (auto i = 0; i < runs; ++i) samples.push_back(run(program, args));
+
+        const auto mean = [&](auto member) {
+            const auto total = std::accumulate(
+                samples.begin(),
+                samples.end(),
+                0.0,
+                [member](double sum, const sample& s) {
+                    return sum + static_cast<double>(s.*member);
+                }
+            );
+
+            return total / static_cast<double>(samples.size());
+        };
+
+        const auto p50 = percentile(samples, 0.50);
+        const auto p90 = percentile(samples, 0.90);
+        const auto p99 = percentile(samples, 0.99);
+
+        fmt::print(
+            "{:<10}{:<24}{:>10.1f}{:>10.1f}{:>10.1f}{:>10.1f}{:>8.1f}"
+            "{:>10.1f}\n",
+            scenario,
+            program.filename().string(),
+            microseconds(p50),
+            microseconds(p90),
+            microseconds(p99),
+            mean(&sample::minor_faults),
+            mean(&sample::major_faults),
+            mean(&sample::allocations)
+        );
+
+        return p50;
+    }
+
+    auto pin(int cpu) -> void {
+        auto set = cpu_set_t();
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+
+        if (sched_setaffinity(0, sizeof(set), &set) == -1) {
+            fail(fmt::format("failed to pin to CPU {}", cpu));
+        }
+    }
+
+    // Runs the sample applications, which are installed next to this
+    // program, and reports their wall time percentiles in microseconds, page
+    // faults and allocations per run.
+    auto time_startup(
+        const commline::app& app,
+        int runs,
+        int warmup,
+        int cpu,
+        bool compare,
+        std::vector<std::string_view> names
+    ) -> void {
+        if (runs < 1) throw commline::cli_error("runs must be positive");
+
+        // Children inherit the affinity of this process.
+        pin(cpu);
+
+        const auto directory =
+            fs::read_symlink("/proc/self/exe").parent_path();
+
+        fmt::print(
+            "{:<10}{:<24}{:>10}{:>10}{:>10}{:>10}{:>8}{:>10}\n",
+            "scenario",
+            "program",
+            "p50",
+            "p90",
+            "p99",
+            "minflt",
+            "majflt",
+            "allocs"
+        );
+
+        for (const auto& scenario : scenarios) {
+            if (!names.empty() &&
+                std::ranges::find(names, scenario.name) == names.end())
+                continue;
+
+            const auto args = scenario.arguments();
+            const auto program = directory / scenario.program;
+
+            const auto framework =
+                measure(scenario.name, program, args, warmup, runs);
+
+            if (!compare) continue;
+
+            auto baseline = program;
+            baseline += "-getopt";
+
+            const auto plain =
+                measure(scenario.name, baseline, args, warmup, runs);
+
+            fmt::print(
+                "{:<10}{:<24}{:>+10.1f}\n",
+                scenario.name,
+                "framework cost",
+                microseconds(framework - plain)
+            );
+        }
+    }
+}
+
+auto main(int argc, char** argv) -> int {
+    auto app = commline::application(
+        "commline.startup",
+        "0.0.0",
+        "Measures the startup latency of sample applications.",
+        commline::options(
+            option<int>(
+                {"runs", "r"},
+                "Number of timed runs per program.",
+                "count",
+                200
+            ),
+            option<int>(
+                {"warmup", "w"},
+                "Number of untimed runs before timing.",
+                "count",
+                10
+            ),
+            option<int>({"cpu", "c"}, "CPU to run on.", "cpu", 0),
+            flag(
+                {"compare"},
+                "Also run the getopt_long version of each program."
+            )
+        ),
+        commline::arguments(variadic<std::string_view>("scenarios")),
+        &time_startup
+    );
+
+    return app.run(argc, argv);
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <string_view>
+
+namespace startup {
+    // Names of the form '<prefix><number>', generated at compile time so
+    // that a constant command tree can refer to them.
+    template <std::size_t Count>
+    class name_table {
+        static constexpr auto max_size = std::size_t(24);
+
+        static_assert(Count <= 1000, "names have at most three digits");
+
+        std::array<std::array<char, max_size>, Count> names = {};
+    public:
+        constexpr name_table(std::string_view prefix) {
+            for (std::size_t i = 0; i < Count; ++i) {
+                auto& name = names[i];
+                auto size = prefix.copy(name.data(), max_size - 4);
+
+                auto digits = std::array<char, 3>();
+                auto count = std::size_t(0);
+                auto value = i;
+
+                do {
+                    digits[count++] = static_cast<char>('0' + value % 10);
+                    value /= 10;
+                } while (value != 0);
+
+                while (count != 0) name[size++] = digits[--count];
+            }
+        }
+
+        constexpr auto operator[](std::size_t index) const -> std::string_view {
+            return names[index].data();
+        }
+
+        constexpr auto size() const noexcept -> std::size_t { return Count; }
+    };
+}
@@ -0,0 +1,55 @@
+#include "names.h"
+
+#include <commline/application.h>
+
+using commline::flag;
+using commline::list;
+using commline::option;
+using commline::variadic;
+
+namespace {
+    constexpr auto names = startup::name_table<300>("option-");
+
+    // Options of each kind in turn: flags, integers, lists and strings.
+    template <std::size_t I>
+    constexpr auto make_option() {
+        constexpr auto name = names[I];
+
+        if constexpr (I % 4 == 0) return flag({name}, "Enable a feature.");
+        else if constexpr (I % 4 == 1) {
+            return option<int>({name}, "Set a limit.", "number");
+        }
+        else if constexpr (I % 4 == 2) {
+            return list<std::string_view>({name}, "Add an item.", "item");
+        }
+        else {
+            return option<std::string_view>({name}, "Set a value.", "value");
+        }
+    }
+
+    template <std::size_t... I>
+    constexpr auto make_options(std::index_sequence<I...>) {
+        return commline::options(make_option<I>()...);
+    }
+
+    struct handler {
+        template <typename... Values>
+        auto operator()(const commline::app& app, Values&&... values) const
+            -> void {}
+    };
+
+    // Unlike the other samples, the command tree is built when the program
+    // starts: evaluating a schema this wide at compile time makes the
+    // compiler's time and memory grow without a useful bound.
+    auto app = commline::application(
+        "startup-options",
+        "0.0.0",
+        "A tool with a very large number of options.",
+        make_options(std::make_index_sequence<names.size()>()),
+        commline::arguments(variadic<std::string_view>("files")),
+        handler(),
+        commline::commands()
+    );
+}
+
+auto main(int argc, char** argv) -> int { return app.run(argc, argv); }
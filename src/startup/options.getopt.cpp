@@ -0,0 +1,60 @@
+#include "names.h"
+
+#include <array>
+#include <cstdlib>
+#include <getopt.h>
+#include <string_view>
+#include <vector>
+
+namespace {
+    constexpr auto names = startup::name_table<300>("option-");
+
+    // Option values start past every character 'getopt_long' may return.
+    constexpr auto first_value = 1000;
+
+    auto make_options() -> std::array<option, names.size() + 1> {
+        auto result = std::array<option, names.size() + 1>();
+
+        for (std::size_t i = 0; i < names.size(); ++i) {
+            result[i] = {
+                names[i].data(),
+                i % 4 == 0 ? no_argument : required_argument,
+                nullptr,
+                first_value + static_cast<int>(i)};
+        }
+
+        result.back() = {nullptr, 0, nullptr, 0};
+        return result;
+    }
+}
+
+// The same command line interface as 'startup-options', parsed by hand.
+auto main(int argc, char** argv) -> int {
+    const auto long_options = make_options();
+
+    auto flags = std::array<bool, names.size()>();
+    auto values = std::array<const char*, names.size()>();
+    auto numbers = std::array<long, names.size()>();
+    auto lists = std::array<std::vector<const char*>, names.size()>();
+
+    while (true) {
+        const auto opt =
+            getopt_long(argc, argv, "", long_options.data(), nullptr);
+        if (opt == -1) break;
+        if (opt < first_value) return 1;
+
+        const auto index = static_cast<std::size_t>(opt - first_value);
+
+        switch (index % 4) {
+            case 0: flags[index] = true; break;
+            case 1: numbers[index] = std::strtol(optarg, nullptr, 0); break;
+            case 2: lists[index].push_back(optarg); break;
+            default: values[index] = optarg; break;
+        }
+    }
+
+    const auto files =
+        std::vector<std::string_view>(argv + optind, argv + argc);
+
+    return 0;
+}
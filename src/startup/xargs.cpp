@@ -0,0 +1,42 @@
+#include <commline/application.h>
+
+using commline::flag;
+using commline::option;
+using commline::required;
+using commline::variadic;
+
+namespace {
+    constinit auto app = commline::application(
+        "startup-xargs",
+        "0.0.0",
+        "Runs a command with a very long list of arguments.",
+        commline::options(
+            flag({"null", "0"}, "Items are terminated by a null character."),
+            option<int>(
+                {"max-args", "n"},
+                "Use at most this many arguments per command line.",
+                "max-args"
+            ),
+            option<int>(
+                {"max-procs", "P"},
+                "Run up to this many processes at a time.",
+                "max-procs"
+            ),
+            flag({"verbose", "t"}, "Print each command line before running it.")
+        ),
+        commline::arguments(
+            required<std::string_view>("command"),
+            variadic<std::string_view>("initial-arguments")
+        ),
+        [](const commline::app& app,
+           bool null,
+           int max_args,
+           int max_procs,
+           bool verbose,
+           std::string_view command,
+           std::vector<std::string_view> arguments) {},
+        commline::commands()
+    );
+}
+
+auto main(int argc, char** argv) -> int { return app.run(argc, argv); }
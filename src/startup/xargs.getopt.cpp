@@ -0,0 +1,43 @@
+#include <cstdlib>
+#include <getopt.h>
+#include <string_view>
+#include <vector>
+
+namespace {
+    const option long_options[] = {
+        {"null", no_argument, nullptr, '0'},
+        {"max-args", required_argument, nullptr, 'n'},
+        {"max-procs", required_argument, nullptr, 'P'},
+        {"verbose", no_argument, nullptr, 't'},
+        {nullptr, 0, nullptr, 0}};
+}
+
+// The same command line interface as 'startup-xargs', parsed by hand.
+auto main(int argc, char** argv) -> int {
+    [[maybe_unused]] auto null = false;
+    [[maybe_unused]] auto verbose = false;
+    [[maybe_unused]] auto max_args = 0L;
+    [[maybe_unused]] auto max_procs = 0L;
+
+    while (true) {
+        const auto opt =
+            getopt_long(argc, argv, "0n:P:t", long_options, nullptr);
+        if (opt == -1) break;
+
+        switch (opt) {
+            case '0': null = true; break;
+            case 'n': max_args = std::strtol(optarg, nullptr, 0); break;
+            case 'P': max_procs = std::strtol(optarg, nullptr, 0); break;
+            case 't': verbose = true; break;
+            default: return 1;
+        }
+    }
+
+    if (optind == argc) return 1;
+
+    [[maybe_unused]] const auto command = std::string_view(argv[optind++]);
+    const auto arguments =
+        std::vector<std::string_view>(argv + optind, argv + argc);
+
+    return 0;
+}